@@ -56,6 +56,9 @@ struct ConnectorData
           car_consumption_l3(0.f),
           car_cable_capacity(0.f),
           car_ready(true),
+          ev_profile(0),
+          ev_session(0),
+          ev_soc(-1.f),
           preparing_start(),
           fault_pending(false),
           unavailable_pending(false)
@@ -84,6 +87,12 @@ struct ConnectorData
     float car_cable_capacity;
     /** @brief Indicate that the car is ready to charge */
     bool car_ready;
+    /** @brief Profile of the simulated vehicle (0 = car inputs set by the car commands) */
+    unsigned int ev_profile;
+    /** @brief Incremented each time a vehicle profile is selected */
+    uint32_t ev_session;
+    /** @brief State of charge of the simulated vehicle (negative if no vehicle is simulated) */
+    float ev_soc;
     /** @brief Time point when entering Preparing state */
     std::chrono::steady_clock::time_point preparing_start;
     /** @brief Indicate that a fault occured */
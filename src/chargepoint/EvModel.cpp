@@ -0,0 +1,162 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "EvModel.h"
+#include "MeterSimulator.h"
+
+#include <algorithm>
+#include <iostream>
+
+/** @brief Constructor */
+EvModel::EvModel(size_t connectors_count, const EvProfileLibrary& profiles)
+    : m_library(profiles),
+      m_profiles(connectors_count, nullptr),
+      m_sessions(connectors_count, 0u),
+      m_start_energies(connectors_count, 0.),
+      m_departures(connectors_count),
+      m_initial_socs(connectors_count, 0.f),
+      m_inv_capacities(connectors_count, 0.f),
+      m_target_socs(connectors_count, 0.f),
+      m_taper_slopes(connectors_count, 0.f),
+      m_min_power_ratios(connectors_count, 0.f),
+      m_max_powers(connectors_count, 0.f),
+      m_phases(connectors_count, MeterSnapshot::MAX_PHASES),
+      m_energies(connectors_count, 0.),
+      m_power_to_consumptions(connectors_count, 0.f),
+      m_socs(connectors_count, 0.f),
+      m_consumptions(connectors_count, 0.f)
+{
+}
+
+/** @brief Destructor */
+EvModel::~EvModel() { }
+
+/** @brief Update the car inputs of the connectors having a vehicle profile */
+void EvModel::update(std::vector<ConnectorData>& connectors)
+{
+    auto   now   = std::chrono::steady_clock::now();
+    size_t count = std::min(connectors.size(), m_profiles.size());
+
+    // Gather the meter values and start the new sessions
+    for (size_t i = 0; i < count; i++)
+    {
+        const ConnectorData& connector = connectors[i];
+        MeterSnapshot        meter     = connector.meter->getSnapshot();
+        m_energies[i]                  = static_cast<double>(meter.energy);
+        m_power_to_consumptions[i]     = 1.f;
+        if (connector.ev_session != m_sessions[i])
+        {
+            startSession(i, connector, m_energies[i]);
+        }
+        if (meter.type == ConnectorData::ConnectorType::AC)
+        {
+            // The current is balanced between the phases used by the vehicle
+            float  voltages = 0.f;
+            size_t phases   = std::min(static_cast<size_t>(meter.phases), static_cast<size_t>(m_phases[i]));
+            for (size_t j = 0; j < phases; j++)
+            {
+                voltages += meter.voltages[j];
+            }
+            m_power_to_consumptions[i] = ((voltages > 0.f) ? (1.f / voltages) : 0.f);
+        }
+    }
+
+    // Evaluate the charging curves : constant current until the cv state of charge
+    // then power decreasing linearly down to the minimum ratio, and no charge above the target
+    for (size_t i = 0; i < count; i++)
+    {
+        float soc         = m_initial_socs[i] + static_cast<float>(m_energies[i] - m_start_energies[i]) * m_inv_capacities[i];
+        float taper       = std::clamp((1.f - soc) * m_taper_slopes[i], m_min_power_ratios[i], 1.f);
+        float power       = ((soc < m_target_socs[i]) ? (m_max_powers[i] * taper) : 0.f);
+        m_socs[i]         = std::min(soc, 1.f);
+        m_consumptions[i] = power * m_power_to_consumptions[i];
+    }
+
+    // Apply the vehicle demands
+    for (size_t i = 0; i < count; i++)
+    {
+        ConnectorData& connector = connectors[i];
+        if (m_profiles[i])
+        {
+            if (now < m_departures[i])
+            {
+                bool dc                      = (connector.meter->getCurrentOutType() == ConnectorData::ConnectorType::DC);
+                connector.car_ready          = (m_consumptions[i] > 0.f);
+                connector.car_consumption_l1 = m_consumptions[i];
+                connector.car_consumption_l2 = ((dc || (m_phases[i] < 2u)) ? 0.f : m_consumptions[i]);
+                connector.car_consumption_l3 = ((dc || (m_phases[i] < 3u)) ? 0.f : m_consumptions[i]);
+                connector.ev_soc             = m_socs[i];
+            }
+            else
+            {
+                // The vehicle leaves
+                std::cout << "Vehicle leaving connector " << connector.id << " (SoC = " << m_socs[i] << ")" << std::endl;
+                connector.car_cable_capacity = 0.f;
+                connector.car_consumption_l1 = 0.f;
+                connector.car_consumption_l2 = 0.f;
+                connector.car_consumption_l3 = 0.f;
+                connector.ev_soc             = -1.f;
+                m_profiles[i]                = nullptr;
+            }
+        }
+        else
+        {
+            connector.ev_soc = -1.f;
+        }
+    }
+}
+
+/** @brief Start the session of a newly plugged vehicle */
+void EvModel::startSession(size_t index, const ConnectorData& connector, double energy)
+{
+    const EvProfile* profile = ((connector.ev_profile != NO_PROFILE) ? m_library.get(connector.ev_profile) : nullptr);
+    m_profiles[index]        = profile;
+    m_sessions[index]        = connector.ev_session;
+    if (profile)
+    {
+        bool dc                    = (connector.meter->getCurrentOutType() == ConnectorData::ConnectorType::DC);
+        m_start_energies[index]    = energy;
+        m_departures[index]        = ((profile->departure != 0u)
+                                          ? (std::chrono::steady_clock::now() + std::chrono::seconds(profile->departure))
+                                          : std::chrono::steady_clock::time_point::max());
+        m_initial_socs[index]      = profile->initial_soc;
+        m_inv_capacities[index]    = 1.f / profile->capacity;
+        m_target_socs[index]       = profile->target_soc;
+        m_taper_slopes[index]      = 1.f / std::max(1.f - profile->cv_soc, 0.01f);
+        m_min_power_ratios[index]  = profile->min_power_ratio;
+        m_max_powers[index]        = (dc ? profile->max_dc_power : profile->max_ac_power);
+        m_phases[index]            = profile->phases;
+        std::cout << "Vehicle profile " << connector.ev_profile << " plugged on connector " << connector.id << std::endl;
+    }
+    else
+    {
+        // Idle connectors evaluate to a null demand
+        m_target_socs[index] = 0.f;
+        m_max_powers[index]  = 0.f;
+        if (connector.ev_profile != NO_PROFILE)
+        {
+            std::cout << "Unknown vehicle profile " << connector.ev_profile << " on connector " << connector.id << std::endl;
+        }
+    }
+}
@@ -0,0 +1,97 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef EVMODEL_H
+#define EVMODEL_H
+
+#include "ConnectorData.h"
+#include "EvProfileLibrary.h"
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+/** @brief Simulate the electric vehicles plugged on the connectors, all the connectors are evaluated in a single batch */
+class EvModel
+{
+  public:
+    /** @brief Profile id disabling the model (the car consumptions are set by the car commands) */
+    static constexpr unsigned int NO_PROFILE = 0u;
+
+    /**
+     * @brief Constructor
+     * @param connectors_count Number of connectors
+     * @param profiles Library of the vehicle profiles
+     */
+    EvModel(size_t connectors_count, const EvProfileLibrary& profiles);
+
+    /** @brief Destructor */
+    virtual ~EvModel();
+
+    /**
+     * @brief Update the car inputs of the connectors having a vehicle profile
+     *        (new sessions are started when the connector's EV session changes)
+     * @param connectors Connectors
+     */
+    void update(std::vector<ConnectorData>& connectors);
+
+  private:
+    /** @brief Library of the vehicle profiles */
+    const EvProfileLibrary& m_library;
+    /** @brief Profile of the vehicle of each connector (nullptr if none) */
+    std::vector<const EvProfile*> m_profiles;
+    /** @brief Last EV session of each connector */
+    std::vector<uint32_t> m_sessions;
+    /** @brief Meter energy when the vehicle has been plugged in Wh */
+    std::vector<double> m_start_energies;
+    /** @brief Departure time of each vehicle */
+    std::vector<std::chrono::steady_clock::time_point> m_departures;
+    /** @brief State of charge when plugged */
+    std::vector<float> m_initial_socs;
+    /** @brief Inverse of the battery capacity in 1/Wh */
+    std::vector<float> m_inv_capacities;
+    /** @brief State of charge at which the vehicle stops charging */
+    std::vector<float> m_target_socs;
+    /** @brief Slope of the power decrease of the constant voltage phase : 1 / (1 - cv_soc) */
+    std::vector<float> m_taper_slopes;
+    /** @brief Minimum power ratio of the constant voltage phase */
+    std::vector<float> m_min_power_ratios;
+    /** @brief Maximum charging power in W */
+    std::vector<float> m_max_powers;
+    /** @brief Number of phases used by the vehicle on an AC connector */
+    std::vector<unsigned int> m_phases;
+    /** @brief Meter energy in Wh (input of the batch) */
+    std::vector<double> m_energies;
+    /** @brief Power to current conversion factor : 1 / sum of the phase voltages for AC, 1 for DC (input of the batch) */
+    std::vector<float> m_power_to_consumptions;
+    /** @brief State of charge (output of the batch) */
+    std::vector<float> m_socs;
+    /** @brief Requested consumption per phase in A for AC, in W for DC (output of the batch) */
+    std::vector<float> m_consumptions;
+
+    /** @brief Start the session of a newly plugged vehicle */
+    void startSession(size_t index, const ConnectorData& connector, double energy);
+};
+
+#endif // EVMODEL_H
@@ -0,0 +1,183 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "EvProfileLibrary.h"
+
+#include <cstring>
+#include <iostream>
+
+#ifdef _MSC_VER
+#include <Windows.h>
+#else // _MSC_VER
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _MSC_VER
+
+/** @brief Magic number of the profile library files */
+static constexpr char EV_PROFILE_LIBRARY_MAGIC[4] = {'E', 'V', 'P', 'L'};
+/** @brief Version of the format of the profile library files */
+static constexpr uint32_t EV_PROFILE_LIBRARY_VERSION = 1u;
+
+/** @brief Built-in profiles */
+static const EvProfile BUILTIN_PROFILES[] = {
+    // City car
+    {40000.f, 0.20f, 0.90f, 0.80f, 0.10f, 7400.f, 50000.f, 0u, 1u},
+    // Sedan
+    {75000.f, 0.30f, 0.80f, 0.75f, 0.10f, 11000.f, 150000.f, 0u, 3u},
+    // SUV
+    {100000.f, 0.10f, 0.90f, 0.80f, 0.05f, 11000.f, 200000.f, 0u, 3u},
+    // Delivery van charging overnight at the depot
+    {60000.f, 0.15f, 1.00f, 0.85f, 0.05f, 22000.f, 80000.f, 8u * 3600u, 3u},
+    // Short stop
+    {50000.f, 0.50f, 0.80f, 0.80f, 0.10f, 11000.f, 100000.f, 2u * 3600u, 3u}};
+
+/** @brief Constructor (built-in profiles) */
+EvProfileLibrary::EvProfileLibrary()
+    : m_memory(nullptr),
+      m_size(0),
+#ifdef _MSC_VER
+      m_file(INVALID_HANDLE_VALUE),
+      m_mapping(nullptr),
+#endif // _MSC_VER
+      m_profiles(BUILTIN_PROFILES),
+      m_count(sizeof(BUILTIN_PROFILES) / sizeof(BUILTIN_PROFILES[0]))
+{
+}
+
+/** @brief Destructor */
+EvProfileLibrary::~EvProfileLibrary()
+{
+    close();
+}
+
+/** @brief Map a profile library file */
+bool EvProfileLibrary::open(const std::string& path)
+{
+    close();
+
+    // Map the whole file read-only
+#ifdef _MSC_VER
+    m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file != INVALID_HANDLE_VALUE)
+    {
+        LARGE_INTEGER file_size;
+        if (GetFileSizeEx(m_file, &file_size) && (static_cast<size_t>(file_size.QuadPart) >= sizeof(Header)))
+        {
+            m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (m_mapping)
+            {
+                m_memory = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+                m_size   = static_cast<size_t>(file_size.QuadPart);
+            }
+        }
+    }
+#else // _MSC_VER
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd >= 0)
+    {
+        struct stat file_stat;
+        if ((fstat(fd, &file_stat) == 0) && (static_cast<size_t>(file_stat.st_size) >= sizeof(Header)))
+        {
+            void* memory = mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_SHARED, fd, 0);
+            if (memory != MAP_FAILED)
+            {
+                m_memory = memory;
+                m_size   = static_cast<size_t>(file_stat.st_size);
+            }
+        }
+        ::close(fd);
+    }
+#endif // _MSC_VER
+
+    // Check the header
+    bool ret = false;
+    if (m_memory)
+    {
+        Header header;
+        memcpy(&header, m_memory, sizeof(Header));
+        if ((memcmp(header.magic, EV_PROFILE_LIBRARY_MAGIC, sizeof(header.magic)) == 0) && (header.version == EV_PROFILE_LIBRARY_VERSION) &&
+            (header.record_size == sizeof(EvProfile)) && (header.count != 0) &&
+            (((m_size - sizeof(Header)) / sizeof(EvProfile)) >= header.count))
+        {
+            m_profiles = reinterpret_cast<const EvProfile*>(reinterpret_cast<const uint8_t*>(m_memory) + sizeof(Header));
+            m_count    = header.count;
+            ret        = true;
+            std::cout << "EV profile library " << path << " loaded : " << m_count << " profiles" << std::endl;
+        }
+    }
+    if (!ret)
+    {
+        std::cout << "Invalid EV profile library " << path << ", using the built-in profiles" << std::endl;
+        close();
+    }
+
+    return ret;
+}
+
+/** @brief Unmap the profile library file and go back to the built-in profiles */
+void EvProfileLibrary::close()
+{
+    if (m_memory)
+    {
+#ifdef _MSC_VER
+        UnmapViewOfFile(m_memory);
+#else // _MSC_VER
+        munmap(m_memory, m_size);
+#endif // _MSC_VER
+        m_memory = nullptr;
+    }
+#ifdef _MSC_VER
+    if (m_mapping)
+    {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+    if (m_file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+    }
+#endif // _MSC_VER
+    m_size     = 0;
+    m_profiles = BUILTIN_PROFILES;
+    m_count    = sizeof(BUILTIN_PROFILES) / sizeof(BUILTIN_PROFILES[0]);
+}
+
+/** @brief Get a profile */
+const EvProfile* EvProfileLibrary::get(unsigned int id) const
+{
+    const EvProfile* profile = nullptr;
+    if ((id != 0) && (id <= m_count))
+    {
+        // Reject the profiles which can not be evaluated
+        const EvProfile* candidate = &m_profiles[id - 1u];
+        if ((candidate->capacity > 0.f) && (candidate->phases >= 1u) && (candidate->phases <= 3u))
+        {
+            profile = candidate;
+        }
+    }
+    return profile;
+}
@@ -0,0 +1,117 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef EVPROFILELIBRARY_H
+#define EVPROFILELIBRARY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/** @brief Charging profile of an electric vehicle (also the record format of the profile library files, little endian) */
+struct EvProfile
+{
+    /** @brief Battery capacity in Wh */
+    float capacity;
+    /** @brief State of charge when plugged (0 to 1) */
+    float initial_soc;
+    /** @brief State of charge at which the vehicle stops charging (0 to 1) */
+    float target_soc;
+    /** @brief State of charge at which the constant voltage phase starts, the power then decreases linearly (0 to 1) */
+    float cv_soc;
+    /** @brief Minimum power of the constant voltage phase (ratio of the maximum power) */
+    float min_power_ratio;
+    /** @brief Maximum charging power on an AC connector in W */
+    float max_ac_power;
+    /** @brief Maximum charging power on a DC connector in W */
+    float max_dc_power;
+    /** @brief Duration in s after which the vehicle leaves (0 = never) */
+    uint32_t departure;
+    /** @brief Number of phases used on an AC connector (1 to 3) */
+    uint32_t phases;
+};
+static_assert(sizeof(EvProfile) == 36u, "Unexpected EV profile record size");
+
+/** @brief Library of EV profiles, either built-in or memory mapped read-only from a file so that
+ *         all the Charge Points of a host share the same physical pages */
+class EvProfileLibrary
+{
+  public:
+    /** @brief Constructor (built-in profiles) */
+    EvProfileLibrary();
+
+    /** @brief Destructor */
+    virtual ~EvProfileLibrary();
+
+    /**
+     * @brief Map a profile library file, its profiles replace the built-in profiles
+     * @param path Path of the file
+     * @return true if the file has been mapped, false if the built-in profiles are used
+     */
+    bool open(const std::string& path);
+
+    /** @brief Unmap the profile library file and go back to the built-in profiles */
+    void close();
+
+    /** @brief Number of profiles */
+    size_t size() const { return m_count; }
+
+    /**
+     * @brief Get a profile
+     * @param id Id of the profile (index in the library + 1)
+     * @return Profile or nullptr if the profile does not exist or is invalid
+     */
+    const EvProfile* get(unsigned int id) const;
+
+  private:
+    /** @brief Header of the profile library files */
+    struct Header
+    {
+        /** @brief Magic number */
+        char magic[4];
+        /** @brief Version of the format */
+        uint32_t version;
+        /** @brief Size of a profile record */
+        uint32_t record_size;
+        /** @brief Number of profiles */
+        uint32_t count;
+    };
+
+    /** @brief Mapped memory */
+    void* m_memory;
+    /** @brief Size of the mapped memory */
+    size_t m_size;
+#ifdef _MSC_VER
+    /** @brief File */
+    void* m_file;
+    /** @brief File mapping */
+    void* m_mapping;
+#endif // _MSC_VER
+    /** @brief Profiles */
+    const EvProfile* m_profiles;
+    /** @brief Number of profiles */
+    size_t m_count;
+};
+
+#endif // EVPROFILELIBRARY_H
@@ -0,0 +1,137 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "GridModel.h"
+
+#include <algorithm>
+#include <cmath>
+
+/** @brief Time constant of the drift of the voltages in s */
+static constexpr float VOLTAGE_DRIFT_TIME_CONSTANT = 600.f;
+/** @brief Time constant of the imbalance between the phases in s */
+static constexpr float VOLTAGE_IMBALANCE_TIME_CONSTANT = 1800.f;
+/** @brief Time constant of the deviation of the frequency in s */
+static constexpr float FREQUENCY_TIME_CONSTANT = 60.f;
+/** @brief Standard deviation of a uniform number in [-1, 1[ */
+static constexpr float UNIFORM_DEVIATION = 0.57735027f;
+
+/** @brief Constructor */
+GridModel::GridModel()
+    : m_parameters(),
+      m_random(),
+      m_drift(0.f),
+      m_imbalances(),
+      m_sag_depths(),
+      m_sag_remainings(),
+      m_deviations(),
+      m_frequency_drift(0.f),
+      m_frequency(m_parameters.frequency)
+{
+}
+
+/** @brief Destructor */
+GridModel::~GridModel() { }
+
+/** @brief Set the parameters of the model and restart its random sequence */
+void GridModel::setParameters(const Parameters& parameters)
+{
+    m_parameters = parameters;
+    m_random.seed(parameters.seed);
+
+    // Start from a random point of the stationary state
+    m_drift = m_random.uniform() * m_parameters.voltage_drift / UNIFORM_DEVIATION;
+    for (size_t i = 0; i < MAX_PHASES; i++)
+    {
+        m_imbalances[i]     = m_random.uniform() * m_parameters.voltage_imbalance / UNIFORM_DEVIATION;
+        m_sag_depths[i]     = 0.f;
+        m_sag_remainings[i] = 0.f;
+        m_deviations[i]     = m_drift + m_imbalances[i];
+    }
+    m_frequency_drift = m_random.uniform() * m_parameters.frequency_deviation / UNIFORM_DEVIATION;
+    m_frequency       = m_parameters.frequency + m_frequency_drift;
+}
+
+/** @brief Make the site disturbances evolve */
+void GridModel::update(std::chrono::duration<float> elapsed)
+{
+    float elapsed_s = elapsed.count();
+
+    // Slow variations
+    m_drift           = walk(m_drift, m_parameters.voltage_drift, VOLTAGE_DRIFT_TIME_CONSTANT, elapsed_s);
+    m_frequency_drift = walk(m_frequency_drift, m_parameters.frequency_deviation, FREQUENCY_TIME_CONSTANT, elapsed_s);
+    m_frequency       = m_parameters.frequency + m_frequency_drift;
+
+    // Sags start randomly on a single phase or on all the phases, each phase recovers independently
+    for (size_t i = 0; i < MAX_PHASES; i++)
+    {
+        m_imbalances[i] = walk(m_imbalances[i], m_parameters.voltage_imbalance, VOLTAGE_IMBALANCE_TIME_CONSTANT, elapsed_s);
+        m_sag_remainings[i] -= elapsed_s;
+        if (m_sag_remainings[i] <= 0.f)
+        {
+            m_sag_depths[i]     = 0.f;
+            m_sag_remainings[i] = 0.f;
+        }
+    }
+    float sag_probability = m_parameters.sags_per_hour * elapsed_s / 3600.f;
+    if ((m_random.uniform() * 0.5f + 0.5f) < sag_probability)
+    {
+        float  depth    = m_parameters.sag_depth * (0.75f + 0.25f * m_random.uniform());
+        float  duration = std::chrono::duration<float>(m_parameters.sag_duration).count() * (1.f + 0.5f * m_random.uniform());
+        size_t phase    = static_cast<size_t>((m_random.uniform() * 0.5f + 0.5f) * (MAX_PHASES + 1u));
+        for (size_t i = 0; i < MAX_PHASES; i++)
+        {
+            if ((phase == MAX_PHASES) || (phase == i))
+            {
+                m_sag_depths[i]     = depth;
+                m_sag_remainings[i] = duration;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < MAX_PHASES; i++)
+    {
+        m_deviations[i] = m_drift + m_imbalances[i] - m_sag_depths[i];
+    }
+}
+
+/** @brief Generate the noise of the measured voltages */
+void GridModel::fillNoise(float* noises, size_t count)
+{
+    const float amplitude = m_parameters.voltage_noise;
+    m_random.fill(noises, count);
+    for (size_t i = 0; i < count; i++)
+    {
+        noises[i] *= amplitude;
+    }
+}
+
+/** @brief Make a mean reverting random walk evolve */
+float GridModel::walk(float value, float deviation, float time_constant, float elapsed)
+{
+    // Discrete Ornstein-Uhlenbeck process, bounded to avoid unrealistic excursions on long periods
+    float ratio  = std::min(elapsed / time_constant, 1.f);
+    float step   = deviation * std::sqrt(2.f * ratio) / UNIFORM_DEVIATION;
+    float result = value * (1.f - ratio) + step * m_random.uniform();
+    return std::clamp(result, -3.f * deviation, 3.f * deviation);
+}
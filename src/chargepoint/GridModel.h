@@ -0,0 +1,124 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef GRIDMODEL_H
+#define GRIDMODEL_H
+
+#include "MeterSnapshot.h"
+#include "Xoshiro128Plus.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+/** @brief Simulate the disturbances of the grid of a site : slow drift, phase imbalance, sags and noise on the voltages
+ *         and deviations of the frequency */
+class GridModel
+{
+  public:
+    /** @brief Maximum number of phases */
+    static constexpr size_t MAX_PHASES = MeterSnapshot::MAX_PHASES;
+
+    /** @brief Parameters of the model (all the disturbances are disabled by default) */
+    struct Parameters
+    {
+        /** @brief Seed of the random generator, the same seed always gives the same sequence of disturbances */
+        uint64_t seed = 0;
+        /** @brief Standard deviation of the slow drift of the voltages (ratio of the nominal voltage) */
+        float voltage_drift = 0.f;
+        /** @brief Standard deviation of the imbalance between the phases (ratio of the nominal voltage) */
+        float voltage_imbalance = 0.f;
+        /** @brief Amplitude of the noise on each measured voltage (ratio of the nominal voltage) */
+        float voltage_noise = 0.f;
+        /** @brief Average number of voltage sags per hour */
+        float sags_per_hour = 0.f;
+        /** @brief Maximum depth of the voltage sags (ratio of the nominal voltage) */
+        float sag_depth = 0.f;
+        /** @brief Average duration of the voltage sags */
+        std::chrono::milliseconds sag_duration = std::chrono::milliseconds(0);
+        /** @brief Nominal frequency in Hz */
+        float frequency = 50.f;
+        /** @brief Standard deviation of the frequency in Hz */
+        float frequency_deviation = 0.f;
+    };
+
+    /** @brief Constructor (no disturbance) */
+    GridModel();
+
+    /** @brief Destructor */
+    virtual ~GridModel();
+
+    /**
+     * @brief Set the parameters of the model and restart its random sequence
+     * @param parameters Parameters
+     */
+    void setParameters(const Parameters& parameters);
+
+    /** @brief Get the parameters of the model */
+    const Parameters& parameters() const { return m_parameters; }
+
+    /**
+     * @brief Make the site disturbances evolve
+     * @param elapsed Time elapsed since the last evolution
+     */
+    void update(std::chrono::duration<float> elapsed);
+
+    /** @brief Deviation of the voltage of each phase of the site (ratio of the nominal voltage) */
+    const std::array<float, MAX_PHASES>& deviations() const { return m_deviations; }
+
+    /** @brief Frequency of the site in Hz */
+    float frequency() const { return m_frequency; }
+
+    /**
+     * @brief Generate the noise of the measured voltages
+     * @param noises Buffer to fill with the noises (ratio of the nominal voltage)
+     * @param count Number of values
+     */
+    void fillNoise(float* noises, size_t count);
+
+  private:
+    /** @brief Parameters */
+    Parameters m_parameters;
+    /** @brief Random generator */
+    Xoshiro128Plus<> m_random;
+    /** @brief Slow drift common to all the phases */
+    float m_drift;
+    /** @brief Imbalance of each phase */
+    std::array<float, MAX_PHASES> m_imbalances;
+    /** @brief Depth of the current sag of each phase */
+    std::array<float, MAX_PHASES> m_sag_depths;
+    /** @brief Remaining duration of the current sag of each phase */
+    std::array<float, MAX_PHASES> m_sag_remainings;
+    /** @brief Deviation of the voltage of each phase */
+    std::array<float, MAX_PHASES> m_deviations;
+    /** @brief Deviation of the frequency in Hz */
+    float m_frequency_drift;
+    /** @brief Frequency in Hz */
+    float m_frequency;
+
+    /** @brief Make a mean reverting random walk evolve, its standard deviation stays around the given deviation */
+    float walk(float value, float deviation, float time_constant, float elapsed);
+};
+
+#endif // GRIDMODEL_H
@@ -0,0 +1,381 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "MeterEngine.h"
+
+#include <openocpp/ITimerPool.h>
+
+#include <algorithm>
+#include <cmath>
+
+/** @brief Constructor */
+MeterEngine::MeterEngine(ocpp::helpers::ITimerPool& timer_pool, std::chrono::milliseconds update_period)
+    : m_update_timer(timer_pool),
+      m_update_period(std::max(update_period, MIN_UPDATE_PERIOD)),
+      m_last_update(),
+      m_mutex(),
+      m_phases_counts(),
+      m_types(),
+      m_active(),
+      m_voltages(),
+      m_measured_voltages(),
+      m_consumptions(),
+      m_power_scales(),
+      m_grid_sensitivities(),
+      m_grid_noises(),
+      m_grid(),
+      m_powers(),
+      m_reactive_ratios(),
+      m_reactive_powers(),
+      m_temperatures(),
+      m_energies(),
+      m_energy_compensations(),
+      m_extra_energies(),
+      m_extra_compensations(),
+      m_registers(),
+      m_last_registers_sync(),
+      m_power_factors(),
+      m_snapshots(),
+      m_ticks(0),
+      m_last_tick_duration(0),
+      m_max_tick_duration(0),
+      m_total_tick_duration(0)
+{
+    // Register to timer events
+    m_update_timer.setCallback([this] { update(std::chrono::steady_clock::now()); });
+}
+
+/** @brief Destructor */
+MeterEngine::~MeterEngine()
+{
+    stop();
+}
+
+/** @brief Persist the energy registers of the meters in a file and restore the stored values */
+bool MeterEngine::openRegisters(const std::string& path, size_t count)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_last_registers_sync = std::chrono::steady_clock::now();
+    return m_registers.open(path, count * (1u + EXTRA_REGISTERS));
+}
+
+/** @brief Add a meter */
+size_t MeterEngine::addMeter(unsigned int phases_count, ConnectorData::ConnectorType type)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    size_t meter = m_phases_counts.size();
+    m_phases_counts.push_back(std::min(phases_count, static_cast<unsigned int>(MAX_PHASES)));
+    m_types.push_back(type);
+    m_active.push_back(0u);
+    m_voltages.resize(m_voltages.size() + MAX_PHASES, 0.f);
+    m_measured_voltages.resize(m_measured_voltages.size() + MAX_PHASES, 0.f);
+    m_consumptions.resize(m_consumptions.size() + MAX_PHASES, 0.f);
+    m_power_scales.resize(m_power_scales.size() + MAX_PHASES, 0.f);
+    m_grid_sensitivities.resize(m_grid_sensitivities.size() + MAX_PHASES, 0.f);
+    m_grid_noises.resize(m_grid_noises.size() + MAX_PHASES, 0.f);
+    m_powers.resize(m_powers.size() + MAX_PHASES, 0.f);
+    m_reactive_ratios.push_back(0.f);
+    m_reactive_powers.resize(m_reactive_powers.size() + MAX_PHASES, 0.f);
+    m_temperatures.push_back(AMBIENT_TEMPERATURE);
+    m_energies.push_back(m_registers.get(meter * (1u + EXTRA_REGISTERS)));
+    m_energy_compensations.push_back(0.);
+    for (size_t j = 0; j < EXTRA_REGISTERS; j++)
+    {
+        m_extra_energies.push_back(m_registers.get(meter * (1u + EXTRA_REGISTERS) + 1u + j));
+    }
+    m_extra_compensations.resize(m_extra_compensations.size() + EXTRA_REGISTERS, 0.);
+    m_power_factors.push_back(0.f);
+    m_snapshots.emplace_back();
+    updatePowerScales(meter);
+    publishSnapshot(meter);
+
+    return meter;
+}
+
+/** @brief Set the parameters of the grid disturbances applied to the voltages of the AC meters */
+void MeterEngine::setGrid(const GridModel::Parameters& parameters)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_grid.setParameters(parameters);
+}
+
+/** @brief Start the integration of the meters */
+void MeterEngine::start()
+{
+    // Start update timer
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_last_update = std::chrono::steady_clock::now();
+    }
+    m_update_timer.start(m_update_period);
+}
+
+/** @brief Stop the integration of the meters */
+void MeterEngine::stop()
+{
+    // Stop update timer
+    m_update_timer.stop();
+
+    // Write the last values of the registers
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_registers.sync(true);
+}
+
+/** @brief Enable or disable the energy integration of a meter */
+void MeterEngine::setActive(size_t meter, bool active)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_active[meter] = (active ? 1u : 0u);
+}
+
+/** @brief Set the voltages of a meter in V */
+void MeterEngine::setVoltages(size_t meter, const std::vector<float>& voltages)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (size_t i = 0; (i < m_phases_counts[meter]) && (i < voltages.size()); i++)
+    {
+        m_voltages[meter * MAX_PHASES + i]          = voltages[i];
+        m_measured_voltages[meter * MAX_PHASES + i] = voltages[i];
+    }
+    updatePowerScales(meter);
+    publishSnapshot(meter);
+}
+
+/** @brief Set the consumptions of a meter (in A for AC, in W for DC) */
+void MeterEngine::setConsumptions(size_t meter, const std::vector<float>& consumptions)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (size_t i = 0; (i < m_phases_counts[meter]) && (i < consumptions.size()); i++)
+    {
+        m_consumptions[meter * MAX_PHASES + i] = consumptions[i];
+    }
+    publishSnapshot(meter);
+}
+
+/** @brief Set the power factor of a meter */
+void MeterEngine::setPowerFactor(size_t meter, float power_factor)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_power_factors[meter] = power_factor;
+
+    // Inductive load : Q = P * tan(acos(pf))
+    float reactive_ratio = 0.f;
+    if ((m_types[meter] == ConnectorData::ConnectorType::AC) && (power_factor > 0.f) && (power_factor < 1.f))
+    {
+        reactive_ratio = std::sqrt(1.f - power_factor * power_factor) / power_factor;
+    }
+    m_reactive_ratios[meter] = reactive_ratio;
+    publishSnapshot(meter);
+}
+
+/** @brief Get the snapshot of a meter */
+const SeqLock<MeterSnapshot>& MeterEngine::getSnapshot(size_t meter) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_snapshots[meter];
+}
+
+/** @brief Get the statistics */
+MeterEngine::Stats MeterEngine::stats() const
+{
+    Stats stats;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        stats.meters    = m_phases_counts.size();
+        stats.grid_seed = m_grid.parameters().seed;
+    }
+    stats.update_period       = m_update_period;
+    stats.ticks               = m_ticks;
+    stats.last_tick_duration  = std::chrono::nanoseconds(m_last_tick_duration.load());
+    stats.max_tick_duration   = std::chrono::nanoseconds(m_max_tick_duration.load());
+    stats.total_tick_duration = std::chrono::nanoseconds(m_total_tick_duration.load());
+    return stats;
+}
+
+/** @brief Update the values of all the meters */
+void MeterEngine::update(std::chrono::steady_clock::time_point now)
+{
+    auto start = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // Time really elapsed since the last update (the timer may drift under load)
+        auto elapsed  = std::max(now - m_last_update, std::chrono::steady_clock::duration::zero());
+        m_last_update = now;
+
+        // Make the grid disturbances evolve, the voltage noises are generated in a single batch
+        const size_t values_count = m_powers.size();
+        m_grid.update(elapsed);
+        m_grid.fillNoise(m_grid_noises.data(), values_count);
+
+        // Compute the measured voltages and the powers, the loop has no branch so that it can be vectorized
+        const std::array<float, MAX_PHASES>& deviations        = m_grid.deviations();
+        const float*                         voltages          = m_voltages.data();
+        const float*                         consumptions      = m_consumptions.data();
+        const float*                         scales            = m_power_scales.data();
+        const float*                         sensitivities     = m_grid_sensitivities.data();
+        const float*                         noises            = m_grid_noises.data();
+        const float*                         reactive_ratios   = m_reactive_ratios.data();
+        float*                               measured_voltages = m_measured_voltages.data();
+        float*                               powers            = m_powers.data();
+        float*                               reactive_powers   = m_reactive_powers.data();
+        for (size_t i = 0; i < values_count; i += MAX_PHASES)
+        {
+            const float reactive_ratio = reactive_ratios[i / MAX_PHASES];
+            for (size_t j = 0; j < MAX_PHASES; j++)
+            {
+                float factor             = 1.f + sensitivities[i + j] * (deviations[j] + noises[i + j]);
+                measured_voltages[i + j] = voltages[i + j] * factor;
+                powers[i + j]            = consumptions[i + j] * scales[i + j] * factor;
+                reactive_powers[i + j]   = powers[i + j] * reactive_ratio;
+            }
+        }
+
+        // Compute energies over the elapsed time, the compensated summation keeps the sub-Wh increments of the short periods
+        double elapsed_h = std::chrono::duration<double, std::ratio<3600>>(elapsed).count();
+
+        const size_t   meters_count        = m_energies.size();
+        const uint8_t* active              = m_active.data();
+        double*        energies            = m_energies.data();
+        double*        compensations       = m_energy_compensations.data();
+        double*        extra_energies      = m_extra_energies.data();
+        double*        extra_compensations = m_extra_compensations.data();
+        for (size_t i = 0; i < meters_count; i++)
+        {
+            double power     = static_cast<double>(powers[i * MAX_PHASES]) + powers[i * MAX_PHASES + 1u] + powers[i * MAX_PHASES + 2u];
+            double increment = power * elapsed_h * active[i] - compensations[i];
+            double energy    = energies[i] + increment;
+            compensations[i] = (energy - energies[i]) - increment;
+            energies[i]      = energy;
+
+            // Exported energy and reactive energies
+            double reactive_power = static_cast<double>(reactive_powers[i * MAX_PHASES]) + reactive_powers[i * MAX_PHASES + 1u] +
+                                    reactive_powers[i * MAX_PHASES + 2u];
+            double extra_powers[EXTRA_REGISTERS] = {std::max(-power, 0.), std::max(reactive_power, 0.), std::max(-reactive_power, 0.)};
+            for (size_t j = 0; j < EXTRA_REGISTERS; j++)
+            {
+                size_t index               = i * EXTRA_REGISTERS + j;
+                double extra_increment     = extra_powers[j] * elapsed_h * active[i] - extra_compensations[index];
+                double extra_energy        = extra_energies[index] + extra_increment;
+                extra_compensations[index] = (extra_energy - extra_energies[index]) - extra_increment;
+                extra_energies[index]      = extra_energy;
+            }
+        }
+
+        // Heating of the meters by the current of their most loaded phase (first order thermal model)
+        float  elapsed_s    = std::chrono::duration<float>(elapsed).count();
+        float  heating      = std::min(elapsed_s / TEMPERATURE_TIME_CONSTANT, 1.f);
+        float* temperatures = m_temperatures.data();
+        for (size_t i = 0; i < meters_count; i++)
+        {
+            float current = 0.f;
+            for (size_t j = 0; j < MAX_PHASES; j++)
+            {
+                float voltage = measured_voltages[i * MAX_PHASES + j];
+                current       = std::max(current, ((voltage > 0.f) ? (std::fabs(powers[i * MAX_PHASES + j]) / voltage) : 0.f));
+            }
+            float target = AMBIENT_TEMPERATURE + TEMPERATURE_RISE * current;
+            temperatures[i] += (target - temperatures[i]) * heating;
+        }
+
+        // Persist the registers, the memory mapped file is written back lazily
+        for (size_t i = 0; i < meters_count; i++)
+        {
+            m_registers.set(i * (1u + EXTRA_REGISTERS), energies[i]);
+            for (size_t j = 0; j < EXTRA_REGISTERS; j++)
+            {
+                m_registers.set(i * (1u + EXTRA_REGISTERS) + 1u + j, extra_energies[i * EXTRA_REGISTERS + j]);
+            }
+        }
+        if ((now - m_last_registers_sync) >= REGISTERS_SYNC_PERIOD)
+        {
+            m_registers.sync(false);
+            m_last_registers_sync = now;
+        }
+
+        // Publish the new values
+        for (size_t i = 0; i < meters_count; i++)
+        {
+            publishSnapshot(i);
+        }
+    }
+
+    // Update statistics
+    int64_t tick_duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    m_ticks++;
+    m_last_tick_duration = tick_duration;
+    m_total_tick_duration += tick_duration;
+    int64_t max_tick_duration = m_max_tick_duration.load();
+    while ((tick_duration > max_tick_duration) && !m_max_tick_duration.compare_exchange_weak(max_tick_duration, tick_duration)) { }
+}
+
+/** @brief Compute the factors converting the consumptions of a meter into powers */
+void MeterEngine::updatePowerScales(size_t meter)
+{
+    // The consumption is already a power for DC (single phase) which is not affected by the grid disturbances
+    for (size_t i = 0; i < MAX_PHASES; i++)
+    {
+        float scale       = 0.f;
+        float sensitivity = 0.f;
+        if (i < m_phases_counts[meter])
+        {
+            if (m_types[meter] == ConnectorData::ConnectorType::AC)
+            {
+                scale       = m_voltages[meter * MAX_PHASES + i];
+                sensitivity = 1.f;
+            }
+            else if (i == 0)
+            {
+                scale = 1.f;
+            }
+        }
+        m_power_scales[meter * MAX_PHASES + i]       = scale;
+        m_grid_sensitivities[meter * MAX_PHASES + i] = sensitivity;
+    }
+}
+
+/** @brief Publish the snapshot of a meter */
+void MeterEngine::publishSnapshot(size_t meter)
+{
+    // Called with the lock held : single writer
+    MeterSnapshot snapshot;
+    snapshot.type   = m_types[meter];
+    snapshot.phases = m_phases_counts[meter];
+    for (size_t i = 0; i < MAX_PHASES; i++)
+    {
+        snapshot.voltages[i]        = m_measured_voltages[meter * MAX_PHASES + i];
+        snapshot.consumptions[i]    = m_consumptions[meter * MAX_PHASES + i];
+        snapshot.powers[i]          = m_powers[meter * MAX_PHASES + i];
+        snapshot.reactive_powers[i] = m_reactive_powers[meter * MAX_PHASES + i];
+    }
+    snapshot.energy                 = static_cast<int64_t>(m_energies[meter]);
+    snapshot.energy_export          = static_cast<int64_t>(m_extra_energies[meter * EXTRA_REGISTERS]);
+    snapshot.reactive_energy        = static_cast<int64_t>(m_extra_energies[meter * EXTRA_REGISTERS + 1u]);
+    snapshot.reactive_energy_export = static_cast<int64_t>(m_extra_energies[meter * EXTRA_REGISTERS + 2u]);
+    snapshot.power_factor           = m_power_factors[meter];
+    snapshot.frequency              = m_grid.frequency();
+    snapshot.temperature            = m_temperatures[meter];
+    m_snapshots[meter].store(snapshot);
+}
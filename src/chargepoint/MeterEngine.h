@@ -0,0 +1,221 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef METERENGINE_H
+#define METERENGINE_H
+
+#include "ConnectorData.h"
+#include "GridModel.h"
+#include "MeterRegisters.h"
+#include "MeterSnapshot.h"
+#include "SeqLock.h"
+#include <openocpp/Timer.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/** @brief Simulate all the meters of the Charge Point, their values are stored in structure of arrays
+ *         and integrated in a single pass on each tick of a single timer, then published as snapshots
+ *         which can be read without blocking the integration */
+class MeterEngine
+{
+  public:
+    /** @brief Maximum number of phases of a meter */
+    static constexpr size_t MAX_PHASES = MeterSnapshot::MAX_PHASES;
+    /** @brief Minimum update period */
+    static constexpr std::chrono::milliseconds MIN_UPDATE_PERIOD = std::chrono::milliseconds(10);
+    /** @brief Period of the writes of the energy registers to their file */
+    static constexpr std::chrono::seconds REGISTERS_SYNC_PERIOD = std::chrono::seconds(10);
+    /** @brief Number of additional energy registers of a meter : exported energy, reactive energy and exported reactive energy */
+    static constexpr size_t EXTRA_REGISTERS = 3u;
+    /** @brief Ambient temperature of the meters in °C */
+    static constexpr float AMBIENT_TEMPERATURE = 25.f;
+    /** @brief Temperature rise of the meters in °C per A of the most loaded phase */
+    static constexpr float TEMPERATURE_RISE = 0.25f;
+    /** @brief Thermal time constant of the meters in s */
+    static constexpr float TEMPERATURE_TIME_CONSTANT = 300.f;
+
+    /** @brief Statistics */
+    struct Stats
+    {
+        /** @brief Number of meters */
+        size_t meters;
+        /** @brief Update period */
+        std::chrono::milliseconds update_period;
+        /** @brief Number of ticks */
+        uint64_t ticks;
+        /** @brief Duration of the last tick */
+        std::chrono::nanoseconds last_tick_duration;
+        /** @brief Longest tick */
+        std::chrono::nanoseconds max_tick_duration;
+        /** @brief Cumulated duration of the ticks */
+        std::chrono::nanoseconds total_tick_duration;
+        /** @brief Seed of the grid model */
+        uint64_t grid_seed;
+    };
+
+    /**
+     * @brief Constructor
+     * @param timer_pool Timer pool
+     * @param update_period Update period (at least MIN_UPDATE_PERIOD)
+     */
+    MeterEngine(ocpp::helpers::ITimerPool& timer_pool, std::chrono::milliseconds update_period);
+
+    /** @brief Destructor */
+    virtual ~MeterEngine();
+
+    /**
+     * @brief Persist the energy registers of the meters in a file and restore the stored values (must be called before adding the meters)
+     *        Each meter uses 1 + EXTRA_REGISTERS consecutive registers : total energy followed by the additional registers
+     * @param path Path of the file
+     * @param count Number of meters to persist
+     * @return true if the registers are persisted, false otherwise
+     */
+    bool openRegisters(const std::string& path, size_t count);
+
+    /**
+     * @brief Add a meter (meters are never removed)
+     * @param phases_count Number of phases (limited to MAX_PHASES)
+     * @param type Connector type (AC/DC)
+     * @return Index of the meter
+     */
+    size_t addMeter(unsigned int phases_count, ConnectorData::ConnectorType type);
+
+    /**
+     * @brief Set the parameters of the grid disturbances applied to the voltages of the AC meters
+     * @param parameters Parameters of the grid model
+     */
+    void setGrid(const GridModel::Parameters& parameters);
+
+    /** @brief Start the integration of the meters */
+    void start();
+
+    /** @brief Stop the integration of the meters */
+    void stop();
+
+    /** @brief Enable or disable the energy integration of a meter */
+    void setActive(size_t meter, bool active);
+
+    /** @brief Set the nominal voltages of a meter in V */
+    void setVoltages(size_t meter, const std::vector<float>& voltages);
+
+    /** @brief Set the consumptions of a meter (in A for AC, in W for DC) */
+    void setConsumptions(size_t meter, const std::vector<float>& consumptions);
+
+    /** @brief Set the power factor of a meter */
+    void setPowerFactor(size_t meter, float power_factor);
+
+    /**
+     * @brief Get the snapshot of a meter, updated on each tick and on each modification of the meter
+     * @param meter Index of the meter
+     * @return Snapshot which stays valid for the lifetime of the engine
+     */
+    const SeqLock<MeterSnapshot>& getSnapshot(size_t meter) const;
+
+    /** @brief Get the statistics */
+    Stats stats() const;
+
+    /**
+     * @brief Update the values of all the meters, called on each tick of the timer with the current time
+     *        (can also be called with controlled times when the engine is not started)
+     * @param now Time of the update, the energies are integrated over the time elapsed since the previous update
+     */
+    void update(std::chrono::steady_clock::time_point now);
+
+  private:
+    /** @brief Timer to update the meter values */
+    ocpp::helpers::Timer m_update_timer;
+    /** @brief Update period */
+    const std::chrono::milliseconds m_update_period;
+    /** @brief Time of the last update, the energies are integrated over the measured elapsed time */
+    std::chrono::steady_clock::time_point m_last_update;
+    /** @brief Lock to protect the meter values */
+    mutable std::mutex m_mutex;
+
+    /** @brief Number of phases of each meter (constant once added) */
+    std::vector<unsigned int> m_phases_counts;
+    /** @brief Connector type of each meter (constant once added) */
+    std::vector<ConnectorData::ConnectorType> m_types;
+    /** @brief Indicate if the energy of each meter is integrated */
+    std::vector<uint8_t> m_active;
+    /** @brief Nominal voltages in V (MAX_PHASES per meter) */
+    std::vector<float> m_voltages;
+    /** @brief Measured voltages in V including the grid disturbances (MAX_PHASES per meter) */
+    std::vector<float> m_measured_voltages;
+    /** @brief Consumptions in A for AC, in W for DC (MAX_PHASES per meter) */
+    std::vector<float> m_consumptions;
+    /** @brief Factors to convert the consumptions in powers : voltage for AC, 1 for DC, 0 for the missing phases (MAX_PHASES per meter) */
+    std::vector<float> m_power_scales;
+    /** @brief Sensitivity to the grid disturbances : 1 for the AC phases, 0 otherwise (MAX_PHASES per meter) */
+    std::vector<float> m_grid_sensitivities;
+    /** @brief Noises of the measured voltages (MAX_PHASES per meter) */
+    std::vector<float> m_grid_noises;
+    /** @brief Grid disturbances of the site */
+    GridModel m_grid;
+    /** @brief Instant powers in W (MAX_PHASES per meter) */
+    std::vector<float> m_powers;
+    /** @brief Ratio of the reactive power to the active power given by the power factor (0 for DC) */
+    std::vector<float> m_reactive_ratios;
+    /** @brief Instant reactive powers in var (MAX_PHASES per meter) */
+    std::vector<float> m_reactive_powers;
+    /** @brief Temperatures in °C */
+    std::vector<float> m_temperatures;
+    /** @brief Total energies in Wh */
+    std::vector<double> m_energies;
+    /** @brief Compensations of the rounding errors of the energies (Kahan summation) */
+    std::vector<double> m_energy_compensations;
+    /** @brief Additional energy registers in Wh or varh (EXTRA_REGISTERS per meter) */
+    std::vector<double> m_extra_energies;
+    /** @brief Compensations of the rounding errors of the additional energy registers (EXTRA_REGISTERS per meter) */
+    std::vector<double> m_extra_compensations;
+    /** @brief Persisted energy registers */
+    MeterRegisters m_registers;
+    /** @brief Time of the last write of the energy registers to their file */
+    std::chrono::steady_clock::time_point m_last_registers_sync;
+    /** @brief Power factors */
+    std::vector<float> m_power_factors;
+    /** @brief Published snapshots (the elements of a deque are never moved) */
+    std::deque<SeqLock<MeterSnapshot>> m_snapshots;
+
+    /** @brief Number of ticks */
+    std::atomic<uint64_t> m_ticks;
+    /** @brief Duration of the last tick in ns */
+    std::atomic<int64_t> m_last_tick_duration;
+    /** @brief Longest tick in ns */
+    std::atomic<int64_t> m_max_tick_duration;
+    /** @brief Cumulated duration of the ticks in ns */
+    std::atomic<int64_t> m_total_tick_duration;
+
+    /** @brief Compute the factors converting the consumptions of a meter into powers */
+    void updatePowerScales(size_t meter);
+    /** @brief Publish the snapshot of a meter */
+    void publishSnapshot(size_t meter);
+};
+
+#endif // METERENGINE_H
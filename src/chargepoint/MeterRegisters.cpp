@@ -0,0 +1,190 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "MeterRegisters.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#ifdef _MSC_VER
+#include <Windows.h>
+#else // _MSC_VER
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif // _MSC_VER
+
+/** @brief Magic number of the registers file */
+static constexpr uint32_t METER_REGISTERS_MAGIC = 0x4745524Du;
+/** @brief Version of the format of the registers file */
+static constexpr uint32_t METER_REGISTERS_VERSION = 2u;
+
+/** @brief Constructor */
+MeterRegisters::MeterRegisters()
+    : m_memory(nullptr),
+      m_size(0),
+#ifdef _MSC_VER
+      m_file(INVALID_HANDLE_VALUE),
+      m_mapping(nullptr),
+#endif // _MSC_VER
+      m_registers(nullptr),
+      m_count(0),
+      m_local_registers()
+{
+}
+
+/** @brief Destructor */
+MeterRegisters::~MeterRegisters()
+{
+    close();
+}
+
+/** @brief Open the registers file */
+bool MeterRegisters::open(const std::string& path, size_t count)
+{
+    close();
+
+    // Map the file, a newly created file is zero filled
+    size_t size = sizeof(Header) + count * sizeof(double);
+#ifdef _MSC_VER
+    m_file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file != INVALID_HANDLE_VALUE)
+    {
+        LARGE_INTEGER file_size;
+        if (GetFileSizeEx(m_file, &file_size) && (static_cast<size_t>(file_size.QuadPart) > size))
+        {
+            // Keep the registers beyond the requested count
+            size = static_cast<size_t>(file_size.QuadPart);
+        }
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READWRITE, static_cast<DWORD>(static_cast<uint64_t>(size) >> 32u),
+                                       static_cast<DWORD>(size & 0xFFFFFFFFu), nullptr);
+        if (m_mapping)
+        {
+            m_memory = MapViewOfFile(m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+        }
+    }
+#else // _MSC_VER
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd >= 0)
+    {
+        off_t file_size = lseek(fd, 0, SEEK_END);
+        if ((file_size > 0) && (static_cast<size_t>(file_size) > size))
+        {
+            // Keep the registers beyond the requested count
+            size = static_cast<size_t>(file_size);
+        }
+        if (ftruncate(fd, static_cast<off_t>(size)) == 0)
+        {
+            void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (memory != MAP_FAILED)
+            {
+                m_memory = memory;
+            }
+        }
+        ::close(fd);
+    }
+#endif // _MSC_VER
+
+    if (m_memory)
+    {
+        m_size      = size;
+        m_count     = count;
+        m_registers = reinterpret_cast<double*>(reinterpret_cast<uint8_t*>(m_memory) + sizeof(Header));
+
+        // Check the stored registers
+        Header* header = reinterpret_cast<Header*>(m_memory);
+        if ((header->magic != METER_REGISTERS_MAGIC) || (header->version != METER_REGISTERS_VERSION))
+        {
+            memset(m_memory, 0, m_size);
+            header->magic   = METER_REGISTERS_MAGIC;
+            header->version = METER_REGISTERS_VERSION;
+        }
+        else
+        {
+            // Registers beyond the previous count have been zero filled by the resize
+            std::cout << "Meter registers restored from " << path << std::endl;
+        }
+        header->count = std::max(header->count, static_cast<uint64_t>(m_count));
+    }
+    else
+    {
+        // Process local fallback
+        std::cout << "Unable to map the meter registers file " << path << ", the registers will not be persisted" << std::endl;
+        close();
+        m_local_registers.assign(count, 0.);
+        m_registers = m_local_registers.data();
+        m_count     = count;
+    }
+
+    return (m_memory != nullptr);
+}
+
+/** @brief Flush and close the registers file */
+void MeterRegisters::close()
+{
+    if (m_memory)
+    {
+        sync(true);
+#ifdef _MSC_VER
+        UnmapViewOfFile(m_memory);
+#else // _MSC_VER
+        munmap(m_memory, m_size);
+#endif // _MSC_VER
+        m_memory = nullptr;
+    }
+#ifdef _MSC_VER
+    if (m_mapping)
+    {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+    if (m_file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+    }
+#endif // _MSC_VER
+    m_size      = 0;
+    m_registers = nullptr;
+    m_count     = 0;
+    m_local_registers.clear();
+}
+
+/** @brief Write the modified registers to the file */
+void MeterRegisters::sync(bool wait)
+{
+    if (m_memory)
+    {
+#ifdef _MSC_VER
+        FlushViewOfFile(m_memory, m_size);
+        if (wait)
+        {
+            FlushFileBuffers(m_file);
+        }
+#else // _MSC_VER
+        msync(m_memory, m_size, (wait ? MS_SYNC : MS_ASYNC));
+#endif // _MSC_VER
+    }
+}
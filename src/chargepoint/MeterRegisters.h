@@ -0,0 +1,105 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef METERREGISTERS_H
+#define METERREGISTERS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/** @brief Energy registers of the meters persisted in a memory mapped file so that they survive a restart */
+class MeterRegisters
+{
+  public:
+    /** @brief Constructor */
+    MeterRegisters();
+
+    /** @brief Destructor */
+    virtual ~MeterRegisters();
+
+    /**
+     * @brief Open the registers file, the registers already stored are kept
+     * @param path Path of the file
+     * @param count Number of registers
+     * @return true if the file has been mapped, false if the registers are only kept in memory
+     */
+    bool open(const std::string& path, size_t count);
+
+    /** @brief Flush and close the registers file */
+    void close();
+
+    /** @brief Number of registers */
+    size_t size() const { return m_count; }
+
+    /** @brief Get a register in Wh (0 if the register does not exist) */
+    double get(size_t index) const { return ((index < m_count) ? m_registers[index] : 0.); }
+
+    /** @brief Update a register in Wh (plain memory write, no system call), the registers beyond size() are ignored */
+    void set(size_t index, double energy)
+    {
+        if (index < m_count)
+        {
+            m_registers[index] = energy;
+        }
+    }
+
+    /**
+     * @brief Write the modified registers to the file
+     * @param wait Wait for the end of the write
+     */
+    void sync(bool wait);
+
+  private:
+    /** @brief Header of the file */
+    struct Header
+    {
+        /** @brief Magic number */
+        uint32_t magic;
+        /** @brief Version of the format */
+        uint32_t version;
+        /** @brief Number of registers */
+        uint64_t count;
+    };
+
+    /** @brief Mapped memory (header followed by the registers) */
+    void* m_memory;
+    /** @brief Size of the mapped memory */
+    size_t m_size;
+#ifdef _MSC_VER
+    /** @brief File */
+    void* m_file;
+    /** @brief File mapping */
+    void* m_mapping;
+#endif // _MSC_VER
+    /** @brief Registers in Wh */
+    double* m_registers;
+    /** @brief Number of registers */
+    size_t m_count;
+    /** @brief Registers kept in memory when the file can not be mapped */
+    std::vector<double> m_local_registers;
+};
+
+#endif // METERREGISTERS_H
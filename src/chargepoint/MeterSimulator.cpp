@@ -24,22 +24,16 @@ SOFTWARE.
 
 #include "MeterSimulator.h"
 
-#include <openocpp/ITimerPool.h>
+#include <algorithm>
 
 /** @brief Constructor */
-MeterSimulator::MeterSimulator(ocpp::helpers::ITimerPool& timer_pool, unsigned int phases_count, ConnectorData::ConnectorType type)
-    : m_update_timer(timer_pool),
-      m_phases_count(phases_count),
-      m_voltages(m_phases_count),
-      m_consumptions(m_phases_count),
-      m_powers(m_phases_count),
-      m_energy(0),
-      m_mutex(),
-      m_current_out_type(type)
+MeterSimulator::MeterSimulator(MeterEngine& engine, unsigned int phases_count, ConnectorData::ConnectorType type)
+    : m_engine(engine),
+      m_meter(engine.addMeter(phases_count, type)),
+      m_phases_count(std::min(phases_count, static_cast<unsigned int>(MeterSnapshot::MAX_PHASES))),
+      m_current_out_type(type),
+      m_snapshot(engine.getSnapshot(m_meter))
 {
-
-    // Register to timer events
-    m_update_timer.setCallback(std::bind(&MeterSimulator::update, this));
 }
 
 /** @brief Destructor */
@@ -51,115 +45,29 @@ MeterSimulator::~MeterSimulator()
 /** @brief Start the meter */
 void MeterSimulator::start()
 {
-    // Start update timer
-    m_update_timer.start(UPDATE_PERIOD);
+    m_engine.setActive(m_meter, true);
 }
 
 /** @brief Stop the meter */
 void MeterSimulator::stop()
 {
-    // Stop update timer
-    m_update_timer.stop();
+    m_engine.setActive(m_meter, false);
 }
 
 /** @brief Set the voltages in V */
 void MeterSimulator::setVoltages(const std::vector<float>& voltages)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    for (size_t i = 0; (i < m_phases_count) && (i < voltages.size()); i++)
-    {
-        m_voltages[i] = voltages[i];
-    }
+    m_engine.setVoltages(m_meter, voltages);
 }
 
 /** @brief Set the currents (in A for AC, in W for DC) */
 void MeterSimulator::setConsumptions(const std::vector<float>& consumptions)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    for (size_t i = 0; (i < m_phases_count) && (i < consumptions.size()); i++)
-    {
-        m_consumptions[i] = consumptions[i];
-    }
+    m_engine.setConsumptions(m_meter, consumptions);
 }
 
 /** @brief Set the power factor */
 void MeterSimulator::setPowerFactor(float powerFactor)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_power_factor = powerFactor;
-}
-
-/** @brief Get the voltages in V */
-std::vector<float> MeterSimulator::getVoltages()
-{
-    std::lock_guard<std::mutex> lock(m_mutex);
-    std::vector<float>          ret = m_voltages;
-    return ret;
-}
-
-/** @brief Get the consumptions (in A for AC, in W for DC) */
-std::vector<float> MeterSimulator::getConsumptions()
-{
-    std::lock_guard<std::mutex> lock(m_mutex);
-    std::vector<float>          ret = m_consumptions;
-    return ret;
-}
-
-/** @brief Get the instant powers in W */
-std::vector<float> MeterSimulator::getInstantPowers()
-{
-    std::lock_guard<std::mutex> lock(m_mutex);
-    std::vector<float>          ret = m_powers;
-    return ret;
-}
-
-/** @brief Get the total energy in Wh */
-int64_t MeterSimulator::getEnergy()
-{
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return (m_energy / 1000ll);
-}
-
-/** @brief Get the power factor */
-float MeterSimulator::getPowerFactor()
-{
-    std::lock_guard<std::mutex> lock(m_mutex);
-    float                       ret = m_power_factor;
-    return ret;
-}
-
-/** @brief Get the current out type (AC/DC) */
-ConnectorData::ConnectorType MeterSimulator::getCurrentOutType()
-{
-    std::lock_guard<std::mutex>  lock(m_mutex);
-    ConnectorData::ConnectorType ret = m_current_out_type;
-    return ret;
-}
-
-/** @brief Periodically update the meter values */
-void MeterSimulator::update()
-{
-    std::lock_guard<std::mutex> lock(m_mutex);
-
-    // Compute powers
-    if (m_current_out_type == ConnectorData::ConnectorType::AC)
-    {
-        for (size_t i = 0; i < m_phases_count; i++)
-        {
-            m_powers[i] = m_voltages[i] * m_consumptions[i];
-        }
-    }
-    //DC case 
-    else
-    {   // Single phase in DC, the consumption is already in power for DC
-         m_powers[0] = m_consumptions[0]; 
-    }
-
-    // Compute energy
-    unsigned int energy_mwh = 0;
-    for (size_t i = 0; i < m_phases_count; i++)
-    {
-        energy_mwh += static_cast<unsigned int>(static_cast<int64_t>(m_powers[i]) * UPDATE_PERIOD.count() / 3600ll);
-    }
-    m_energy += energy_mwh;
+    m_engine.setPowerFactor(m_meter, powerFactor);
 }
@@ -26,16 +26,14 @@ SOFTWARE.
 #define METERSIMULATOR_H
 
 #include "ConnectorData.h"
-#include <openocpp/Timer.h>
+#include "MeterEngine.h"
 
-#include <mutex>
-
-/** @brief Simulate a meter and its current/voltage consumption */
+/** @brief Simulate a meter and its current/voltage consumption (handle on a meter of the meter engine) */
 class MeterSimulator
 {
   public:
     /** @brief Constructor */
-    MeterSimulator(ocpp::helpers::ITimerPool& timer_pool, unsigned int phases_count, ConnectorData::ConnectorType type);
+    MeterSimulator(MeterEngine& engine, unsigned int phases_count, ConnectorData::ConnectorType type);
 
     /** @brief Destructor */
     virtual ~MeterSimulator();
@@ -56,55 +54,25 @@ class MeterSimulator
     void setPowerFactor(float powerFactor);
 
     /** @brief Get the number of phases */
-    unsigned int getNumberOfPhases() { return m_phases_count; }
-
-    /** @brief Get the voltages in V */
-    std::vector<float> getVoltages();
-
-    /** @brief Get the currents (in A for AC, in W for DC) */
-    std::vector<float> getConsumptions();
-
-    /** @brief Get the instant powers in W */ 
-    std::vector<float> getInstantPowers();
-
-    /** @brief Get the total energy in Wh */
-    int64_t getEnergy();
-
-    /** @brief Get the power factor */
-    float getPowerFactor();
+    unsigned int getNumberOfPhases() const { return m_phases_count; }
 
     /** @brief Get Connector type (AC/DC) */
-    ConnectorData::ConnectorType getCurrentOutType();
+    ConnectorData::ConnectorType getCurrentOutType() const { return m_current_out_type; }
+
+    /** @brief Get a consistent copy of the meter values (never blocks nor allocates) */
+    MeterSnapshot getSnapshot() const { return m_snapshot.load(); }
 
   private:
-    /** @brief Timer to update meter values */
-    ocpp::helpers::Timer m_update_timer;
+    /** @brief Meter engine */
+    MeterEngine& m_engine;
+    /** @brief Index of the meter in the engine */
+    const size_t m_meter;
     /** @brief Number of phases */
     const unsigned int m_phases_count;
-
-    /** @brief Voltages in V */
-    std::vector<float> m_voltages;
-    /** @brief Consumptions (in A for AC, in W for DC) */
-    std::vector<float> m_consumptions;
-    /** @brief Instant powers in W */
-    std::vector<float> m_powers;
-    /** @brief Total energy in mWh */
-    int64_t m_energy;
-
-    /** @brief Power factor */
-    float m_power_factor;
-
-    /** @brief Lock to protect meter values */
-    std::mutex m_mutex;
-
     /** @brief Connector type (AC/DC) */
-    ConnectorData::ConnectorType m_current_out_type;
-
-    /** @brief Update period */
-    static constexpr std::chrono::milliseconds UPDATE_PERIOD = std::chrono::milliseconds(500);
-
-    /** @brief Periodically update the meter values */
-    void update();
+    const ConnectorData::ConnectorType m_current_out_type;
+    /** @brief Snapshot of the meter values */
+    const SeqLock<MeterSnapshot>& m_snapshot;
 };
 
 #endif // METERSIMULATOR_H
@@ -0,0 +1,85 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef METERSNAPSHOT_H
+#define METERSNAPSHOT_H
+
+#include "ConnectorData.h"
+
+#include <array>
+#include <cstdint>
+
+/** @brief Consistent copy of the values of a meter */
+struct MeterSnapshot
+{
+    /** @brief Maximum number of phases of a meter */
+    static constexpr size_t MAX_PHASES = 3u;
+
+    /** @brief Default constructor */
+    MeterSnapshot()
+        : type(ConnectorData::ConnectorType::AC),
+          phases(0),
+          voltages(),
+          consumptions(),
+          powers(),
+          reactive_powers(),
+          energy(0),
+          energy_export(0),
+          reactive_energy(0),
+          reactive_energy_export(0),
+          power_factor(0.f),
+          frequency(0.f),
+          temperature(0.f)
+    {
+    }
+
+    /** @brief Connector type (AC/DC) */
+    ConnectorData::ConnectorType type;
+    /** @brief Number of phases */
+    unsigned int phases;
+    /** @brief Voltages in V */
+    std::array<float, MAX_PHASES> voltages;
+    /** @brief Consumptions (in A for AC, in W for DC) */
+    std::array<float, MAX_PHASES> consumptions;
+    /** @brief Instant powers in W */
+    std::array<float, MAX_PHASES> powers;
+    /** @brief Instant reactive powers in var */
+    std::array<float, MAX_PHASES> reactive_powers;
+    /** @brief Total energy in Wh */
+    int64_t energy;
+    /** @brief Total exported energy in Wh */
+    int64_t energy_export;
+    /** @brief Total reactive energy in varh */
+    int64_t reactive_energy;
+    /** @brief Total exported reactive energy in varh */
+    int64_t reactive_energy_export;
+    /** @brief Power factor */
+    float power_factor;
+    /** @brief Frequency in Hz */
+    float frequency;
+    /** @brief Temperature in °C */
+    float temperature;
+};
+
+#endif // METERSNAPSHOT_H
@@ -24,7 +24,10 @@ SOFTWARE.
 
 #include "SimulatedChargePoint.h"
 #include "ChargePointEventsHandler.h"
+#include "EvModel.h"
+#include "MeterEngine.h"
 #include "MeterSimulator.h"
+#include "MeterValuesStress.h"
 #include "MqttManager.h"
 #include "SimulatedChargePointConfig.h"
 #include "Version.h"
@@ -38,6 +41,18 @@ SOFTWARE.
 
 using namespace ocpp::types;
 
+/** @brief Derive a stable seed from a string (FNV-1a) */
+static uint64_t seedFromString(const std::string& str)
+{
+    uint64_t seed = 0xCBF29CE484222325ull;
+    for (char c : str)
+    {
+        seed ^= static_cast<uint8_t>(c);
+        seed *= 0x100000001B3ull;
+    }
+    return seed;
+}
+
 /** @brief Constructor */
 SimulatedChargePoint::SimulatedChargePoint(SimulatedChargePointConfig&  config,
                                            unsigned int                 max_charge_point_setpoint,
@@ -65,14 +80,48 @@ void SimulatedChargePoint::start()
     std::cout << "Starting simulated charge point v" << CHARGEPOINT_FW_VERSION << " : " << m_config.stackConfig().chargePointIdentifier()
               << std::endl;
 
+    // Meters of all the connectors
+    ocpp::helpers::TimerPool meters_timer_pool;
+    MeterEngine              meter_engine(meters_timer_pool, m_config.meterUpdatePeriod());
+    std::string              meters_registers_path = "meters.dat";
+    if (!m_config.workingDir().empty())
+    {
+        meters_registers_path = m_config.workingDir() + "/" + meters_registers_path;
+    }
+    meter_engine.openRegisters(meters_registers_path, m_config.ocppConfig().numberOfConnectors());
+
+    // Grid disturbances, each Charge Point gets its own reproducible grid unless a seed is configured
+    const GridConfig&     grid_config = m_config.gridConfig();
+    GridModel::Parameters grid;
+    grid.seed                = grid_config.seed();
+    grid.voltage_drift       = grid_config.voltageDrift() / 100.f;
+    grid.voltage_imbalance   = grid_config.voltageImbalance() / 100.f;
+    grid.voltage_noise       = grid_config.voltageNoise() / 100.f;
+    grid.sags_per_hour       = grid_config.sagsPerHour();
+    grid.sag_depth           = grid_config.sagDepth() / 100.f;
+    grid.sag_duration        = grid_config.sagDuration();
+    grid.frequency           = grid_config.frequency();
+    grid.frequency_deviation = grid_config.frequencyDeviation();
+    if (grid.seed == 0)
+    {
+        grid.seed = seedFromString(m_config.stackConfig().chargePointIdentifier());
+    }
+    std::cout << "Grid disturbances seed : " << grid.seed << std::endl;
+    meter_engine.setGrid(grid);
+
+    // MeterValues stress messages
+    MeterValuesStress meter_values_stress(m_config.meterValuesStressPeriod(),
+                                          m_config.meterValuesStressMeasurands(),
+                                          m_config.ocppConfig().numberOfConnectors(),
+                                          m_config.meterValuesPrecision());
+
     // MQTT connectivity
     std::cout << "Starting MQTT connectivity..." << std::endl;
-    MqttManager mqtt(m_config);
+    MqttManager mqtt(m_config, meter_engine, meter_values_stress);
     std::thread mqtt_thread([&mqtt, this]
                             { mqtt.start(m_nb_phases, static_cast<unsigned int>(m_max_charge_point_setpoint), m_charge_point_type); });
 
     // Allocated data for each connector
-    ocpp::helpers::TimerPool     meters_timer_pool;
     std::vector<MeterSimulator*> meters(m_config.ocppConfig().numberOfConnectors());
     std::vector<ConnectorData>   connectors(meters.size());
     std::vector<float>           voltages(m_nb_phases);
@@ -81,13 +130,22 @@ void SimulatedChargePoint::start()
     for (unsigned int i = 0; i < connectors.size(); i++)
     {
         connectors[i].id           = i + 1u;
-        connectors[i].meter        = new MeterSimulator(meters_timer_pool, m_nb_phases, m_charge_point_type);
+        connectors[i].meter        = new MeterSimulator(meter_engine, m_nb_phases, m_charge_point_type);
         connectors[i].max_setpoint = m_max_connector_setpoint;
         meters[i]                  = connectors[i].meter;
         meters[i]->setVoltages(voltages);
         meters[i]->setPowerFactor(power_factor);
         meters[i]->start();
     }
+    meter_engine.start();
+
+    // Simulated vehicles, kept across the resets like the meters
+    EvProfileLibrary ev_profiles;
+    if (!m_config.evProfileLibrary().empty())
+    {
+        ev_profiles.open(m_config.evProfileLibrary());
+    }
+    EvModel ev_model(connectors.size(), ev_profiles);
 
     ChargePointEventsHandler event_handler(m_config);
     do
@@ -102,10 +160,11 @@ void SimulatedChargePoint::start()
         // Start OCPP
         event_handler.clearResetPending();
         charge_point->start();
+        meter_values_stress.start(*charge_point, connectors);
 
         // Control loop
         std::cout << "Start loop OCPP" << std::endl;
-        loop(mqtt, *charge_point.get(), event_handler, connectors);
+        loop(mqtt, *charge_point.get(), event_handler, ev_model, connectors);
         if (event_handler.isResetPending())
         {
             std::this_thread::sleep_for(std::chrono::seconds(1));
@@ -113,9 +172,11 @@ void SimulatedChargePoint::start()
 
         // Stop OCPP
         std::cout << "Stop CP" << std::endl;
+        meter_values_stress.stop();
         charge_point->stop();
     } while (event_handler.isResetPending());
 
+    meter_engine.stop();
     for (MeterSimulator*& meter : meters)
     {
         meter->stop();
@@ -131,6 +192,7 @@ void SimulatedChargePoint::start()
 void SimulatedChargePoint::loop(MqttManager&                     mqtt,
                                 ocpp::chargepoint::IChargePoint& charge_point,
                                 ChargePointEventsHandler&        event_handler,
+                                EvModel&                         ev_model,
                                 std::vector<ConnectorData>&      connectors)
 {
     bool               status_published = false;
@@ -212,7 +274,7 @@ void SimulatedChargePoint::loop(MqttManager&                     mqtt,
                         // Clear any id tag
                         connector.id_tag        = "";
                         connector.parent_id_tag = "";
-                        mqtt.resetIdTagPending(connector.id);
+                        mqtt.clearIdTags(connector.id);
                     }
                     break;
 
@@ -241,6 +303,9 @@ void SimulatedChargePoint::loop(MqttManager&                     mqtt,
         // Update connector data with MQTT commands
         mqtt.updateData(connectors);
 
+        // Simulated vehicles
+        ev_model.update(connectors);
+
         // Compute next connector statuses
         for (auto& connector : connectors)
         {
@@ -510,16 +575,14 @@ bool SimulatedChargePoint::isValidIdTagPresent(MqttManager&
     bool ret = false;
 
     // Check local id tag
-    if (mqtt.isIdTagPending(connector.id))
+    if (mqtt.popIdTag(connector.id, connector.id_tag))
     {
         AuthorizationStatus auth_status;
-        connector.id_tag = mqtt.pendingIdTag(connector.id);
-        auth_status      = charge_point.authorize(connector.id, connector.id_tag, connector.parent_id_tag);
+        auth_status = charge_point.authorize(connector.id, connector.id_tag, connector.parent_id_tag);
         if ((auth_status == AuthorizationStatus::Accepted) || (auth_status == AuthorizationStatus::ConcurrentTx))
         {
             ret = true;
         }
-        mqtt.resetIdTagPending(connector.id);
     }
     // Check remote id tag
     else if (!local_only && event_handler.isRemoteStartPending(connector.id))
@@ -554,14 +617,13 @@ bool SimulatedChargePoint::isTransactionStopCondition(MqttManager&
     bool ret = true;
 
     // Check local id tag
-    if (mqtt.isIdTagPending(connector.id))
+    std::string id_tag;
+    if (mqtt.popIdTag(connector.id, id_tag))
     {
         AuthorizationStatus auth_status;
         std::string         parent_id_tag;
-        std::string         id_tag = mqtt.pendingIdTag(connector.id);
-        auth_status                = charge_point.authorize(connector.id, id_tag, parent_id_tag);
-        ret                        = (auth_status == AuthorizationStatus::Accepted);
-        mqtt.resetIdTagPending(connector.id);
+        auth_status = charge_point.authorize(connector.id, id_tag, parent_id_tag);
+        ret         = (auth_status == AuthorizationStatus::Accepted);
         if (ret)
         {
             charge_point.stopTransaction(connector.id, id_tag, Reason::Local);
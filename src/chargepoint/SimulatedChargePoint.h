@@ -33,6 +33,7 @@ SOFTWARE.
 class SimulatedChargePointConfig;
 class MqttManager;
 class ChargePointEventsHandler;
+class EvModel;
 
 /** @brief Simulated Charge Point */
 class SimulatedChargePoint
@@ -75,6 +76,7 @@ class SimulatedChargePoint
     void loop(MqttManager&                     mqtt,
               ocpp::chargepoint::IChargePoint& charge_point,
               ChargePointEventsHandler&        event_handler,
+              EvModel&                         ev_model,
               std::vector<ConnectorData>&      connectors);
 
     /** @brief Check if a valid id tag has been presented (locally or remotely) */
@@ -0,0 +1,80 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef GRIDCONFIG_H
+#define GRIDCONFIG_H
+
+#include <openocpp/IniFile.h>
+
+#include <chrono>
+
+/** @brief Section name for the parameters */
+static const std::string GRID_PARAMS = "Grid";
+
+/** @brief Configuration of the grid disturbances simulated for the meters of the Charge Point */
+class GridConfig
+{
+  public:
+    /** @brief Constructor */
+    GridConfig(ocpp::helpers::IniFile& config) : m_config(config) { }
+
+    /** @brief Seed of the random disturbances (0 = derived from the Charge Point identifier) */
+    unsigned int seed() const { return m_config.get(GRID_PARAMS, "Seed", 0u).toUInt(); }
+
+    /** @brief Standard deviation of the slow drift of the voltages in % of the nominal voltage */
+    float voltageDrift() const { return getFloat("VoltageDrift"); }
+
+    /** @brief Standard deviation of the imbalance between the phases in % of the nominal voltage */
+    float voltageImbalance() const { return getFloat("VoltageImbalance"); }
+
+    /** @brief Amplitude of the noise on the measured voltages in % of the nominal voltage */
+    float voltageNoise() const { return getFloat("VoltageNoise"); }
+
+    /** @brief Average number of voltage sags per hour */
+    float sagsPerHour() const { return getFloat("SagsPerHour"); }
+
+    /** @brief Maximum depth of the voltage sags in % of the nominal voltage */
+    float sagDepth() const { return getFloat("SagDepth"); }
+
+    /** @brief Average duration of the voltage sags */
+    std::chrono::milliseconds sagDuration() const
+    {
+        return std::chrono::milliseconds(m_config.get(GRID_PARAMS, "SagDuration", 500u).toUInt());
+    }
+
+    /** @brief Nominal frequency in Hz */
+    float frequency() const { return static_cast<float>(m_config.get(GRID_PARAMS, "Frequency", 50.).toFloat()); }
+
+    /** @brief Standard deviation of the frequency in Hz */
+    float frequencyDeviation() const { return getFloat("FrequencyDeviation"); }
+
+  private:
+    /** @brief Configuration file */
+    ocpp::helpers::IniFile& m_config;
+
+    /** @brief Get a floating point parameter (0 if not set) */
+    float getFloat(const std::string& param) const { return static_cast<float>(m_config.get(GRID_PARAMS, param, 0.).toFloat()); }
+};
+
+#endif // GRIDCONFIG_H
@@ -26,6 +26,7 @@ SOFTWARE.
 #define SIMULATEDCHARGEPOINTCONFIG_H
 
 #include "ChargePointConfig.h"
+#include "GridConfig.h"
 #include "MqttConfig.h"
 #include "OcppConfig.h"
 
@@ -43,7 +44,8 @@ class SimulatedChargePointConfig
           m_diag_files(diag_files),
           m_stack_config(m_config),
           m_ocpp_config(m_config),
-          m_mqtt_config(m_config)
+          m_mqtt_config(m_config),
+          m_grid_config(m_config)
     {
     }
 
@@ -62,17 +64,38 @@ class SimulatedChargePointConfig
     /** @brief MQTT configuration */
     MqttConfig& mqttConfig() { return m_mqtt_config; }
 
+    /** @brief Grid disturbances configuration */
+    const GridConfig& gridConfig() const { return m_grid_config; }
+
     /** @brief Set the value of a stack internal configuration key */
-    void setStackConfigValue(const std::string& key, const std::string& value) { m_stack_config.setConfigValue(key, value); }
+    void setStackConfigValue(const std::string& key, const std::string& value) { m_ocpp_config.setValue(STACK_PARAMS, key, value); }
 
     /** @brief Set the value of an OCPP configuration key */
     void setOcppConfigValue(const std::string& key, const std::string& value) { m_ocpp_config.setConfigValue(key, value); }
 
+    /** @brief Register the listener of the OCPP configuration changes (nullptr to unregister) */
+    void registerOcppConfigListener(OcppConfig::IListener* listener) { m_ocpp_config.registerListener(listener); }
+
     /** @brief Set the value of a MQTT configuration key */
     void setMqttConfigValue(const std::string& key, const std::string& value) { m_mqtt_config.setConfigValue(key, value); }
 
     float powerFactor() {return  m_stack_config.powerFactor();} 
 
+    /** @brief Period of the meters update */
+    std::chrono::milliseconds meterUpdatePeriod() const { return m_stack_config.meterUpdatePeriod(); }
+
+    /** @brief Path of the EV profile library file (empty = built-in profiles) */
+    std::string evProfileLibrary() const { return m_stack_config.evProfileLibrary(); }
+
+    /** @brief Number of decimals of the meter values */
+    unsigned int meterValuesPrecision() const { return m_stack_config.meterValuesPrecision(); }
+
+    /** @brief Period of the MeterValues stress messages (0 = disabled) */
+    std::chrono::milliseconds meterValuesStressPeriod() const { return m_stack_config.meterValuesStressPeriod(); }
+
+    /** @brief Comma separated list of the measurands of the MeterValues stress messages (empty = all the supported measurands) */
+    std::string meterValuesStressMeasurands() const { return m_stack_config.meterValuesStressMeasurands(); }
+
   private:
     /** @brief Working directory */
     std::string m_working_dir;
@@ -87,6 +110,8 @@ class SimulatedChargePointConfig
     OcppConfig m_ocpp_config;
     /** @brief MQTT configuration */
     MqttConfig m_mqtt_config;
+    /** @brief Grid disturbances configuration */
+    GridConfig m_grid_config;
 };
 
 #endif // SIMULATEDCHARGEPOINTCONFIG_H
@@ -23,7 +23,6 @@ SOFTWARE.
 */
 
 #include "ChargePointEventsHandler.h"
-#include "IMqttClient.h"
 #include "SimulatedChargePoint.h"
 #include "SimulatedChargePointConfig.h"
 
@@ -37,30 +36,6 @@ SOFTWARE.
 
 using namespace std;
 
-IMqttClient* client = nullptr;
-
-class Listener : public IMqttClient::IListener
-{
-  public:
-    /** @copydoc void IMqttClient::IListener::mqttConnectionLost() */
-    void mqttConnectionLost() override
-    {
-        cout << "Communication lost!" << endl;
-        client->close();
-        if (client->connect("tcp://localhost:1883"))
-        {
-            cout << "Connected!" << endl;
-        }
-    }
-
-    /** @copydoc void IMqttClient::IListener::mqttMessageReceived(const char*, const std::string&, IMqttClient::QoS, bool) */
-    void mqttMessageReceived(const char* topic, const std::string& message, IMqttClient::QoS qos, bool retained) override
-    {
-        cout << "Rx message : [" << topic << "] - QoS" << static_cast<int>(qos) << " - " << (retained ? "" : "not ") << "retained - "
-             << message << endl;
-    }
-};
-
 /** @brief Entry point */
 int main(int argc, char* argv[])
 {
@@ -78,6 +53,7 @@ int main(int argc, char* argv[])
     std::string           chargepoint_type          = "AC";
     std::string           vendor_name               = "";
     unsigned int          operating_voltage         = 0u;
+    std::string           local_control_socket      = "";
 
     // Check parameters
     if (argc > 1)
@@ -183,6 +159,12 @@ int main(int argc, char* argv[])
                 argc--;
                 operating_voltage = static_cast<unsigned int>(std::atoi(*argv));
             }
+            else if ((strcmp(*argv, "-l") == 0) && (argc > 1))
+            {
+                argv++;
+                argc--;
+                local_control_socket = *argv;
+            }
             else
             {
                 param     = *argv;
@@ -216,6 +198,7 @@ int main(int argc, char* argv[])
             std::cout << "    -e : Charge Point's type (AC/DC) (Default = AC)" << std::endl;
             std::cout << "    -v : Vendor name (Default = OpenOCPP)" << std::endl;
             std::cout << "    -o : Operating voltage (Default = 230)" << std::endl;
+            std::cout << "    -l : Path of the Unix socket of the local control interface (Default = disabled)" << std::endl;
             std::cout << "    -f : Files to put in diagnostic zip. Absolute path or relative path from working directory. " << std::endl;
             std::cout << "         (Default = ocpp.db)" << std::endl;
             return 1;
@@ -271,6 +254,10 @@ int main(int argc, char* argv[])
     config.setOcppConfigValue("ConnectorPhaseRotation", connector_phase_rotation.str());
 
     config.setMqttConfigValue("BrokerUrl", mqtt_broker_url);
+    if (!local_control_socket.empty())
+    {
+        config.setMqttConfigValue("LocalControlSocket", local_control_socket);
+    }
 
     if (!vendor_name.empty())
     {
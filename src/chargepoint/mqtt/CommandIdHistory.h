@@ -0,0 +1,81 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef COMMANDIDHISTORY_H
+#define COMMANDIDHISTORY_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/** @brief History of the latest command ids, used to ignore the commands redelivered by the broker */
+class CommandIdHistory
+{
+  public:
+    /** @brief Number of command ids kept in the history */
+    static constexpr size_t SIZE = 64u;
+
+    /** @brief Constructor */
+    CommandIdHistory() : m_ids(), m_next(0), m_duplicates(0) { }
+
+    /**
+     * @brief Record a command id
+     * @param id Command id
+     * @return true if the id is new, false if the command is a duplicate
+     */
+    bool add(std::string_view id)
+    {
+        bool ret = true;
+        for (size_t i = 0; ret && (i < SIZE); i++)
+        {
+            ret = (m_ids[i] != id);
+        }
+        if (ret)
+        {
+            // Replace the oldest id
+            m_ids[m_next].assign(id.data(), id.size());
+            m_next = (m_next + 1u) % SIZE;
+        }
+        else
+        {
+            m_duplicates++;
+        }
+        return ret;
+    }
+
+    /** @brief Number of duplicate commands */
+    uint64_t duplicates() const { return m_duplicates; }
+
+  private:
+    /** @brief Latest command ids */
+    std::array<std::string, SIZE> m_ids;
+    /** @brief Index of the next id to replace */
+    size_t m_next;
+    /** @brief Number of duplicate commands */
+    uint64_t m_duplicates;
+};
+
+#endif // COMMANDIDHISTORY_H
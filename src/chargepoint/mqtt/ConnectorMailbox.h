@@ -0,0 +1,134 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef CONNECTORMAILBOX_H
+#define CONNECTORMAILBOX_H
+
+#include "SeqLock.h"
+#include "SpscRing.h"
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+/** @brief Inputs of a connector received through MQTT or the local control interface */
+struct ConnectorInputs
+{
+    /** @brief Default constructor */
+    ConnectorInputs()
+        : car_consumption_l1(0.f),
+          car_consumption_l2(0.f),
+          car_consumption_l3(0.f),
+          car_cable_capacity(0.f),
+          car_ready(true),
+          ev_profile(0),
+          ev_session(0),
+          car_version(0),
+          fault_pending(false)
+    {
+    }
+
+    /** @brief Car consumption */
+    float car_consumption_l1;
+    float car_consumption_l2;
+    float car_consumption_l3;
+    /** @brief Car cable capacity */
+    float car_cable_capacity;
+    /** @brief Indicate that the car is ready to charge */
+    bool car_ready;
+    /** @brief Profile of the simulated vehicle (0 = car inputs set by the car commands) */
+    uint32_t ev_profile;
+    /** @brief Incremented each time a vehicle profile is selected */
+    uint32_t ev_session;
+    /**
+     * @brief Incremented each time the car inputs are written, the car inputs are only applied when they have
+     *        been written so that the other inputs do not restore the inputs of a vehicle which has left
+     */
+    uint32_t car_version;
+    /** @brief Indicate that a fault occured */
+    bool fault_pending;
+};
+
+/** @brief Reply to a command, published once the command has been applied by the control loop */
+struct CommandReply
+{
+    /** @brief Default constructor */
+    CommandReply() : cmd_id(), reply_to(), type(""), received() { }
+
+    /** @brief Correlation id of the command (no reply if empty) */
+    std::string cmd_id;
+    /** @brief Topic of the reply */
+    std::string reply_to;
+    /** @brief Type of the command */
+    const char* type;
+    /** @brief Reception time of the command */
+    std::chrono::steady_clock::time_point received;
+};
+
+/** @brief Id tag presented on a connector */
+struct PendingIdTag
+{
+    /** @brief Id tag */
+    std::string id_tag;
+    /** @brief Reply to the command */
+    CommandReply reply;
+};
+
+/** @brief Mailbox between the MQTT callbacks and the local control interface (producers serialized by the MqttManager)
+ *         and the control loop (single consumer) of a connector */
+struct alignas(64) ConnectorMailbox
+{
+    /** @brief Maximum number of pending id tags */
+    static constexpr size_t MAX_PENDING_ID_TAGS = 4u;
+    /** @brief Maximum number of pending replies to input commands */
+    static constexpr size_t MAX_PENDING_REPLIES = 8u;
+
+    /** @brief Default constructor */
+    ConnectorMailbox()
+        : inputs(),
+          id_tags(),
+          replies(),
+          written_inputs(),
+          read_version(std::numeric_limits<uint64_t>::max()),
+          read_car_version(std::numeric_limits<uint32_t>::max())
+    {
+    }
+
+    /** @brief Latest inputs */
+    SeqLock<ConnectorInputs> inputs;
+    /** @brief Pending id tags */
+    SpscRing<PendingIdTag, MAX_PENDING_ID_TAGS> id_tags;
+    /** @brief Replies to the commands which modified the inputs, pushed after the inputs have been stored */
+    SpscRing<CommandReply, MAX_PENDING_REPLIES> replies;
+
+    /** @brief Inputs being built by the producer (producer side only) */
+    ConnectorInputs written_inputs;
+    /** @brief Version of the last inputs loaded by the consumer (consumer side only) */
+    uint64_t read_version;
+    /** @brief Version of the last car inputs applied by the consumer (consumer side only) */
+    uint32_t read_car_version;
+};
+
+#endif // CONNECTORMAILBOX_H
@@ -0,0 +1,173 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "LocalControl.h"
+
+#include <iostream>
+#include <vector>
+
+#ifndef _MSC_VER
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif // _MSC_VER
+
+/** @brief Period in ms at which the reception thread checks for its end */
+static constexpr int POLL_PERIOD_MS = 250;
+/** @brief Maximum size of a datagram */
+static constexpr size_t MAX_DATAGRAM_SIZE = LocalControl::MAX_RECORDS * sizeof(LocalControl::Record);
+
+/** @brief Constructor */
+LocalControl::LocalControl(IListener& listener)
+    : m_listener(listener),
+      m_socket_path(),
+      m_socket(-1),
+      m_stop(false),
+      m_datagrams(0),
+      m_records(0),
+      m_invalid(0),
+      m_oversized(0),
+      m_thread()
+{
+}
+
+/** @brief Destructor */
+LocalControl::~LocalControl()
+{
+    stop();
+}
+
+/** @brief Start listening on a Unix datagram socket */
+bool LocalControl::start(const std::string& socket_path)
+{
+    bool ret = false;
+
+#ifndef _MSC_VER
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if ((m_socket < 0) && (socket_path.size() < sizeof(address.sun_path)))
+    {
+        socket_path.copy(address.sun_path, socket_path.size());
+        unlink(socket_path.c_str());
+        m_socket = socket(AF_UNIX, SOCK_DGRAM, 0);
+        if ((m_socket >= 0) && (bind(m_socket, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) == 0))
+        {
+            m_socket_path = socket_path;
+            m_stop        = false;
+            m_thread      = std::thread(&LocalControl::receptionThread, this);
+            ret           = true;
+            std::cout << "Local control listening on " << m_socket_path << std::endl;
+        }
+        else
+        {
+            std::cout << "Unable to listen on " << socket_path << " : " << strerror(errno) << std::endl;
+            if (m_socket >= 0)
+            {
+                close(m_socket);
+                m_socket = -1;
+            }
+        }
+    }
+#else // _MSC_VER
+    (void)socket_path;
+    std::cout << "Local control is not supported on this platform" << std::endl;
+#endif // _MSC_VER
+
+    return ret;
+}
+
+/** @brief Stop listening */
+void LocalControl::stop()
+{
+#ifndef _MSC_VER
+    if (m_thread.joinable())
+    {
+        m_stop = true;
+        m_thread.join();
+    }
+    if (m_socket >= 0)
+    {
+        close(m_socket);
+        unlink(m_socket_path.c_str());
+        m_socket = -1;
+    }
+#endif // _MSC_VER
+}
+
+/** @brief Get the statistics */
+LocalControl::Stats LocalControl::stats() const
+{
+    Stats stats;
+    stats.datagrams = m_datagrams;
+    stats.records   = m_records;
+    stats.invalid   = m_invalid;
+    stats.oversized = m_oversized;
+    return stats;
+}
+
+/** @brief Reception thread */
+void LocalControl::receptionThread()
+{
+#ifndef _MSC_VER
+    // Records are decoded in place, the buffer is aligned for them
+    std::vector<Record> buffer(MAX_DATAGRAM_SIZE / sizeof(Record));
+    struct pollfd       fd = {m_socket, POLLIN, 0};
+    while (!m_stop)
+    {
+        if (poll(&fd, 1u, POLL_PERIOD_MS) > 0)
+        {
+            // Drain the socket before waiting again
+            ssize_t size = 0;
+            do
+            {
+                // MSG_TRUNC returns the real size of the datagram so that a truncated datagram is detected
+                // and rejected as a whole instead of applying only its first records
+                size = recv(m_socket, buffer.data(), MAX_DATAGRAM_SIZE, MSG_DONTWAIT | MSG_TRUNC);
+                if (size > 0)
+                {
+                    m_datagrams++;
+                    if (static_cast<size_t>(size) > MAX_DATAGRAM_SIZE)
+                    {
+                        m_oversized++;
+                    }
+                    else if ((static_cast<size_t>(size) % sizeof(Record)) == 0)
+                    {
+                        size_t count = static_cast<size_t>(size) / sizeof(Record);
+                        m_records += count;
+                        m_invalid += m_listener.localRecordsReceived(buffer.data(), count);
+                    }
+                    else
+                    {
+                        m_invalid++;
+                    }
+                }
+            } while ((size > 0) && !m_stop);
+        }
+    }
+#endif // _MSC_VER
+}
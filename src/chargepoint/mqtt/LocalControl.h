@@ -0,0 +1,160 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef LOCALCONTROL_H
+#define LOCALCONTROL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+/** @brief Local control interface receiving fixed size binary input records on a Unix datagram socket,
+ *         an alternative to the MQTT commands for the drivers running on the same host */
+class LocalControl
+{
+  public:
+    /** @brief Record types */
+    enum class RecordType : uint8_t
+    {
+        /** @brief Car inputs : cable capacity, ready state and consumptions (only the fields in the mask are updated) */
+        CAR = 1u,
+        /** @brief Id tag presented on the connector */
+        ID_TAG,
+        /** @brief Faulted state */
+        FAULTED
+    };
+
+    /** @brief Mask of the cable capacity field (CAR) */
+    static constexpr uint8_t MASK_CABLE = 0x01u;
+    /** @brief Mask of the ready flag (CAR) */
+    static constexpr uint8_t MASK_READY = 0x02u;
+    /** @brief Mask of the consumption fields, shifted by the phase index (CAR) */
+    static constexpr uint8_t MASK_CONSUMPTION_L1 = 0x04u;
+
+    /** @brief Car ready flag (CAR) */
+    static constexpr uint8_t FLAG_READY = 0x01u;
+    /** @brief Faulted flag (FAULTED) */
+    static constexpr uint8_t FLAG_FAULTED = 0x02u;
+
+    /** @brief Size of the id tag field, including the terminating null character */
+    static constexpr size_t ID_TAG_SIZE = 28u;
+
+    /** @brief Maximum number of records in a datagram, larger datagrams are rejected */
+    static constexpr size_t MAX_RECORDS = 1024u;
+
+    /** @brief Input record in host byte order, a datagram contains one or more records */
+    struct Record
+    {
+        /** @brief Type (see RecordType) */
+        uint8_t type;
+        /** @brief Connector id */
+        uint8_t connector_id;
+        /** @brief Flags */
+        uint8_t flags;
+        /** @brief Valid fields (CAR) */
+        uint8_t mask;
+        /** @brief Cable capacity (CAR) */
+        float cable;
+        /** @brief Consumptions per phase (CAR) */
+        float consumptions[3u];
+        /** @brief Id tag, null terminated if shorter than the field (ID_TAG) */
+        char id_tag[ID_TAG_SIZE];
+    };
+    static_assert(sizeof(Record) == 48u, "Unexpected local control record size");
+
+    /** @brief Interface to process the received records */
+    class IListener
+    {
+      public:
+        /** @brief Destructor */
+        virtual ~IListener() { }
+
+        /**
+         * @brief Called when records have been received (from the local control thread)
+         * @param records Received records
+         * @param count Number of records
+         * @return Number of invalid records
+         */
+        virtual size_t localRecordsReceived(const Record* records, size_t count) = 0;
+    };
+
+    /** @brief Statistics */
+    struct Stats
+    {
+        /** @brief Number of received datagrams */
+        uint64_t datagrams;
+        /** @brief Number of received records */
+        uint64_t records;
+        /** @brief Number of invalid records or datagrams */
+        uint64_t invalid;
+        /** @brief Number of rejected datagrams larger than MAX_RECORDS records */
+        uint64_t oversized;
+    };
+
+    /** @brief Constructor */
+    LocalControl(IListener& listener);
+
+    /** @brief Destructor */
+    virtual ~LocalControl();
+
+    /**
+     * @brief Start listening on a Unix datagram socket
+     * @param socket_path Path of the socket
+     * @return true if the socket is listening, false otherwise
+     */
+    bool start(const std::string& socket_path);
+
+    /** @brief Stop listening */
+    void stop();
+
+    /** @brief Get the statistics */
+    Stats stats() const;
+
+  private:
+    /** @brief Listener */
+    IListener& m_listener;
+    /** @brief Path of the socket */
+    std::string m_socket_path;
+    /** @brief Socket */
+    int m_socket;
+    /** @brief Indicate that the reception thread must stop */
+    std::atomic<bool> m_stop;
+    /** @brief Number of received datagrams */
+    std::atomic<uint64_t> m_datagrams;
+    /** @brief Number of received records */
+    std::atomic<uint64_t> m_records;
+    /** @brief Number of invalid records or datagrams */
+    std::atomic<uint64_t> m_invalid;
+    /** @brief Number of rejected datagrams larger than MAX_RECORDS records */
+    std::atomic<uint64_t> m_oversized;
+    /** @brief Reception thread */
+    std::thread m_thread;
+
+    /** @brief Reception thread */
+    void receptionThread();
+};
+
+#endif // LOCALCONTROL_H
@@ -27,6 +27,8 @@ SOFTWARE.
 
 #include <openocpp/IniFile.h>
 
+#include <chrono>
+
 /** @brief Section name for the parameters */
 static const std::string MQTT_PARAMS = "Mqtt";
 
@@ -45,6 +47,66 @@ class MqttConfig
     /** @brief Broker URL */
     std::string brokerUrl() const { return getString("BrokerUrl"); };
 
+    /** @brief Maximum number of messages waiting to be published */
+    unsigned int publishQueueSize() const { return m_config.get(MQTT_PARAMS, "PublishQueueSize", 256u).toUInt(); };
+
+    /**
+     * @brief Clean the session on connection, otherwise the broker keeps the commands sent while disconnected
+     *        (only with MQTT 5 and a session expiry, or through the MQTT gateway)
+     */
+    bool cleanSession() const { return getBool("CleanSession"); };
+
+    /** @brief QoS of the command subscriptions */
+    unsigned int commandQos() const { return m_config.get(MQTT_PARAMS, "CommandQos", 1u).toUInt(); };
+
+    /** @brief Maximum number of QoS 1 and 2 messages in flight (0 = MQTT library default) */
+    unsigned int maxInflight() const { return m_config.get(MQTT_PARAMS, "MaxInflight", 20u).toUInt(); };
+
+    /** @brief Expiry interval of the persistent session after disconnection (MQTT 5 only) */
+    std::chrono::seconds sessionExpiry() const
+    {
+        return std::chrono::seconds(m_config.get(MQTT_PARAMS, "SessionExpiry", 3600u).toUInt());
+    };
+
+    /** @brief Maximum number of status messages published per second (0 = unlimited) */
+    unsigned int statusPublishRate() const { return m_config.get(MQTT_PARAMS, "StatusPublishRate", 5u).toUInt(); };
+
+    /** @brief Maximum number of connector data messages published per second (0 = unlimited) */
+    unsigned int dataPublishRate() const { return m_config.get(MQTT_PARAMS, "DataPublishRate", 20u).toUInt(); };
+
+    /** @brief Maximum number of configuration messages published per second (0 = unlimited) */
+    unsigned int configPublishRate() const { return m_config.get(MQTT_PARAMS, "ConfigPublishRate", 1u).toUInt(); };
+
+    /** @brief Maximum number of messages published per second by all the charge points of the host (0 = unlimited) */
+    unsigned int hostPublishRate() const { return m_config.get(MQTT_PARAMS, "HostPublishRate", 0u).toUInt(); };
+
+    /** @brief Upper bound of the delay before the first reconnection attempt, doubled after each failed attempt */
+    std::chrono::milliseconds reconnectBaseDelay() const
+    {
+        return std::chrono::milliseconds(m_config.get(MQTT_PARAMS, "ReconnectBaseDelay", 500u).toUInt());
+    };
+
+    /** @brief Maximum delay between 2 reconnection attempts */
+    std::chrono::milliseconds reconnectMaxDelay() const
+    {
+        return std::chrono::milliseconds(m_config.get(MQTT_PARAMS, "ReconnectMaxDelay", 30000u).toUInt());
+    };
+
+    /** @brief Maximum number of reconnection attempts per second for all the charge points of the host (0 = unlimited) */
+    unsigned int hostReconnectRate() const { return m_config.get(MQTT_PARAMS, "HostReconnectRate", 50u).toUInt(); };
+
+    /** @brief Use MQTT 5 instead of MQTT 3.1.1 */
+    bool mqtt5() const { return getBool("Mqtt5"); };
+
+    /** @brief Maximum number of topic aliases (MQTT 5 only, 0 = disabled) */
+    unsigned int topicAliasMaximum() const { return m_config.get(MQTT_PARAMS, "TopicAliasMaximum", 16u).toUInt(); };
+
+    /** @brief Expiry interval in seconds of the retained messages (MQTT 5 only, 0 = never expire) */
+    std::chrono::seconds retainedMessageExpiry() const { return get<std::chrono::seconds>("RetainedMessageExpiry"); };
+
+    /** @brief Path of the Unix socket of the local control interface (disabled if empty) */
+    std::string localControlSocket() const { return getString("LocalControlSocket"); };
+
   private:
     /** @brief Configuration file */
     ocpp::helpers::IniFile& m_config;
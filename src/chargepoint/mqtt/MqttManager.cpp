@@ -23,16 +23,18 @@ SOFTWARE.
 */
 
 #include "MqttManager.h"
+#include "MeterEngine.h"
 #include "MeterSimulator.h"
+#include "MeterValuesStress.h"
 #include "SimulatedChargePointConfig.h"
 #include "Topics.h"
 
+#include <algorithm>
+#include <array>
 #include <cstring>
-#include <filesystem>
 #include <iostream>
 #include <openocpp/json.h>
 #include <sstream>
-#include <thread>
 
 #ifdef _MSC_VER
 #include <Windows.h>
@@ -40,161 +42,124 @@ SOFTWARE.
 #include <unistd.h>
 #endif // _MSC_VER
 
+/** @brief Decode a JSON payload */
+static bool parsePayload(std::string_view message, rapidjson::Document& payload)
+{
+    bool valid = false;
+    try
+    {
+        payload.Parse(message.data(), message.size());
+        valid = !payload.HasParseError();
+    }
+    catch (...)
+    {
+    }
+    if (!valid)
+    {
+        std::cout << "Invalid message : " << message << std::endl;
+    }
+    return valid;
+}
+
 /** @brief Constructor */
-MqttManager::MqttManager(SimulatedChargePointConfig& config)
+MqttManager::MqttManager(SimulatedChargePointConfig& config, const MeterEngine& meter_engine, const MeterValuesStress& meter_values_stress)
     : m_config(config),
-      m_mutex(),
+      m_meter_engine(meter_engine),
+      m_meter_values_stress(meter_values_stress),
       m_end(false),
-      m_connectors(config.ocppConfig().numberOfConnectors()),
+      m_mailboxes(config.ocppConfig().numberOfConnectors()),
+      m_inputs_mutex(),
+      m_local_touched(m_mailboxes.size(), false),
       m_mqtt(nullptr),
+      m_router(),
+      m_queue(config.mqttConfig().publishQueueSize()),
+      m_reconnect(
+          config.mqttConfig().reconnectBaseDelay(), config.mqttConfig().reconnectMaxDelay(), config.mqttConfig().hostReconnectRate()),
       m_status_topic(),
-      m_connectors_topic()
+      m_ocpp_config_topic(),
+      m_ocpp_config_delta_topic(CHARGE_POINTS_TOPIC + config.stackConfig().chargePointIdentifier() + "/ocpp_config/delta"),
+      m_ocpp_config_mutex(),
+      m_ocpp_config_changes(),
+      m_connectors_topic(),
+      m_stats_topic(),
+      m_reply_topic(),
+      m_command_ids(),
+      m_local_control(*this)
 {
+    // Publish rate limits, bursts of up to 1s worth of messages
+    const MqttConfig& mqtt_config = config.mqttConfig();
+    m_queue.setRateLimit(MqttPublishQueue::PublishClass::STATUS, mqtt_config.statusPublishRate(), mqtt_config.statusPublishRate());
+    m_queue.setRateLimit(MqttPublishQueue::PublishClass::DATA, mqtt_config.dataPublishRate(), mqtt_config.dataPublishRate());
+    m_queue.setRateLimit(MqttPublishQueue::PublishClass::CONFIG, mqtt_config.configPublishRate(), mqtt_config.configPublishRate());
+    m_queue.setHostRateLimit(mqtt_config.hostPublishRate(), mqtt_config.hostPublishRate());
+
+    // Configuration changes
+    m_config.registerOcppConfigListener(this);
+
+    // Optional local control interface
+    std::string local_control_socket = mqtt_config.localControlSocket();
+    if (!local_control_socket.empty())
+    {
+        m_local_control.start(local_control_socket);
+    }
 }
 
 /** @brief Destructor */
-MqttManager::~MqttManager() { }
+MqttManager::~MqttManager()
+{
+    m_local_control.stop();
+    m_config.registerOcppConfigListener(nullptr);
+}
 
 /** @copydoc void IMqttClient::IListener::mqttConnectionLost() */
-void MqttManager::mqttConnectionLost() { }
+void MqttManager::mqttConnectionLost()
+{
+    // Wake up the connection loop
+    m_reconnect.connectionLost();
+    m_queue.wakeUp();
+}
 
 /** @copydoc void IMqttClient::IListener::mqttMessageReceived(const char*, const std::string&, IMqttClient::QoS, bool) */
 void MqttManager::mqttMessageReceived(const char* topic, const std::string& message, IMqttClient::QoS qos, bool retained)
+{
+    mqttMessageViewReceived(topic, message, qos, retained);
+}
+
+/** @copydoc void IMqttClient::IListener::mqttMessageViewReceived(const char*, std::string_view, IMqttClient::QoS, bool) */
+void MqttManager::mqttMessageViewReceived(const char* topic, std::string_view message, IMqttClient::QoS qos, bool retained)
 {
     (void)qos;
     (void)retained;
 
-    std::cout << "MQTT message received!" << std::endl;
-
-    // Decode message
-    bool                valid = false;
-    rapidjson::Document payload;
-    try
-    {
-        payload.Parse(message.c_str(), message.size());
-        valid = !payload.HasParseError();
-    }
-    catch (...)
+    // Route message
+    if (!m_router.dispatch(topic, message))
     {
+        std::cout << "Unexpected topic : " << topic << std::endl;
     }
-    if (!valid)
-    {
-        std::cout << "Invalid message : " << message << std::endl;
-    }
-    else
-    {
-        std::cout << "topic: " << topic << std::endl << "payload: " << message << std::endl;
-        // Split topic name
-        std::filesystem::path topic_path(topic);
+}
 
-        // Check message type
-        if (topic_path.filename().compare("cmd") == 0)
-        {
-            // Command
-            if (payload.HasMember("type"))
-            {
-                const char* type = payload["type"].GetString();
-                if (strcmp(type, "close") == 0)
-                {
-                    std::cout << "Close command received" << std::endl;
-                    m_end = true;
-                }
-                else if (strcmp(type, "ocpp_config") == 0)
-                {
-                    publishOcppConfig();
-                }
-            }
-            else
-            {
-                std::cout << "Unknown command : " << message << std::endl;
-            }
-        }
-        else
-        {
-            // Get connector number
-            auto iter = topic_path.end();
-            iter--;
-            iter--;
-            std::string  connector_str = iter->string();
-            unsigned int connector     = static_cast<unsigned int>(std::atoi(connector_str.c_str()));
-            if ((connector > 0) && (connector <= m_connectors.size()))
-            {
-                // Update connector data
-                ConnectorData&              connector_data = m_connectors[connector - 1u];
-                std::lock_guard<std::mutex> lock(m_mutex);
+/** @copydoc void OcppConfig::IListener::ocppConfigChanged(const std::string&, const std::string&) */
+void MqttManager::ocppConfigChanged(const std::string& key, const std::string& value)
+{
+    std::lock_guard<std::mutex> lock(m_ocpp_config_mutex);
+    m_ocpp_config_changes[key] = value;
 
-                if (topic_path.filename().compare("car") == 0)
-                {
-                    if (payload.HasMember("cable"))
-                    {
-                        rapidjson::Value& cable = payload["cable"];
-                        if (cable.IsFloat())
-                        {
-                            connector_data.car_cable_capacity = cable.GetFloat();
-                        }
-                    }
-                    if (payload.HasMember("ready"))
-                    {
-                        rapidjson::Value& ready = payload["ready"];
-                        if (ready.IsBool())
-                        {
-                            connector_data.car_ready = ready.GetBool();
-                        }
-                    }
-                    if (payload.HasMember("consumption_l1"))
-                    {
-                        rapidjson::Value& consumption_l1 = payload["consumption_l1"];
-                        if (consumption_l1.IsFloat())
-                        {
-                            connector_data.car_consumption_l1 = consumption_l1.GetFloat();
-                        }
-                    }
-                    if (payload.HasMember("consumption_l2"))
-                    {
-                        rapidjson::Value& consumption_l2 = payload["consumption_l2"];
-                        if (consumption_l2.IsFloat())
-                        {
-                            connector_data.car_consumption_l2 = consumption_l2.GetFloat();
-                        }
-                    }
-                    if (payload.HasMember("consumption_l3"))
-                    {
-                        rapidjson::Value& consumption_l3 = payload["consumption_l3"];
-                        if (consumption_l3.IsFloat())
-                        {
-                            connector_data.car_consumption_l3 = consumption_l3.GetFloat();
-                        }
-                    }
-                }
-                else if (topic_path.filename().compare("id_tag") == 0)
-                {
-                    if (payload.HasMember("id"))
-                    {
-                        rapidjson::Value& id = payload["id"];
-                        if (id.IsString())
-                        {
-                            connector_data.id_tag = id.GetString();
-                        }
-                    }
-                }
-                else if (topic_path.filename().compare("faulted") == 0)
-                {
-                    if (payload.HasMember("faulted"))
-                    {
-                        rapidjson::Value& faulted = payload["faulted"];
-                        if (faulted.IsBool())
-                        {
-                            connector_data.fault_pending = faulted.GetBool();
-                        }
-                    }
-                }
-            }
-            else
-            {
-                std::cout << "Invalid connector : " << connector_str << std::endl;
-            }
-        }
+    // The retained delta holds all the changes since the last publication of the whole config,
+    // so that the whole config followed by the delta always gives the current config
+    rapidjson::Document msg;
+    msg.SetObject();
+    for (const auto& change : m_ocpp_config_changes)
+    {
+        msg.AddMember(rapidjson::Value(change.first.c_str(), msg.GetAllocator()).Move(),
+                      rapidjson::Value(change.second.c_str(), msg.GetAllocator()).Move(),
+                      msg.GetAllocator());
     }
+    rapidjson::StringBuffer                    buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    msg.Accept(writer);
+
+    // Queue for publication
+    m_queue.push(m_ocpp_config_delta_topic, buffer.GetString(), IMqttClient::QoS::QOS_0, true, MqttPublishQueue::PublishClass::CONFIG);
 }
 
 /** @brief Start the MQTT connection process (blocking) */
@@ -211,11 +176,35 @@ void MqttManager::start(unsigned int nb_phases, unsigned int max_charge_point_cu
     m_status_topic                         = chargepoint_topic + "status";
     m_ocpp_config_topic                    = chargepoint_topic + "ocpp_config";
     m_connectors_topic                     = chargepoint_topic + "connectors/";
+    m_stats_topic                          = chargepoint_topic + "stats";
+    m_reply_topic                          = chargepoint_topic + "reply";
+
+    // Message routes
+    m_router.addRoute(chargepoint_cmd_topic,
+                      [this](const MqttTopicRouter::Captures&, std::string_view message) { cmdMessageReceived(message); });
+    m_router.addRoute(chargepoint_car_topics,
+                      [this](const MqttTopicRouter::Captures& captures, std::string_view message)
+                      { carMessageReceived(captures.integer(0), message); });
+    m_router.addRoute(chargepoint_tag_topics,
+                      [this](const MqttTopicRouter::Captures& captures, std::string_view message)
+                      { idTagMessageReceived(captures.integer(0), message); });
+    m_router.addRoute(chargepoint_faulted_topics,
+                      [this](const MqttTopicRouter::Captures& captures, std::string_view message)
+                      { faultedMessageReceived(captures.integer(0), message); });
 
     // MQTT client
-    m_mqtt = IMqttClient::create(m_config.stackConfig().chargePointIdentifier());
+    m_mqtt = IMqttClient::create(m_config.stackConfig().chargePointIdentifier(), m_config.mqttConfig().brokerUrl());
     m_mqtt->registerListener(*this);
 
+    // Protocol options
+    IMqttClient::ProtocolOptions protocol_options;
+    protocol_options.mqtt5               = m_config.mqttConfig().mqtt5();
+    protocol_options.topic_alias_maximum = m_config.mqttConfig().topicAliasMaximum();
+    protocol_options.retained_expiry     = m_config.mqttConfig().retainedMessageExpiry();
+    protocol_options.session_expiry      = m_config.mqttConfig().sessionExpiry();
+    protocol_options.max_inflight        = m_config.mqttConfig().maxInflight();
+    m_mqtt->setProtocolOptions(protocol_options);
+
     // Set the will message
     m_mqtt->setWill(m_status_topic,
                     buildStatusMessage("Dead",
@@ -225,56 +214,86 @@ void MqttManager::start(unsigned int nb_phases, unsigned int max_charge_point_cu
                     IMqttClient::QoS::QOS_0,
                     true);
 
-    // Connection loop
-    do
+    // Commands are delivered with the configured QoS, a persistent session keeps them while disconnected.
+    // A persistent session must expire : it is only used with MQTT 5 and a session expiry, or through the
+    // MQTT gateway which discards the sessions of its clients after a while (MQTT 3.1.1 sessions never expire)
+    bool clean_session = m_config.mqttConfig().cleanSession();
+    if (!clean_session && (m_config.mqttConfig().brokerUrl().rfind("unix://", 0) != 0) &&
+        (!m_config.mqttConfig().mqtt5() || (m_config.mqttConfig().sessionExpiry().count() == 0)))
+    {
+        std::cout << "Persistent session requires Mqtt5=true and SessionExpiry > 0, using a clean session" << std::endl;
+        clean_session = true;
+    }
+    IMqttClient::QoS command_qos = static_cast<IMqttClient::QoS>(std::min(m_config.mqttConfig().commandQos(), 2u));
+
+    // Connection loop, the attempts are spread in time by the reconnection policy
+    while (!m_end && m_reconnect.waitNextAttempt())
     {
         // Connection to the broker
+        bool connected = false;
         std::cout << "Connecting to the broker (" << m_config.mqttConfig().brokerUrl() << ")..." << std::endl;
-        if (m_mqtt->connect(m_config.mqttConfig().brokerUrl()))
+        if (m_mqtt->connect(m_config.mqttConfig().brokerUrl(), clean_session))
         {
             std::cout << "Subscribing to charge point's command topic: " << chargepoint_cmd_topic << std::endl;
-            if (m_mqtt->subscribe(chargepoint_cmd_topic))
+            if (m_mqtt->subscribe(chargepoint_cmd_topic, command_qos))
             {
                 std::cout << "Subscribing to charge point's connector topics: " << chargepoint_car_topics << " and "
                           << chargepoint_tag_topics << " and " << chargepoint_faulted_topics << std::endl;
-                if (m_mqtt->subscribe(chargepoint_car_topics) && m_mqtt->subscribe(chargepoint_tag_topics) &&
-                    m_mqtt->subscribe(chargepoint_faulted_topics))
+                if (m_mqtt->subscribe(chargepoint_car_topics, command_qos) && m_mqtt->subscribe(chargepoint_tag_topics, command_qos) &&
+                    m_mqtt->subscribe(chargepoint_faulted_topics, command_qos))
                 {
-                    // Wait for disconnection or end of application
+                    connected = true;
+                    m_reconnect.attemptDone(true);
+
+                    // Publish the whole config, only the changes are published afterwards
+                    publishOcppConfig();
+
+                    // Publish the queued messages until disconnection or end of application,
+                    // messages queued while disconnected are flushed on reconnection
                     std::cout << "Ready!" << std::endl;
-                    while (!m_end && m_mqtt->isConnected())
+                    while (!m_end && !m_reconnect.isConnectionLost())
                     {
-                        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+                        if (m_queue.wait(std::chrono::milliseconds(500)))
+                        {
+                            m_queue.flush(*m_mqtt);
+                        }
                     }
-                    if (!m_mqtt->isConnected())
+                    if (m_reconnect.isConnectionLost())
                     {
-                        std::cout << "Disconnected, next retry in 5s..." << std::endl;
+                        std::cout << "Disconnected, reconnecting..." << std::endl;
                     }
                 }
                 else
                 {
-                    std::cout << "Couldn't subscribe, next retry in 5s..." << std::endl;
+                    std::cout << "Couldn't subscribe, retrying..." << std::endl;
                 }
             }
             else
             {
-                std::cout << "Couldn't subscribe, next retry in 5s..." << std::endl;
+                std::cout << "Couldn't subscribe, retrying..." << std::endl;
             }
         }
         else
         {
-            std::cout << "Couldn't connect to the broker, next retry in 5s..." << std::endl;
+            std::cout << "Couldn't connect to the broker, retrying..." << std::endl;
+        }
+        if (!connected)
+        {
+            m_reconnect.attemptDone(false);
         }
 
-        // Delay before retry
+        // Prepare next attempt
         if (!m_end)
         {
             m_mqtt->close();
-            std::this_thread::sleep_for(std::chrono::seconds(5));
         }
         else
         {
-            // Update the status message
+            // Publish the pending replies and update the status message
+            if (connected)
+            {
+                m_queue.flush(*m_mqtt);
+            }
             m_mqtt->publish(m_status_topic,
                             buildStatusMessage("Dead",
                                                nb_phases,
@@ -283,160 +302,630 @@ void MqttManager::start(unsigned int nb_phases, unsigned int max_charge_point_cu
                             IMqttClient::QoS::QOS_0,
                             true);
         }
-    } while (!m_end);
+    }
 
     // Release resources
     delete m_mqtt;
 }
 
-/** @brief Indicate a pending Id tag */
-bool MqttManager::isIdTagPending(unsigned int connector_id) const
+/** @brief Get the next pending Id tag of a connector, returns false if no Id tag is pending */
+bool MqttManager::popIdTag(unsigned int connector_id, std::string& id_tag)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return !m_connectors[connector_id - 1u].id_tag.empty();
-}
-
-/** @brief Reset the pending Id tag */
-void MqttManager::resetIdTagPending(unsigned int connector_id)
-{
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_connectors[connector_id - 1u].id_tag = "";
+    PendingIdTag pending;
+    bool         ret = m_mailboxes[connector_id - 1u].id_tags.pop(pending);
+    if (ret)
+    {
+        id_tag = std::move(pending.id_tag);
+        publishReply(pending.reply, connector_id, "applied");
+    }
+    return ret;
 }
 
-/** @brief Pending Id tag for the remote start request */
-const std::string& MqttManager::pendingIdTag(unsigned int connector_id) const
+/** @brief Discard the pending Id tags of a connector */
+void MqttManager::clearIdTags(unsigned int connector_id)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return m_connectors[connector_id - 1u].id_tag;
+    PendingIdTag pending;
+    while (m_mailboxes[connector_id - 1u].id_tags.pop(pending))
+    {
+        publishReply(pending.reply, connector_id, "discarded");
+    }
 }
 
-/** @brief Update the data of a connector */
-void MqttManager::updateData(std::vector<ConnectorData>& connectors) const
+/** @brief Update the data of the connectors whose inputs have changed */
+void MqttManager::updateData(std::vector<ConnectorData>& connectors)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::array<CommandReply, ConnectorMailbox::MAX_PENDING_REPLIES> replies;
     for (ConnectorData& connector : connectors)
     {
-        const ConnectorData& mqtt_data = m_connectors[connector.id - 1u];
-        connector.car_cable_capacity   = mqtt_data.car_cable_capacity;
-        connector.car_ready            = mqtt_data.car_ready;
-        connector.car_consumption_l1   = mqtt_data.car_consumption_l1;
-        connector.car_consumption_l2   = mqtt_data.car_consumption_l2;
-        connector.car_consumption_l3   = mqtt_data.car_consumption_l3;
-        connector.fault_pending        = mqtt_data.fault_pending;
+        // The replies are pushed after the inputs have been stored, so the inputs
+        // loaded after popping a reply contain the corresponding command
+        ConnectorMailbox& mailbox = m_mailboxes[connector.id - 1u];
+        size_t            count   = 0;
+        while ((count < replies.size()) && mailbox.replies.pop(replies[count]))
+        {
+            count++;
+        }
+
+        ConnectorInputs inputs;
+        if (mailbox.inputs.loadIfChanged(inputs, mailbox.read_version))
+        {
+            // The car inputs may have been modified since by the vehicle model (ex: departure of the vehicle),
+            // they are only applied when a car command or a local control record has written them
+            if (inputs.car_version != mailbox.read_car_version)
+            {
+                connector.car_cable_capacity = inputs.car_cable_capacity;
+                connector.car_ready          = inputs.car_ready;
+                connector.car_consumption_l1 = inputs.car_consumption_l1;
+                connector.car_consumption_l2 = inputs.car_consumption_l2;
+                connector.car_consumption_l3 = inputs.car_consumption_l3;
+                connector.ev_profile         = inputs.ev_profile;
+                connector.ev_session         = inputs.ev_session;
+                mailbox.read_car_version     = inputs.car_version;
+            }
+            connector.fault_pending = inputs.fault_pending;
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            publishReply(replies[i], connector.id, "applied");
+        }
     }
 }
 
 /** @brief Publish the status of the charge point */
 bool MqttManager::publishStatus(const std::string& status, unsigned int nb_phases, float max_setpoint, ConnectorData::ConnectorType chargepoint_type)
 {
-    bool ret = false;
+    // Queue for publication
+    return m_queue.push(
+        m_status_topic,
+        buildStatusMessage(status.c_str(), nb_phases, max_setpoint, ConnectorData::ConnectorTypeHelper.toString(chargepoint_type).c_str()),
+        IMqttClient::QoS::QOS_0,
+        true,
+        MqttPublishQueue::PublishClass::STATUS);
+}
+
+/** @brief Publish the ocpp config of the connectors */
+void MqttManager::publishOcppConfig()
+{
+    // Compute topic name
+    std::stringstream topic;
+    topic << m_ocpp_config_topic;
+
+    // The changes are included in the whole config
+    std::lock_guard<std::mutex> lock(m_ocpp_config_mutex);
+    m_ocpp_config_changes.clear();
 
-    // Check connectivity
-    if (m_mqtt->isConnected())
+    // Get vector of key/value for ocpp config
+    std::vector<ocpp::types::CiStringType<50u>> keys;
+    std::vector<ocpp::types::KeyValue>          values;
+    std::vector<ocpp::types::CiStringType<50u>> unknown_values;
+    m_config.ocppConfig().getConfiguration(keys, values, unknown_values);
+
+    // Create the JSON message
+    rapidjson::Document msg;
+    msg.Parse("{}");
+    for (const ocpp::types::KeyValue& keyValue : values)
     {
-        // Publish
-        ret = m_mqtt->publish(
-            m_status_topic,
-            buildStatusMessage(
-                status.c_str(), nb_phases, max_setpoint, ConnectorData::ConnectorTypeHelper.toString(chargepoint_type).c_str()),
-            IMqttClient::QoS::QOS_0,
-            true);
+        if (!keyValue.value.value().empty())
+        {
+            rapidjson::Value key(keyValue.key.c_str(), msg.GetAllocator());
+            rapidjson::Value value(keyValue.value.value().c_str(), msg.GetAllocator());
+            msg.AddMember(key, value, msg.GetAllocator());
+        }
     }
+    rapidjson::StringBuffer                    buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    msg.Accept(writer);
 
-    return ret;
+    // Queue for publication
+    m_queue.push(topic.str(), buffer.GetString(), IMqttClient::QoS::QOS_0, true, MqttPublishQueue::PublishClass::CONFIG);
+    m_queue.push(m_ocpp_config_delta_topic, "{}", IMqttClient::QoS::QOS_0, true, MqttPublishQueue::PublishClass::CONFIG);
 }
 
-/** @brief Publish the ocpp config of the connectors */
-void MqttManager::publishOcppConfig()
+/** @brief Publish the data of the connectors */
+void MqttManager::publishData(const std::vector<ConnectorData>& connectors)
 {
-    // Check connectivity
-    if (m_mqtt->isConnected())
+    // Queue a message for each connector, the whole burst is published in a single batch
+    for (const ConnectorData& connector : connectors)
     {
         // Compute topic name
         std::stringstream topic;
-        topic << m_ocpp_config_topic;
-
-        // Get vector of key/value for ocpp config
-        std::vector<ocpp::types::CiStringType<50u>> keys;
-        std::vector<ocpp::types::KeyValue>          values;
-        std::vector<ocpp::types::CiStringType<50u>> unknown_values;
-        m_config.ocppConfig().getConfiguration(keys, values, unknown_values);
+        topic << m_connectors_topic << connector.id << "/status";
 
         // Create the JSON message
         rapidjson::Document msg;
         msg.Parse("{}");
-        for (const ocpp::types::KeyValue& keyValue : values)
+        msg.AddMember(
+            rapidjson::StringRef("status"),
+            rapidjson::Value(ocpp::types::ChargePointStatusHelper.toString(connector.status).c_str(), msg.GetAllocator()).Move(),
+            msg.GetAllocator());
+        msg.AddMember(
+            rapidjson::StringRef("id_tag"), rapidjson::Value(connector.id_tag.c_str(), msg.GetAllocator()).Move(), msg.GetAllocator());
+        msg.AddMember(rapidjson::StringRef("max_setpoint"), rapidjson::Value(connector.max_setpoint), msg.GetAllocator());
+        msg.AddMember(rapidjson::StringRef("ocpp_setpoint"), rapidjson::Value(connector.ocpp_setpoint), msg.GetAllocator());
+        msg.AddMember(rapidjson::StringRef("setpoint"), rapidjson::Value(connector.setpoint), msg.GetAllocator());
+        msg.AddMember(rapidjson::StringRef("car_consumption_l1"), rapidjson::Value(connector.car_consumption_l1), msg.GetAllocator());
+        msg.AddMember(rapidjson::StringRef("car_consumption_l2"), rapidjson::Value(connector.car_consumption_l2), msg.GetAllocator());
+        msg.AddMember(rapidjson::StringRef("car_consumption_l3"), rapidjson::Value(connector.car_consumption_l3), msg.GetAllocator());
+        msg.AddMember(rapidjson::StringRef("car_cable_capacity"), rapidjson::Value(connector.car_cable_capacity), msg.GetAllocator());
+        msg.AddMember(rapidjson::StringRef("car_ready"), rapidjson::Value(connector.car_ready), msg.GetAllocator());
+        if (connector.ev_soc >= 0.f)
+        {
+            msg.AddMember(rapidjson::StringRef("ev_profile"), rapidjson::Value(connector.ev_profile), msg.GetAllocator());
+            msg.AddMember(rapidjson::StringRef("ev_soc"), rapidjson::Value(connector.ev_soc), msg.GetAllocator());
+        }
+
+        static const char* consumption_str[] = {"consumption_l1", "consumption_l2", "consumption_l3"};
+        MeterSnapshot      meter             = connector.meter->getSnapshot();
+        for (unsigned int i = 0; i < 3; i++)
         {
-            if (!keyValue.value.value().empty())
+            if (i < meter.phases)
             {
-                rapidjson::Value key(keyValue.key.c_str(), msg.GetAllocator());
-                rapidjson::Value value(keyValue.value.value().c_str(), msg.GetAllocator());
-                msg.AddMember(key, value, msg.GetAllocator());
+                msg.AddMember(rapidjson::StringRef(consumption_str[i]), rapidjson::Value(meter.consumptions[i]), msg.GetAllocator());
+            }
+            else
+            {
+                msg.AddMember(rapidjson::StringRef(consumption_str[i]), rapidjson::Value(0), msg.GetAllocator());
             }
         }
+
         rapidjson::StringBuffer                    buffer;
         rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
         msg.Accept(writer);
 
-        // Publish
-        m_mqtt->publish(topic.str(), buffer.GetString(), IMqttClient::QoS::QOS_0, true);
+        // Queue for publication
+        m_queue.push(topic.str(), buffer.GetString(), IMqttClient::QoS::QOS_0, true, MqttPublishQueue::PublishClass::DATA);
     }
 }
 
-/** @brief Publish the data of the connectors */
-void MqttManager::publishData(const std::vector<ConnectorData>& connectors)
+/** @brief Publish the MQTT statistics of the charge point */
+void MqttManager::publishStats()
+{
+    // Get the statistics
+    MqttPublishQueue::Stats    queue_stats     = m_queue.stats();
+    IMqttClient::PublishStats  publish_stats   = m_mqtt->publishStats();
+    MqttTopicRouter::Stats     router_stats    = m_router.stats();
+    MqttReconnectPolicy::Stats reconnect_stats = m_reconnect.stats();
+
+    // Create the JSON message
+    rapidjson::Document                 msg;
+    rapidjson::Document::AllocatorType& allocator = msg.GetAllocator();
+    msg.SetObject();
+
+    rapidjson::Value queue(rapidjson::kObjectType);
+    queue.AddMember(rapidjson::StringRef("capacity"), rapidjson::Value(static_cast<uint64_t>(queue_stats.capacity)), allocator);
+    queue.AddMember(rapidjson::StringRef("depth"), rapidjson::Value(static_cast<uint64_t>(queue_stats.depth)), allocator);
+    queue.AddMember(rapidjson::StringRef("max_depth"), rapidjson::Value(static_cast<uint64_t>(queue_stats.max_depth)), allocator);
+    queue.AddMember(rapidjson::StringRef("pushed"), rapidjson::Value(queue_stats.pushed), allocator);
+    queue.AddMember(rapidjson::StringRef("coalesced"), rapidjson::Value(queue_stats.coalesced), allocator);
+    queue.AddMember(rapidjson::StringRef("dropped"), rapidjson::Value(queue_stats.dropped), allocator);
+    queue.AddMember(rapidjson::StringRef("published"), rapidjson::Value(queue_stats.published), allocator);
+    msg.AddMember(rapidjson::StringRef("queue"), queue, allocator);
+
+    static const char* class_names[MqttPublishQueue::PUBLISH_CLASS_COUNT] = {"status", "data", "config", "other"};
+    rapidjson::Value   throttling(rapidjson::kObjectType);
+    for (size_t i = 0; i < MqttPublishQueue::PUBLISH_CLASS_COUNT; i++)
+    {
+        rapidjson::Value publish_class(rapidjson::kObjectType);
+        publish_class.AddMember(rapidjson::StringRef("sent"), rapidjson::Value(queue_stats.classes[i].sent), allocator);
+        publish_class.AddMember(rapidjson::StringRef("throttled"), rapidjson::Value(queue_stats.classes[i].throttled), allocator);
+        publish_class.AddMember(rapidjson::StringRef("coalesced"), rapidjson::Value(queue_stats.classes[i].coalesced), allocator);
+        throttling.AddMember(rapidjson::StringRef(class_names[i]), publish_class, allocator);
+    }
+    throttling.AddMember(rapidjson::StringRef("host_throttled"), rapidjson::Value(queue_stats.host_throttled), allocator);
+    msg.AddMember(rapidjson::StringRef("throttling"), throttling, allocator);
+
+    rapidjson::Value publish(rapidjson::kObjectType);
+    publish.AddMember(rapidjson::StringRef("batches"), rapidjson::Value(publish_stats.batches), allocator);
+    publish.AddMember(rapidjson::StringRef("messages"), rapidjson::Value(publish_stats.messages), allocator);
+    publish.AddMember(rapidjson::StringRef("failures"), rapidjson::Value(publish_stats.failures), allocator);
+    publish.AddMember(
+        rapidjson::StringRef("last_latency_us"), rapidjson::Value(static_cast<int64_t>(publish_stats.last_latency.count())), allocator);
+    publish.AddMember(
+        rapidjson::StringRef("max_latency_us"), rapidjson::Value(static_cast<int64_t>(publish_stats.max_latency.count())), allocator);
+    publish.AddMember(
+        rapidjson::StringRef("total_latency_us"), rapidjson::Value(static_cast<int64_t>(publish_stats.total_latency.count())), allocator);
+    msg.AddMember(rapidjson::StringRef("publish"), publish, allocator);
+
+    rapidjson::Value router(rapidjson::kObjectType);
+    router.AddMember(rapidjson::StringRef("dispatched"), rapidjson::Value(router_stats.dispatched), allocator);
+    router.AddMember(rapidjson::StringRef("unrouted"), rapidjson::Value(router_stats.unrouted), allocator);
+    router.AddMember(rapidjson::StringRef("rejected"), rapidjson::Value(router_stats.rejected), allocator);
+    router.AddMember(
+        rapidjson::StringRef("total_lookup_ns"), rapidjson::Value(static_cast<int64_t>(router_stats.total_lookup_time.count())), allocator);
+    router.AddMember(
+        rapidjson::StringRef("max_lookup_ns"), rapidjson::Value(static_cast<int64_t>(router_stats.max_lookup_time.count())), allocator);
+    msg.AddMember(rapidjson::StringRef("router"), router, allocator);
+
+    rapidjson::Value reconnect(rapidjson::kObjectType);
+    reconnect.AddMember(rapidjson::StringRef("attempts"), rapidjson::Value(reconnect_stats.attempts), allocator);
+    reconnect.AddMember(rapidjson::StringRef("successes"), rapidjson::Value(reconnect_stats.successes), allocator);
+    reconnect.AddMember(rapidjson::StringRef("connection_losses"), rapidjson::Value(reconnect_stats.connection_losses), allocator);
+    reconnect.AddMember(
+        rapidjson::StringRef("last_delay_ms"), rapidjson::Value(static_cast<int64_t>(reconnect_stats.last_delay.count())), allocator);
+    msg.AddMember(rapidjson::StringRef("reconnect"), reconnect, allocator);
+
+    rapidjson::Value commands(rapidjson::kObjectType);
+    commands.AddMember(rapidjson::StringRef("duplicates"), rapidjson::Value(m_command_ids.duplicates()), allocator);
+    msg.AddMember(rapidjson::StringRef("commands"), commands, allocator);
+
+    LocalControl::Stats local_control_stats = m_local_control.stats();
+    rapidjson::Value    local_control(rapidjson::kObjectType);
+    local_control.AddMember(rapidjson::StringRef("datagrams"), rapidjson::Value(local_control_stats.datagrams), allocator);
+    local_control.AddMember(rapidjson::StringRef("records"), rapidjson::Value(local_control_stats.records), allocator);
+    local_control.AddMember(rapidjson::StringRef("invalid"), rapidjson::Value(local_control_stats.invalid), allocator);
+    local_control.AddMember(rapidjson::StringRef("oversized"), rapidjson::Value(local_control_stats.oversized), allocator);
+    msg.AddMember(rapidjson::StringRef("local_control"), local_control, allocator);
+
+    MeterEngine::Stats meters_stats = m_meter_engine.stats();
+    rapidjson::Value   meters(rapidjson::kObjectType);
+    meters.AddMember(rapidjson::StringRef("count"), rapidjson::Value(static_cast<uint64_t>(meters_stats.meters)), allocator);
+    meters.AddMember(
+        rapidjson::StringRef("update_period_ms"), rapidjson::Value(static_cast<int64_t>(meters_stats.update_period.count())), allocator);
+    meters.AddMember(rapidjson::StringRef("ticks"), rapidjson::Value(meters_stats.ticks), allocator);
+    meters.AddMember(
+        rapidjson::StringRef("last_tick_ns"), rapidjson::Value(static_cast<int64_t>(meters_stats.last_tick_duration.count())), allocator);
+    meters.AddMember(
+        rapidjson::StringRef("max_tick_ns"), rapidjson::Value(static_cast<int64_t>(meters_stats.max_tick_duration.count())), allocator);
+    meters.AddMember(
+        rapidjson::StringRef("total_tick_ns"), rapidjson::Value(static_cast<int64_t>(meters_stats.total_tick_duration.count())), allocator);
+    meters.AddMember(rapidjson::StringRef("grid_seed"), rapidjson::Value(meters_stats.grid_seed), allocator);
+    msg.AddMember(rapidjson::StringRef("meters"), meters, allocator);
+
+    MeterValuesStress::Stats stress_stats = m_meter_values_stress.stats();
+    rapidjson::Value         stress(rapidjson::kObjectType);
+    stress.AddMember(rapidjson::StringRef("period_ms"), rapidjson::Value(static_cast<int64_t>(stress_stats.period.count())), allocator);
+    stress.AddMember(rapidjson::StringRef("messages"), rapidjson::Value(stress_stats.messages), allocator);
+    stress.AddMember(rapidjson::StringRef("failures"), rapidjson::Value(stress_stats.failures), allocator);
+    stress.AddMember(rapidjson::StringRef("skipped_periods"), rapidjson::Value(stress_stats.skipped_periods), allocator);
+    stress.AddMember(rapidjson::StringRef("sampled_values"), rapidjson::Value(stress_stats.sampled_values), allocator);
+    stress.AddMember(
+        rapidjson::StringRef("total_build_ns"), rapidjson::Value(static_cast<int64_t>(stress_stats.build_duration.count())), allocator);
+    stress.AddMember(
+        rapidjson::StringRef("total_send_ns"), rapidjson::Value(static_cast<int64_t>(stress_stats.send_duration.count())), allocator);
+    msg.AddMember(rapidjson::StringRef("meter_values_stress"), stress, allocator);
+
+    rapidjson::StringBuffer                    buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    msg.Accept(writer);
+
+    // Queue for publication
+    m_queue.push(m_stats_topic, buffer.GetString(), IMqttClient::QoS::QOS_0, false);
+}
+
+/** @brief Handle a message on the command topic */
+void MqttManager::cmdMessageReceived(std::string_view message)
+{
+    rapidjson::Document payload;
+    CommandReply        reply;
+    if (parseCommand(message, "cmd", payload, reply))
+    {
+        if (payload.HasMember("type") && payload["type"].IsString())
+        {
+            const char* type = payload["type"].GetString();
+            reply.type       = type;
+            if (strcmp(type, "close") == 0)
+            {
+                std::cout << "Close command received" << std::endl;
+                publishReply(reply, 0, "applied");
+                m_end = true;
+                m_queue.wakeUp();
+                m_reconnect.cancel();
+            }
+            else if (strcmp(type, "ocpp_config") == 0)
+            {
+                publishOcppConfig();
+                publishReply(reply, 0, "applied");
+            }
+            else if (strcmp(type, "stats") == 0)
+            {
+                publishStats();
+                publishReply(reply, 0, "applied");
+            }
+            else
+            {
+                publishReply(reply, 0, "unknown");
+            }
+        }
+        else
+        {
+            std::cout << "Unknown command : " << message << std::endl;
+            publishReply(reply, 0, "unknown");
+        }
+    }
+}
+
+/** @brief Handle a message on the car topic of a connector */
+void MqttManager::carMessageReceived(unsigned int connector_id, std::string_view message)
+{
+    rapidjson::Document payload;
+    CommandReply        reply;
+    ConnectorMailbox*   mailbox = getMailbox(connector_id);
+    if (mailbox && parseCommand(message, "car", payload, reply))
+    {
+        std::lock_guard<std::mutex> lock(m_inputs_mutex);
+        if (payload.HasMember("cable"))
+        {
+            rapidjson::Value& cable = payload["cable"];
+            if (cable.IsFloat())
+            {
+                mailbox->written_inputs.car_cable_capacity = cable.GetFloat();
+            }
+        }
+        if (payload.HasMember("ready"))
+        {
+            rapidjson::Value& ready = payload["ready"];
+            if (ready.IsBool())
+            {
+                mailbox->written_inputs.car_ready = ready.GetBool();
+            }
+        }
+        if (payload.HasMember("consumption_l1"))
+        {
+            rapidjson::Value& consumption_l1 = payload["consumption_l1"];
+            if (consumption_l1.IsFloat())
+            {
+                mailbox->written_inputs.car_consumption_l1 = consumption_l1.GetFloat();
+            }
+        }
+        if (payload.HasMember("consumption_l2"))
+        {
+            rapidjson::Value& consumption_l2 = payload["consumption_l2"];
+            if (consumption_l2.IsFloat())
+            {
+                mailbox->written_inputs.car_consumption_l2 = consumption_l2.GetFloat();
+            }
+        }
+        if (payload.HasMember("consumption_l3"))
+        {
+            rapidjson::Value& consumption_l3 = payload["consumption_l3"];
+            if (consumption_l3.IsFloat())
+            {
+                mailbox->written_inputs.car_consumption_l3 = consumption_l3.GetFloat();
+            }
+        }
+        if (payload.HasMember("ev_profile"))
+        {
+            rapidjson::Value& ev_profile = payload["ev_profile"];
+            if (ev_profile.IsUint())
+            {
+                // A new session is started even if the profile is the same (new vehicle)
+                mailbox->written_inputs.ev_profile = ev_profile.GetUint();
+                mailbox->written_inputs.ev_session++;
+            }
+        }
+        mailbox->written_inputs.car_version++;
+
+        // Make the new inputs visible to the control loop
+        mailbox->inputs.store(mailbox->written_inputs);
+        deferReply(*mailbox, connector_id, reply);
+    }
+}
+
+/** @brief Handle a message on the id tag topic of a connector */
+void MqttManager::idTagMessageReceived(unsigned int connector_id, std::string_view message)
 {
-    // Check connectivity
-    if (m_mqtt->isConnected())
+    rapidjson::Document payload;
+    CommandReply        reply;
+    ConnectorMailbox*   mailbox = getMailbox(connector_id);
+    if (mailbox && parseCommand(message, "id_tag", payload, reply))
     {
-        // Publish for each connector
-        for (const ConnectorData& connector : connectors)
+        std::lock_guard<std::mutex> lock(m_inputs_mutex);
+        bool valid = false;
+        if (payload.HasMember("id"))
         {
-            // Compute topic name
-            std::stringstream topic;
-            topic << m_connectors_topic << connector.id << "/status";
-
-            // Create the JSON message
-            rapidjson::Document msg;
-            msg.Parse("{}");
-            msg.AddMember(
-                rapidjson::StringRef("status"),
-                rapidjson::Value(ocpp::types::ChargePointStatusHelper.toString(connector.status).c_str(), msg.GetAllocator()).Move(),
-                msg.GetAllocator());
-            msg.AddMember(
-                rapidjson::StringRef("id_tag"), rapidjson::Value(connector.id_tag.c_str(), msg.GetAllocator()).Move(), msg.GetAllocator());
-            msg.AddMember(rapidjson::StringRef("max_setpoint"), rapidjson::Value(connector.max_setpoint), msg.GetAllocator());
-            msg.AddMember(rapidjson::StringRef("ocpp_setpoint"), rapidjson::Value(connector.ocpp_setpoint), msg.GetAllocator());
-            msg.AddMember(rapidjson::StringRef("setpoint"), rapidjson::Value(connector.setpoint), msg.GetAllocator());
-            msg.AddMember(rapidjson::StringRef("car_consumption_l1"), rapidjson::Value(connector.car_consumption_l1), msg.GetAllocator());
-            msg.AddMember(rapidjson::StringRef("car_consumption_l2"), rapidjson::Value(connector.car_consumption_l2), msg.GetAllocator());
-            msg.AddMember(rapidjson::StringRef("car_consumption_l3"), rapidjson::Value(connector.car_consumption_l3), msg.GetAllocator());
-            msg.AddMember(rapidjson::StringRef("car_cable_capacity"), rapidjson::Value(connector.car_cable_capacity), msg.GetAllocator());
-            msg.AddMember(rapidjson::StringRef("car_ready"), rapidjson::Value(connector.car_ready), msg.GetAllocator());
-
-            static const char* consumption_str[] = {"consumption_l1", "consumption_l2", "consumption_l3"};
-            std::vector<float> consumptions      = connector.meter->getConsumptions();
-            unsigned int       nb_phases         = connector.meter->getNumberOfPhases();
-            for (unsigned int i = 0; i < 3; i++)
+            rapidjson::Value& id = payload["id"];
+            if (id.IsString() && (id.GetStringLength() != 0))
             {
-                if (i < nb_phases)
+                // The reply is published when the control loop takes the id tag
+                PendingIdTag pending;
+                pending.id_tag = id.GetString();
+                pending.reply  = reply;
+                valid          = true;
+                if (!mailbox->id_tags.push(pending))
                 {
-                    msg.AddMember(rapidjson::StringRef(consumption_str[i]), rapidjson::Value(consumptions[i]), msg.GetAllocator());
+                    std::cout << "Too many pending id tags on connector " << connector_id << std::endl;
+                    publishReply(reply, connector_id, "rejected");
                 }
-                else
+            }
+        }
+        if (!valid)
+        {
+            publishReply(reply, connector_id, "invalid");
+        }
+    }
+}
+
+/** @brief Handle a message on the faulted topic of a connector */
+void MqttManager::faultedMessageReceived(unsigned int connector_id, std::string_view message)
+{
+    rapidjson::Document payload;
+    CommandReply        reply;
+    ConnectorMailbox*   mailbox = getMailbox(connector_id);
+    if (mailbox && parseCommand(message, "faulted", payload, reply))
+    {
+        std::lock_guard<std::mutex> lock(m_inputs_mutex);
+        if (payload.HasMember("faulted"))
+        {
+            rapidjson::Value& faulted = payload["faulted"];
+            if (faulted.IsBool())
+            {
+                mailbox->written_inputs.fault_pending = faulted.GetBool();
+            }
+        }
+
+        // Make the new inputs visible to the control loop
+        mailbox->inputs.store(mailbox->written_inputs);
+        deferReply(*mailbox, connector_id, reply);
+    }
+}
+
+/** @copydoc size_t LocalControl::IListener::localRecordsReceived(const LocalControl::Record*, size_t) */
+size_t MqttManager::localRecordsReceived(const LocalControl::Record* records, size_t count)
+{
+    size_t invalid = 0;
+
+    std::lock_guard<std::mutex> lock(m_inputs_mutex);
+    for (size_t i = 0; i < count; i++)
+    {
+        const LocalControl::Record& record  = records[i];
+        ConnectorMailbox*           mailbox = nullptr;
+        if ((record.connector_id != 0) && (record.connector_id <= m_mailboxes.size()))
+        {
+            mailbox = &m_mailboxes[record.connector_id - 1u];
+        }
+        if (mailbox && (record.type == static_cast<uint8_t>(LocalControl::RecordType::CAR)))
+        {
+            ConnectorInputs& inputs = mailbox->written_inputs;
+            if ((record.mask & LocalControl::MASK_CABLE) != 0)
+            {
+                inputs.car_cable_capacity = record.cable;
+            }
+            if ((record.mask & LocalControl::MASK_READY) != 0)
+            {
+                inputs.car_ready = ((record.flags & LocalControl::FLAG_READY) != 0);
+            }
+            if ((record.mask & LocalControl::MASK_CONSUMPTION_L1) != 0)
+            {
+                inputs.car_consumption_l1 = record.consumptions[0];
+            }
+            if ((record.mask & (LocalControl::MASK_CONSUMPTION_L1 << 1u)) != 0)
+            {
+                inputs.car_consumption_l2 = record.consumptions[1];
+            }
+            if ((record.mask & (LocalControl::MASK_CONSUMPTION_L1 << 2u)) != 0)
+            {
+                inputs.car_consumption_l3 = record.consumptions[2];
+            }
+            inputs.car_version++;
+            m_local_touched[record.connector_id - 1u] = true;
+        }
+        else if (mailbox && (record.type == static_cast<uint8_t>(LocalControl::RecordType::FAULTED)))
+        {
+            mailbox->written_inputs.fault_pending     = ((record.flags & LocalControl::FLAG_FAULTED) != 0);
+            m_local_touched[record.connector_id - 1u] = true;
+        }
+        else if (mailbox && (record.type == static_cast<uint8_t>(LocalControl::RecordType::ID_TAG)) && (record.id_tag[0] != 0))
+        {
+            // No reply for the local control id tags
+            PendingIdTag pending;
+            pending.id_tag.assign(record.id_tag, strnlen(record.id_tag, LocalControl::ID_TAG_SIZE));
+            if (!mailbox->id_tags.push(pending))
+            {
+                invalid++;
+            }
+        }
+        else
+        {
+            invalid++;
+        }
+    }
+
+    // Make the new inputs visible to the control loop, once per connector for the whole datagram
+    for (size_t i = 0; i < m_local_touched.size(); i++)
+    {
+        if (m_local_touched[i])
+        {
+            m_mailboxes[i].inputs.store(m_mailboxes[i].written_inputs);
+            m_local_touched[i] = false;
+        }
+    }
+
+    return invalid;
+}
+
+/** @brief Decode a command and prepare its reply, returns false if the command is invalid or has already been received */
+bool MqttManager::parseCommand(std::string_view message, const char* type, rapidjson::Document& payload, CommandReply& reply)
+{
+    bool ret = false;
+
+    reply.type     = type;
+    reply.received = std::chrono::steady_clock::now();
+    if (parsePayload(message, payload) && payload.IsObject())
+    {
+        // Optional correlation id and reply topic
+        ret = true;
+        if (payload.HasMember("cmd_id"))
+        {
+            const rapidjson::Value& cmd_id = payload["cmd_id"];
+            if (cmd_id.IsString() && (cmd_id.GetStringLength() != 0))
+            {
+                reply.cmd_id.assign(cmd_id.GetString(), cmd_id.GetStringLength());
+                reply.reply_to = m_reply_topic;
+                if (payload.HasMember("reply_to"))
+                {
+                    const rapidjson::Value& reply_to = payload["reply_to"];
+                    if (reply_to.IsString() && (reply_to.GetStringLength() != 0))
+                    {
+                        reply.reply_to.assign(reply_to.GetString(), reply_to.GetStringLength());
+                    }
+                }
+
+                // Redelivered commands are acknowledged again but not applied
+                ret = m_command_ids.add(reply.cmd_id);
+                if (!ret)
                 {
-                    msg.AddMember(rapidjson::StringRef(consumption_str[i]), rapidjson::Value(0), msg.GetAllocator());
+                    std::cout << "Duplicate command ignored : " << reply.cmd_id << std::endl;
+                    publishReply(reply, 0, "duplicate");
                 }
             }
+        }
+    }
 
-            rapidjson::StringBuffer                    buffer;
-            rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-            msg.Accept(writer);
+    return ret;
+}
 
-            // Publish
-            m_mqtt->publish(topic.str(), buffer.GetString(), IMqttClient::QoS::QOS_0, true);
+/** @brief Keep the reply to a command modifying the inputs of a connector until the control loop has loaded them */
+void MqttManager::deferReply(ConnectorMailbox& mailbox, unsigned int connector_id, const CommandReply& reply)
+{
+    if (!reply.cmd_id.empty() && !mailbox.replies.push(reply))
+    {
+        // Too many pending replies, the inputs have been stored but their application can't be confirmed
+        publishReply(reply, connector_id, "accepted");
+    }
+}
+
+/** @brief Publish the reply to a command (nothing is published for commands without id) */
+void MqttManager::publishReply(const CommandReply& reply, unsigned int connector_id, const char* result)
+{
+    if (!reply.cmd_id.empty())
+    {
+        auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - reply.received);
+
+        // Create the JSON message
+        rapidjson::Document                 msg;
+        rapidjson::Document::AllocatorType& allocator = msg.GetAllocator();
+        msg.SetObject();
+        msg.AddMember(rapidjson::StringRef("cmd_id"), rapidjson::Value(reply.cmd_id.c_str(), allocator).Move(), allocator);
+        msg.AddMember(rapidjson::StringRef("type"), rapidjson::Value(reply.type, allocator).Move(), allocator);
+        if (connector_id != 0)
+        {
+            msg.AddMember(rapidjson::StringRef("connector"), rapidjson::Value(connector_id), allocator);
         }
+        msg.AddMember(rapidjson::StringRef("result"), rapidjson::StringRef(result), allocator);
+        msg.AddMember(rapidjson::StringRef("latency_us"), rapidjson::Value(static_cast<int64_t>(latency.count())), allocator);
+
+        rapidjson::StringBuffer                    buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+        msg.Accept(writer);
+
+        // Queue for publication
+        m_queue.push(reply.reply_to, buffer.GetString(), IMqttClient::QoS::QOS_1, false);
+    }
+}
+
+/** @brief Get the mailbox of a connector */
+ConnectorMailbox* MqttManager::getMailbox(unsigned int connector_id)
+{
+    ConnectorMailbox* mailbox = nullptr;
+    if ((connector_id > 0) && (connector_id <= m_mailboxes.size()))
+    {
+        mailbox = &m_mailboxes[connector_id - 1u];
+    }
+    else
+    {
+        std::cout << "Invalid connector : " << connector_id << std::endl;
     }
+    return mailbox;
 }
 
 /** @brief Build the status message of the charge point */
@@ -25,24 +25,37 @@ SOFTWARE.
 #ifndef MQTTMANAGER_H
 #define MQTTMANAGER_H
 
+#include "CommandIdHistory.h"
 #include "ConnectorData.h"
+#include "ConnectorMailbox.h"
 #include "IMqttClient.h"
-
+#include "LocalControl.h"
+#include "MqttPublishQueue.h"
+#include "MqttReconnectPolicy.h"
+#include "MqttTopicRouter.h"
+#include "OcppConfig.h"
+
+#include <openocpp/json.h>
+#include <map>
 #include <mutex>
 #include <string>
 #include <vector>
 
+class MeterEngine;
+class MeterValuesStress;
 class SimulatedChargePointConfig;
 
 /** @brief Manage MQTT connectivity */
-class MqttManager : public IMqttClient::IListener
+class MqttManager : public IMqttClient::IListener, public OcppConfig::IListener, public LocalControl::IListener
 {
   public:
     /**
      * @brief Constructor
      * @param config Configuration
+     * @param meter_engine Meters of the connectors
+     * @param meter_values_stress MeterValues stress messages
      */
-    MqttManager(SimulatedChargePointConfig& config);
+    MqttManager(SimulatedChargePointConfig& config, const MeterEngine& meter_engine, const MeterValuesStress& meter_values_stress);
 
     /** @brief Destructor */
     virtual ~MqttManager();
@@ -53,23 +66,29 @@ class MqttManager : public IMqttClient::IListener
     /** @copydoc void IMqttClient::IListener::mqttMessageReceived(const char*, const std::string&, IMqttClient::QoS, bool) */
     void mqttMessageReceived(const char* topic, const std::string& message, IMqttClient::QoS qos, bool retained) override;
 
+    /** @copydoc void IMqttClient::IListener::mqttMessageViewReceived(const char*, std::string_view, IMqttClient::QoS, bool) */
+    void mqttMessageViewReceived(const char* topic, std::string_view message, IMqttClient::QoS qos, bool retained) override;
+
+    /** @copydoc void OcppConfig::IListener::ocppConfigChanged(const std::string&, const std::string&) */
+    void ocppConfigChanged(const std::string& key, const std::string& value) override;
+
+    /** @copydoc size_t LocalControl::IListener::localRecordsReceived(const LocalControl::Record*, size_t) */
+    size_t localRecordsReceived(const LocalControl::Record* records, size_t count) override;
+
     /** @brief Indicate that an end of application command has been received */
     bool isEndOfApplication() const { return m_end; }
 
     /** @brief Start the MQTT connection process (blocking) */
     void start(unsigned int nb_phases, unsigned int max_charge_point_current, ConnectorData::ConnectorType chargepoint_type);
 
-    /** @brief Indicate a pending Id tag */
-    bool isIdTagPending(unsigned int connector_id) const;
-
-    /** @brief Reset the pending Id tag */
-    void resetIdTagPending(unsigned int connector_id);
+    /** @brief Get the next pending Id tag of a connector, returns false if no Id tag is pending */
+    bool popIdTag(unsigned int connector_id, std::string& id_tag);
 
-    /** @brief Pending Id tag for the remote start request */
-    const std::string& pendingIdTag(unsigned int connector_id) const;
+    /** @brief Discard the pending Id tags of a connector */
+    void clearIdTags(unsigned int connector_id);
 
-    /** @brief Update the data of the connectors */
-    void updateData(std::vector<ConnectorData>& connectors) const;
+    /** @brief Update the data of the connectors whose inputs have changed */
+    void updateData(std::vector<ConnectorData>& connectors);
 
     /** @brief Publish the status of the charge point */
     bool publishStatus(const std::string& status, unsigned int nb_phases, float max_setpoint, ConnectorData::ConnectorType chargepoint_type);
@@ -80,25 +99,71 @@ class MqttManager : public IMqttClient::IListener
     /** @brief Publish the ocpp config of the charge point */
     void publishOcppConfig();
 
+    /** @brief Publish the MQTT statistics of the charge point */
+    void publishStats();
+
   private:
     /** @brief Configuration */
     SimulatedChargePointConfig& m_config;
+    /** @brief Meters of the connectors */
+    const MeterEngine& m_meter_engine;
+    /** @brief MeterValues stress messages */
+    const MeterValuesStress& m_meter_values_stress;
 
-    /** @brief Mutex to access connector data */
-    mutable std::mutex m_mutex;
     /** @brief Indicate that an end of application command has been received */
     bool m_end;
-    /** @brief Connector data */
-    std::vector<ConnectorData> m_connectors;
+    /** @brief Mailboxes of the connectors */
+    std::vector<ConnectorMailbox> m_mailboxes;
+    /** @brief Mutex to serialize the producers of the mailboxes (MQTT callbacks and local control) */
+    std::mutex m_inputs_mutex;
+    /** @brief Connectors whose inputs have been modified by the current local control records */
+    std::vector<bool> m_local_touched;
 
     /** @brief MQTT client */
     IMqttClient* m_mqtt;
+    /** @brief Router for the incoming messages */
+    MqttTopicRouter m_router;
+    /** @brief Queue of the outgoing messages */
+    MqttPublishQueue m_queue;
+    /** @brief Reconnection policy */
+    MqttReconnectPolicy m_reconnect;
     /** @brief Status topic */
     std::string m_status_topic;
     /** @brief Config topic */
     std::string m_ocpp_config_topic;
+    /** @brief Config changes topic */
+    const std::string m_ocpp_config_delta_topic;
+    /** @brief Mutex to protect the config changes */
+    std::mutex m_ocpp_config_mutex;
+    /** @brief Config changes since the last publication of the whole config */
+    std::map<std::string, std::string> m_ocpp_config_changes;
     /** @brief Connectors topic */
     std::string m_connectors_topic;
+    /** @brief Statistics topic */
+    std::string m_stats_topic;
+    /** @brief Default topic for the replies to the commands */
+    std::string m_reply_topic;
+    /** @brief Latest command ids */
+    CommandIdHistory m_command_ids;
+    /** @brief Local control interface (last member : its thread is stopped first) */
+    LocalControl m_local_control;
+
+    /** @brief Handle a message on the command topic */
+    void cmdMessageReceived(std::string_view message);
+    /** @brief Handle a message on the car topic of a connector */
+    void carMessageReceived(unsigned int connector_id, std::string_view message);
+    /** @brief Handle a message on the id tag topic of a connector */
+    void idTagMessageReceived(unsigned int connector_id, std::string_view message);
+    /** @brief Handle a message on the faulted topic of a connector */
+    void faultedMessageReceived(unsigned int connector_id, std::string_view message);
+    /** @brief Decode a command and prepare its reply, returns false if the command is invalid or has already been received */
+    bool parseCommand(std::string_view message, const char* type, rapidjson::Document& payload, CommandReply& reply);
+    /** @brief Keep the reply to a command modifying the inputs of a connector until the control loop has loaded them */
+    void deferReply(ConnectorMailbox& mailbox, unsigned int connector_id, const CommandReply& reply);
+    /** @brief Publish the reply to a command (nothing is published for commands without id) */
+    void publishReply(const CommandReply& reply, unsigned int connector_id, const char* result);
+    /** @brief Get the mailbox of a connector */
+    ConnectorMailbox* getMailbox(unsigned int connector_id);
 
     /** @brief Build the status message of the charge point */
     std::string buildStatusMessage(const char* status, unsigned int nb_phases, float max_setpoint, const char* chargepoint_type);
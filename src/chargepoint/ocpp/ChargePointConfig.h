@@ -116,6 +116,23 @@ class ChargePointConfig : public ocpp::config::IChargePointConfig
     // /** @brief power factor of total energy flow */
     float powerFactor()  { return static_cast<float>(getFloat("PowerFactor")); }
 
+    /** @brief Period of the meters update */
+    std::chrono::milliseconds meterUpdatePeriod() const
+    {
+        return std::chrono::milliseconds(m_config.get(STACK_PARAMS, "MeterUpdatePeriod", 500u).toUInt());
+    }
+    /** @brief Path of the EV profile library file (empty = built-in profiles) */
+    std::string evProfileLibrary() const { return getString("EvProfileLibrary"); }
+    /** @brief Number of decimals of the meter values */
+    unsigned int meterValuesPrecision() const { return m_config.get(STACK_PARAMS, "MeterValuesPrecision", 3u).toUInt(); }
+    /** @brief Period of the MeterValues stress messages (0 = disabled) */
+    std::chrono::milliseconds meterValuesStressPeriod() const
+    {
+        return std::chrono::milliseconds(m_config.get(STACK_PARAMS, "MeterValuesStressPeriod", 0u).toUInt());
+    }
+    /** @brief Comma separated list of the measurands of the MeterValues stress messages (empty = all the supported measurands) */
+    std::string meterValuesStressMeasurands() const { return getString("MeterValuesStressMeasurands"); }
+
     // Authent
 
     /** @brief Maximum number of entries in the authentication cache */
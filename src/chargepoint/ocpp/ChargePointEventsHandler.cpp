@@ -53,7 +53,8 @@ ChargePointEventsHandler::ChargePointEventsHandler(SimulatedChargePointConfig& c
       m_remote_stop_pending(m_remote_start_pending.size()),
       m_remote_start_id_tag(m_remote_start_pending.size()),
       m_is_connected(false),
-      m_reset_pending(false)
+      m_reset_pending(false),
+      m_meter_values(m_remote_start_pending.size(), config.meterValuesPrecision())
 {
     for (unsigned int i = 0; i < m_remote_start_pending.size(); i++)
     {
@@ -125,7 +126,7 @@ int ChargePointEventsHandler::getTxStartStopMeterValue(unsigned int connector_id
     cout << "Get start/stop meter value for connector " << connector_id << " : ";
     if (connector_id > 0)
     {
-        value = static_cast<int>(m_connectors->at(connector_id - 1u).meter->getEnergy());
+        value = static_cast<int>(m_connectors->at(connector_id - 1u).meter->getSnapshot().energy);
     }
     cout << value << endl;
     return value;
@@ -164,161 +165,9 @@ bool ChargePointEventsHandler::getMeterValue(unsigned int connector_id,
 {
     bool ret = false;
 
-    cout << "getMeterValue : " << connector_id << " - " << MeasurandHelper.toString(measurand.first) << endl;
     if (connector_id > 0)
     {
-
-        SampledValue    value;
-        MeterSimulator* meter_simulator = m_connectors->at(connector_id - 1u).meter;
-        ret                             = true;
-        switch (measurand.first)
-        {
-            case Measurand::CurrentImport:
-            {
-                auto currents = meter_simulator->getConsumptions();
-                if (measurand.second.isSet())
-                {
-                    unsigned int phase = static_cast<unsigned int>(measurand.second.value());
-                    if (phase <= meter_simulator->getNumberOfPhases())
-                    {
-                        value.value = std::to_string(currents[phase]);
-                        value.phase = static_cast<Phase>(phase);
-                        value.unit.value() = UnitOfMeasure::A;
-                        meter_value.sampledValue.push_back(value);
-                    }
-                    else
-                    {
-                        ret = false;
-                    }
-                }
-                else
-                {
-                    for (size_t i = 0; i < currents.size(); i++)
-                    {
-                        value.value = std::to_string(currents[i]);
-                        value.phase = static_cast<Phase>(i);
-                        value.unit.value() = UnitOfMeasure::A;
-                        meter_value.sampledValue.push_back(value);
-                    }
-                }
-            }
-            break;
-
-            case Measurand::CurrentOffered:
-            {
-                auto setpoint = m_connectors->at(connector_id - 1u).setpoint;
-                value.value   = std::to_string(static_cast<unsigned int>(setpoint));
-                value.unit.value() = UnitOfMeasure::A;
-                meter_value.sampledValue.push_back(value);
-            }
-            break;
-
-            case Measurand::PowerOffered:
-            {
-                auto setpoint = m_connectors->at(connector_id - 1u).setpoint;
-                value.value   = std::to_string(static_cast<unsigned int>(setpoint));
-                value.unit.value() = UnitOfMeasure::W;
-                meter_value.sampledValue.push_back(value);
-            }
-            break;
-
-            case Measurand::EnergyActiveImportRegister:
-            {
-                value.value = std::to_string(meter_simulator->getEnergy());
-                value.phase = ocpp::types::Optional<Phase>();
-                meter_value.sampledValue.push_back(value);
-            }
-            break;
-
-            case Measurand::PowerActiveImport:
-            {
-                auto powers = meter_simulator->getInstantPowers();
-                if (measurand.second.isSet())
-                {
-                    // a phase is specified :
-                    unsigned int phase = static_cast<unsigned int>(measurand.second.value());
-                    if (phase <= meter_simulator->getNumberOfPhases())
-                    {
-                        value.value        = std::to_string(powers[phase]);
-                        value.phase        = static_cast<Phase>(phase);
-                        value.unit.value() = UnitOfMeasure::W;
-                        meter_value.sampledValue.push_back(value);
-                    }
-                    else
-                    {
-                        ret = false;
-                    }
-                }
-                else
-                {
-                    // no phase specified :
-                    if (meter_simulator->getCurrentOutType() == ConnectorData::ConnectorType::DC)
-                    {
-                        // only first value for DC
-                        value.value        = std::to_string(powers[0]);
-                        value.unit.value() = UnitOfMeasure::W;
-                        meter_value.sampledValue.push_back(value);
-                    }
-                    else
-                    {
-                        // all phases for AC station
-                        for (size_t i = 0; i < powers.size(); i++)
-                        {
-                            value.value        = std::to_string(powers[i]);
-                            value.phase        = static_cast<Phase>(i);
-                            value.unit.value() = UnitOfMeasure::W;
-                            meter_value.sampledValue.push_back(value);
-                        }
-                    }
-                }
-            }
-            break;
-
-            case Measurand::PowerFactor:
-            {
-                value.value = std::to_string(meter_simulator->getPowerFactor());
-                value.phase = ocpp::types::Optional<Phase>();
-                meter_value.sampledValue.push_back(value);
-            }
-            break;
-
-            case Measurand::Voltage:
-            {
-                auto voltages = meter_simulator->getVoltages();
-                if (measurand.second.isSet())
-                {
-                    unsigned int phase = static_cast<unsigned int>(measurand.second.value());
-                    if (phase <= meter_simulator->getNumberOfPhases())
-                    {
-                        value.value        = std::to_string(voltages[phase]);
-                        value.phase        = static_cast<Phase>(phase);
-                        value.unit.value() = UnitOfMeasure::V;
-                        meter_value.sampledValue.push_back(value);
-                    }
-                    else
-                    {
-                        ret = false;
-                    }
-                }
-                else
-                {
-                    for (size_t i = 0; i < voltages.size(); i++)
-                    {
-                        value.value = std::to_string(voltages[i]);
-                        value.phase = static_cast<Phase>(i);
-                        value.unit.value() = UnitOfMeasure::V;
-                        meter_value.sampledValue.push_back(value);
-                    }
-                }
-            }
-            break;
-
-            default:
-            {
-                ret = false;
-            }
-            break;
-        }
+        ret = m_meter_values.build(connector_id, m_connectors->at(connector_id - 1u), measurand, meter_value);
     }
 
     return ret;
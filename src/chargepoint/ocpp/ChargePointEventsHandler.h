@@ -26,6 +26,7 @@ SOFTWARE.
 #define CHARGEPOINTEVENTSHANDLER_H
 
 #include "ConnectorData.h"
+#include "MeterValuesBuilder.h"
 
 #include <filesystem>
 #include <iostream>
@@ -258,6 +259,8 @@ class ChargePointEventsHandler : public ocpp::chargepoint::IChargePointEventsHan
     bool m_is_connected;
     /** @brief Flag to know if the Charge Point has to be reset */
     bool m_reset_pending;
+    /** @brief Cached sampled values of the connectors */
+    MeterValuesBuilder m_meter_values;
 
     /** @brief Get the number of installed CA certificates */
     unsigned int getNumberOfCaCertificateInstalled(bool manufacturer, bool central_system, bool iso15118);
@@ -0,0 +1,386 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "MeterValuesBuilder.h"
+#include "MeterSimulator.h"
+
+#include <algorithm>
+#include <charconv>
+
+using namespace ocpp::types;
+
+/** @brief Number of cache slots of a measurand : one for each phase of the meters, one without phase and one for the other phases */
+static constexpr size_t PHASE_SLOTS = MeterSnapshot::MAX_PHASES + 2u;
+
+/** @brief Constructor */
+MeterValuesBuilder::MeterValuesBuilder(size_t connectors_count, unsigned int precision)
+    : m_precision(std::min(precision, MAX_PRECISION)), m_mutex(), m_entries(connectors_count), m_samples(connectors_count)
+{
+}
+
+/** @brief Destructor */
+MeterValuesBuilder::~MeterValuesBuilder() { }
+
+/** @brief Get all the measurands supported by the builder */
+std::vector<MeterValuesBuilder::MeasurandPhase> MeterValuesBuilder::supportedMeasurands()
+{
+    const Measurand measurands[] = {Measurand::EnergyActiveImportRegister,
+                                    Measurand::EnergyActiveExportRegister,
+                                    Measurand::EnergyReactiveImportRegister,
+                                    Measurand::EnergyReactiveExportRegister,
+                                    Measurand::PowerActiveImport,
+                                    Measurand::PowerActiveExport,
+                                    Measurand::PowerReactiveImport,
+                                    Measurand::PowerReactiveExport,
+                                    Measurand::PowerFactor,
+                                    Measurand::PowerOffered,
+                                    Measurand::CurrentImport,
+                                    Measurand::CurrentExport,
+                                    Measurand::CurrentOffered,
+                                    Measurand::Voltage,
+                                    Measurand::Frequency,
+                                    Measurand::SoC,
+                                    Measurand::Temperature};
+    std::vector<MeasurandPhase> supported;
+    for (const Measurand& measurand : measurands)
+    {
+        supported.emplace_back(measurand, Optional<Phase>());
+    }
+    return supported;
+}
+
+/** @brief Add the sampled values of a measurand to a meter value */
+bool MeterValuesBuilder::build(unsigned int          connector_id,
+                               const ConnectorData&  connector,
+                               const MeasurandPhase& measurand,
+                               MeterValue&           meter_value)
+{
+    bool ret = false;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if ((connector_id != 0) && (connector_id <= m_entries.size()))
+    {
+        // The stack fills a meter value with one call per measurand : a new sample instant starts
+        // with the first sampled value of a meter value
+        Sample& sample = m_samples[connector_id - 1u];
+        if ((sample.meter_value != &meter_value) || meter_value.sampledValue.empty())
+        {
+            capture(sample, connector, meter_value);
+        }
+        ret = addSampledValues(m_entries[connector_id - 1u], sample, measurand, meter_value);
+    }
+
+    return ret;
+}
+
+/** @brief Add the sampled values of a list of measurands to a meter value */
+bool MeterValuesBuilder::build(unsigned int                       connector_id,
+                               const ConnectorData&               connector,
+                               const std::vector<MeasurandPhase>& measurands,
+                               MeterValue&                        meter_value)
+{
+    bool ret = false;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if ((connector_id != 0) && (connector_id <= m_entries.size()))
+    {
+        // Single capture for all the measurands, the sample of the stack is left untouched
+        Sample sample;
+        capture(sample, connector, meter_value);
+        meter_value.sampledValue.reserve(meter_value.sampledValue.size() + measurands.size() * MeterSnapshot::MAX_PHASES);
+        for (const MeasurandPhase& measurand : measurands)
+        {
+            ret = addSampledValues(m_entries[connector_id - 1u], sample, measurand, meter_value) || ret;
+        }
+    }
+
+    return ret;
+}
+
+/** @brief Capture the values of a connector */
+void MeterValuesBuilder::capture(Sample& sample, const ConnectorData& connector, const ocpp::types::MeterValue& meter_value)
+{
+    sample.meter_value = &meter_value;
+    sample.meter       = connector.meter->getSnapshot();
+    sample.setpoint    = connector.setpoint;
+    sample.soc         = connector.ev_soc;
+}
+
+/** @brief Add the sampled values of a measurand from a captured sample */
+bool MeterValuesBuilder::addSampledValues(std::vector<Entry>&      entries,
+                                          const Sample&            sample,
+                                          const MeasurandPhase&    measurand,
+                                          ocpp::types::MeterValue& meter_value)
+{
+    // Cache slot of the requested phase, the phases which can not be measured share the last slot
+    size_t slot = MeterSnapshot::MAX_PHASES;
+    if (measurand.second.isSet())
+    {
+        slot = static_cast<size_t>(measurand.second.value());
+        if (slot >= MeterSnapshot::MAX_PHASES)
+        {
+            slot = MeterSnapshot::MAX_PHASES + 1u;
+        }
+    }
+    size_t index = static_cast<size_t>(measurand.first) * PHASE_SLOTS + slot;
+
+    // Look for the templates, they are built on the first sample of the measurand
+    const MeterSnapshot& meter = sample.meter;
+    if (index >= entries.size())
+    {
+        entries.resize(index + 1u);
+    }
+    Entry& entry = entries[index];
+    if (!entry.built)
+    {
+        buildEntry(entry, meter, measurand);
+    }
+
+    // Consistent values for all the sampled values of the sample instant
+    if (entry.supported)
+    {
+        for (const Template& sampled_template : entry.templates)
+        {
+            // The state of charge is only known while a vehicle is simulated
+            if ((sampled_template.field != Field::SOC) || (sample.soc >= 0.f))
+            {
+                meter_value.sampledValue.push_back(sampled_template.value);
+                std::string& value = meter_value.sampledValue.back().value;
+                unsigned int phase = sampled_template.phase;
+                switch (sampled_template.field)
+                {
+                    case Field::CURRENT:
+                        value = format(meter.consumptions[phase]);
+                        break;
+                    case Field::CURRENT_EXPORT:
+                        value = format(std::max(-meter.consumptions[phase], 0.f));
+                        break;
+                    case Field::CURRENT_OFFERED:
+                    case Field::POWER_OFFERED:
+                        value = format(static_cast<int64_t>(static_cast<unsigned int>(sample.setpoint)));
+                        break;
+                    case Field::ENERGY:
+                        value = format(meter.energy);
+                        break;
+                    case Field::ENERGY_EXPORT:
+                        value = format(meter.energy_export);
+                        break;
+                    case Field::REACTIVE_ENERGY:
+                        value = format(meter.reactive_energy);
+                        break;
+                    case Field::REACTIVE_ENERGY_EXPORT:
+                        value = format(meter.reactive_energy_export);
+                        break;
+                    case Field::POWER:
+                        value = format(meter.powers[phase]);
+                        break;
+                    case Field::POWER_EXPORT:
+                        value = format(std::max(-meter.powers[phase], 0.f));
+                        break;
+                    case Field::REACTIVE_POWER:
+                        value = format(std::max(meter.reactive_powers[phase], 0.f));
+                        break;
+                    case Field::REACTIVE_POWER_EXPORT:
+                        value = format(std::max(-meter.reactive_powers[phase], 0.f));
+                        break;
+                    case Field::POWER_FACTOR:
+                        value = format(meter.power_factor);
+                        break;
+                    case Field::VOLTAGE:
+                        value = format(meter.voltages[phase]);
+                        break;
+                    case Field::FREQUENCY:
+                        value = format(meter.frequency);
+                        break;
+                    case Field::SOC:
+                        value = format(sample.soc * 100.f);
+                        break;
+                    case Field::TEMPERATURE:
+                    default:
+                        value = format(meter.temperature);
+                        break;
+                }
+            }
+        }
+    }
+
+    return entry.supported;
+}
+
+/** @brief Build the templates of a measurand */
+void MeterValuesBuilder::buildEntry(Entry& entry, const MeterSnapshot& meter, const MeasurandPhase& measurand)
+{
+    entry.built     = true;
+    entry.supported = true;
+    entry.templates.clear();
+
+    // Per phase measurands : the requested phase or all the phases of the meter
+    auto add_phases = [&entry, &meter, &measurand](Field field, UnitOfMeasure unit)
+    {
+        Template sampled_template;
+        sampled_template.field              = field;
+        sampled_template.value.measurand    = measurand.first;
+        sampled_template.value.unit.value() = unit;
+        if (measurand.second.isSet())
+        {
+            unsigned int phase = static_cast<unsigned int>(measurand.second.value());
+            if (phase < meter.phases)
+            {
+                sampled_template.phase       = phase;
+                sampled_template.value.phase = static_cast<Phase>(phase);
+                entry.templates.push_back(sampled_template);
+            }
+            else
+            {
+                entry.supported = false;
+            }
+        }
+        else
+        {
+            for (unsigned int i = 0; i < meter.phases; i++)
+            {
+                sampled_template.phase       = i;
+                sampled_template.value.phase = static_cast<Phase>(i);
+                entry.templates.push_back(sampled_template);
+            }
+        }
+    };
+
+    // Single value measurands
+    auto add_value = [&entry, &measurand](Field field, const Optional<UnitOfMeasure>& unit, const Optional<Location>& location)
+    {
+        Template sampled_template;
+        sampled_template.field           = field;
+        sampled_template.phase           = 0;
+        sampled_template.value.measurand = measurand.first;
+        sampled_template.value.unit      = unit;
+        sampled_template.value.location  = location;
+        entry.templates.push_back(sampled_template);
+    };
+
+    // Powers : only first value for DC when no phase is requested
+    auto add_powers = [&add_phases, &add_value, &meter, &measurand](Field field, UnitOfMeasure unit)
+    {
+        if (!measurand.second.isSet() && (meter.type == ConnectorData::ConnectorType::DC))
+        {
+            add_value(field, unit, Optional<Location>());
+        }
+        else
+        {
+            add_phases(field, unit);
+        }
+    };
+
+    switch (measurand.first)
+    {
+        case Measurand::CurrentImport:
+            add_phases(Field::CURRENT, UnitOfMeasure::A);
+            break;
+
+        case Measurand::CurrentExport:
+            add_phases(Field::CURRENT_EXPORT, UnitOfMeasure::A);
+            break;
+
+        case Measurand::CurrentOffered:
+            add_value(Field::CURRENT_OFFERED, UnitOfMeasure::A, Optional<Location>());
+            break;
+
+        case Measurand::PowerOffered:
+            add_value(Field::POWER_OFFERED, UnitOfMeasure::W, Optional<Location>());
+            break;
+
+        case Measurand::EnergyActiveImportRegister:
+            add_value(Field::ENERGY, Optional<UnitOfMeasure>(), Optional<Location>());
+            break;
+
+        case Measurand::EnergyActiveExportRegister:
+            add_value(Field::ENERGY_EXPORT, UnitOfMeasure::Wh, Optional<Location>());
+            break;
+
+        case Measurand::EnergyReactiveImportRegister:
+            add_value(Field::REACTIVE_ENERGY, UnitOfMeasure::varh, Optional<Location>());
+            break;
+
+        case Measurand::EnergyReactiveExportRegister:
+            add_value(Field::REACTIVE_ENERGY_EXPORT, UnitOfMeasure::varh, Optional<Location>());
+            break;
+
+        case Measurand::PowerActiveImport:
+            add_powers(Field::POWER, UnitOfMeasure::W);
+            break;
+
+        case Measurand::PowerActiveExport:
+            add_powers(Field::POWER_EXPORT, UnitOfMeasure::W);
+            break;
+
+        case Measurand::PowerReactiveImport:
+            add_powers(Field::REACTIVE_POWER, UnitOfMeasure::var);
+            break;
+
+        case Measurand::PowerReactiveExport:
+            add_powers(Field::REACTIVE_POWER_EXPORT, UnitOfMeasure::var);
+            break;
+
+        case Measurand::PowerFactor:
+            add_value(Field::POWER_FACTOR, Optional<UnitOfMeasure>(), Optional<Location>());
+            break;
+
+        case Measurand::Voltage:
+            add_phases(Field::VOLTAGE, UnitOfMeasure::V);
+            break;
+
+        case Measurand::Frequency:
+            add_value(Field::FREQUENCY, Optional<UnitOfMeasure>(), Optional<Location>());
+            break;
+
+        case Measurand::SoC:
+            add_value(Field::SOC, UnitOfMeasure::Percent, Location::EV);
+            break;
+
+        case Measurand::Temperature:
+            add_value(Field::TEMPERATURE, UnitOfMeasure::Celsius, Location::Body);
+            break;
+
+        default:
+            entry.supported = false;
+            break;
+    }
+}
+
+/** @brief Format a floating point value */
+std::string MeterValuesBuilder::format(float value) const
+{
+    // Locale independent, the buffer fits the largest floats with the maximum precision
+    char buffer[64u];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed, static_cast<int>(m_precision));
+    return std::string(buffer, result.ptr);
+}
+
+/** @brief Format an integer value */
+std::string MeterValuesBuilder::format(int64_t value)
+{
+    char buffer[24u];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    return std::string(buffer, result.ptr);
+}
@@ -0,0 +1,171 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef METERVALUESBUILDER_H
+#define METERVALUESBUILDER_H
+
+#include "ConnectorData.h"
+#include "MeterSnapshot.h"
+
+#include <openocpp/IChargePoint.h>
+
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/** @brief Build the sampled values of the meters from pre-populated templates cached for each connector and measurand,
+ *         only the values are formatted on each sample and all the measurands of a sample are taken from a single snapshot */
+class MeterValuesBuilder
+{
+  public:
+    /** @brief Maximum number of decimals of the formatted values */
+    static constexpr unsigned int MAX_PRECISION = 9u;
+
+    /** @brief Measurand with an optional phase */
+    using MeasurandPhase = std::pair<ocpp::types::Measurand, ocpp::types::Optional<ocpp::types::Phase>>;
+
+    /**
+     * @brief Constructor
+     * @param connectors_count Number of connectors
+     * @param precision Number of decimals of the formatted values (limited to MAX_PRECISION)
+     */
+    MeterValuesBuilder(size_t connectors_count, unsigned int precision);
+
+    /** @brief Destructor */
+    virtual ~MeterValuesBuilder();
+
+    /** @brief Get all the measurands supported by the builder */
+    static std::vector<MeasurandPhase> supportedMeasurands();
+
+    /**
+     * @brief Add the sampled values of a measurand to a meter value, the values of the connector are captured
+     *        when the first sampled value is added to the meter value and then shared by all its measurands
+     * @param connector_id Id of the connector (starting at 1)
+     * @param connector Connector
+     * @param measurand Measurand and optional phase
+     * @param meter_value Meter value to fill
+     * @return true if the measurand is supported by the connector, false otherwise
+     */
+    bool build(unsigned int             connector_id,
+               const ConnectorData&     connector,
+               const MeasurandPhase&    measurand,
+               ocpp::types::MeterValue& meter_value);
+
+    /**
+     * @brief Add the sampled values of a list of measurands to a meter value, the values of the connector are captured once
+     * @param connector_id Id of the connector (starting at 1)
+     * @param connector Connector
+     * @param measurands Measurands and optional phases
+     * @param meter_value Meter value to fill
+     * @return true if at least one of the measurands is supported by the connector, false otherwise
+     */
+    bool build(unsigned int                       connector_id,
+               const ConnectorData&               connector,
+               const std::vector<MeasurandPhase>& measurands,
+               ocpp::types::MeterValue&           meter_value);
+
+  private:
+    /** @brief Value of the connector reported by a sampled value */
+    enum class Field
+    {
+        CURRENT,
+        CURRENT_EXPORT,
+        CURRENT_OFFERED,
+        POWER_OFFERED,
+        ENERGY,
+        ENERGY_EXPORT,
+        REACTIVE_ENERGY,
+        REACTIVE_ENERGY_EXPORT,
+        POWER,
+        POWER_EXPORT,
+        REACTIVE_POWER,
+        REACTIVE_POWER_EXPORT,
+        POWER_FACTOR,
+        VOLTAGE,
+        FREQUENCY,
+        SOC,
+        TEMPERATURE
+    };
+
+    /** @brief Pre-populated sampled value */
+    struct Template
+    {
+        /** @brief Sampled value with its measurand, unit, phase and location */
+        ocpp::types::SampledValue value;
+        /** @brief Reported value */
+        Field field;
+        /** @brief Phase of the reported value */
+        unsigned int phase;
+    };
+
+    /** @brief Cached sampled values of a measurand */
+    struct Entry
+    {
+        /** @brief Indicate if the templates have been built */
+        bool built = false;
+        /** @brief Indicate if the measurand is supported by the connector */
+        bool supported = false;
+        /** @brief Templates */
+        std::vector<Template> templates;
+    };
+
+    /** @brief Values of a connector captured for a sample instant */
+    struct Sample
+    {
+        /** @brief Meter value being filled */
+        const ocpp::types::MeterValue* meter_value = nullptr;
+        /** @brief Snapshot of the meter */
+        MeterSnapshot meter;
+        /** @brief Setpoint of the connector */
+        float setpoint = 0.f;
+        /** @brief State of charge of the vehicle (negative if unknown) */
+        float soc = -1.f;
+    };
+
+    /** @brief Number of decimals of the formatted values */
+    const unsigned int m_precision;
+    /** @brief Lock to protect the cache */
+    std::mutex m_mutex;
+    /** @brief Cached entries of each connector indexed by measurand and phase */
+    std::vector<std::vector<Entry>> m_entries;
+    /** @brief Current sample of each connector */
+    std::vector<Sample> m_samples;
+
+    /** @brief Capture the values of a connector */
+    static void capture(Sample& sample, const ConnectorData& connector, const ocpp::types::MeterValue& meter_value);
+    /** @brief Add the sampled values of a measurand from a captured sample */
+    bool addSampledValues(std::vector<Entry>&      entries,
+                          const Sample&            sample,
+                          const MeasurandPhase&    measurand,
+                          ocpp::types::MeterValue& meter_value);
+    /** @brief Build the templates of a measurand */
+    void buildEntry(Entry& entry, const MeterSnapshot& meter, const MeasurandPhase& measurand);
+    /** @brief Format a floating point value */
+    std::string format(float value) const;
+    /** @brief Format an integer value */
+    static std::string format(int64_t value);
+};
+
+#endif // METERVALUESBUILDER_H
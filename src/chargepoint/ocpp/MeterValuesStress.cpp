@@ -0,0 +1,177 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "MeterValuesStress.h"
+
+#include <iostream>
+#include <sstream>
+
+using namespace ocpp::types;
+
+/** @brief Constructor */
+MeterValuesStress::MeterValuesStress(std::chrono::milliseconds period,
+                                     const std::string&        measurands,
+                                     size_t                    connectors_count,
+                                     unsigned int              precision)
+    : m_period(period),
+      m_measurands(),
+      m_builder(connectors_count, precision),
+      m_mutex(),
+      m_stop_condition(),
+      m_stop(false),
+      m_thread(),
+      m_messages(0),
+      m_failures(0),
+      m_skipped_periods(0),
+      m_sampled_values(0),
+      m_build_duration(0),
+      m_send_duration(0)
+{
+    // Select the measurands among the supported ones
+    std::vector<MeterValuesBuilder::MeasurandPhase> supported = MeterValuesBuilder::supportedMeasurands();
+    if (measurands.empty())
+    {
+        m_measurands = supported;
+    }
+    else
+    {
+        std::stringstream measurands_list(measurands);
+        std::string       measurand;
+        while (std::getline(measurands_list, measurand, ','))
+        {
+            bool found = false;
+            for (const MeterValuesBuilder::MeasurandPhase& supported_measurand : supported)
+            {
+                if (MeasurandHelper.toString(supported_measurand.first) == measurand)
+                {
+                    m_measurands.push_back(supported_measurand);
+                    found = true;
+                }
+            }
+            if (!found)
+            {
+                std::cout << "MeterValues stress : unsupported measurand " << measurand << std::endl;
+            }
+        }
+    }
+}
+
+/** @brief Destructor */
+MeterValuesStress::~MeterValuesStress()
+{
+    stop();
+}
+
+/** @brief Start sending the messages */
+void MeterValuesStress::start(ocpp::chargepoint::IChargePoint& charge_point, const std::vector<ConnectorData>& connectors)
+{
+    if ((m_period.count() != 0) && !m_measurands.empty() && !m_thread.joinable())
+    {
+        std::cout << "MeterValues stress : " << m_measurands.size() << " measurands every " << m_period.count() << "ms" << std::endl;
+        m_stop   = false;
+        m_thread = std::thread(&MeterValuesStress::sendingThread, this, std::ref(charge_point), std::cref(connectors));
+    }
+}
+
+/** @brief Stop sending the messages */
+void MeterValuesStress::stop()
+{
+    if (m_thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_stop_condition.notify_all();
+        m_thread.join();
+    }
+}
+
+/** @brief Get the statistics */
+MeterValuesStress::Stats MeterValuesStress::stats() const
+{
+    Stats stats;
+    stats.period          = m_period;
+    stats.messages        = m_messages;
+    stats.failures        = m_failures;
+    stats.skipped_periods = m_skipped_periods;
+    stats.sampled_values  = m_sampled_values;
+    stats.build_duration  = std::chrono::nanoseconds(m_build_duration.load());
+    stats.send_duration   = std::chrono::nanoseconds(m_send_duration.load());
+    return stats;
+}
+
+/** @brief Sending thread */
+void MeterValuesStress::sendingThread(ocpp::chargepoint::IChargePoint& charge_point, const std::vector<ConnectorData>& connectors)
+{
+    auto next_sample = std::chrono::steady_clock::now();
+    bool stop        = false;
+    while (!stop)
+    {
+        if (charge_point.getRegistrationStatus() == RegistrationStatus::Accepted)
+        {
+            for (const ConnectorData& connector : connectors)
+            {
+                // Build the message
+                auto                    build_start = std::chrono::steady_clock::now();
+                std::vector<MeterValue> meter_values(1u);
+                MeterValue&             meter_value = meter_values.front();
+                meter_value.timestamp               = DateTime::now();
+                m_builder.build(connector.id, connector, m_measurands, meter_value);
+                for (SampledValue& sampled_value : meter_value.sampledValue)
+                {
+                    sampled_value.context = ReadingContext::SamplePeriodic;
+                }
+                auto send_start = std::chrono::steady_clock::now();
+
+                // Send the message
+                if (charge_point.sendMeterValues(connector.id, meter_values))
+                {
+                    m_messages++;
+                    m_sampled_values += meter_value.sampledValue.size();
+                }
+                else
+                {
+                    m_failures++;
+                }
+                auto send_end = std::chrono::steady_clock::now();
+                m_build_duration += std::chrono::duration_cast<std::chrono::nanoseconds>(send_start - build_start).count();
+                m_send_duration += std::chrono::duration_cast<std::chrono::nanoseconds>(send_end - send_start).count();
+            }
+        }
+
+        // Wait for the next period, the messages are sent synchronously so a slow Central System makes
+        // the sending overrun the period : the messages of a late period are sent immediately and the
+        // periods which have completely elapsed in the meantime are skipped and counted
+        next_sample += m_period;
+        auto now = std::chrono::steady_clock::now();
+        if (next_sample < now)
+        {
+            m_skipped_periods += static_cast<uint64_t>((now - next_sample) / m_period);
+            next_sample = now;
+        }
+        std::unique_lock<std::mutex> lock(m_mutex);
+        stop = m_stop_condition.wait_until(lock, next_sample, [this] { return m_stop; });
+    }
+}
@@ -0,0 +1,124 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef METERVALUESSTRESS_H
+#define METERVALUESSTRESS_H
+
+#include "ConnectorData.h"
+#include "MeterValuesBuilder.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/** @brief Send MeterValues messages with a large set of measurands for all the connectors at a period which can be
+ *         shorter than the second, to stress the ingestion of the meter values by the Central System.
+ *         The messages are sent one after the other and each one waits for its response, so the period is a best effort
+ *         floor : the rate is bounded by the response time of the Central System and the missed periods are counted */
+class MeterValuesStress
+{
+  public:
+    /** @brief Statistics */
+    struct Stats
+    {
+        /** @brief Period of the messages (0 = disabled) */
+        std::chrono::milliseconds period;
+        /** @brief Number of sent messages */
+        uint64_t messages;
+        /** @brief Number of messages which could not be sent */
+        uint64_t failures;
+        /** @brief Number of periods skipped because sending the messages of the previous period took too long */
+        uint64_t skipped_periods;
+        /** @brief Number of sampled values in the sent messages */
+        uint64_t sampled_values;
+        /** @brief Cumulated time spent in building the messages */
+        std::chrono::nanoseconds build_duration;
+        /** @brief Cumulated time spent in sending the messages (including the wait for the responses) */
+        std::chrono::nanoseconds send_duration;
+    };
+
+    /**
+     * @brief Constructor
+     * @param period Period of the messages (0 = disabled)
+     * @param measurands Comma separated list of the measurands to send (empty = all the supported measurands)
+     * @param connectors_count Number of connectors
+     * @param precision Number of decimals of the values
+     */
+    MeterValuesStress(std::chrono::milliseconds period, const std::string& measurands, size_t connectors_count, unsigned int precision);
+
+    /** @brief Destructor */
+    virtual ~MeterValuesStress();
+
+    /**
+     * @brief Start sending the messages (nothing is done if disabled)
+     * @param charge_point Charge Point sending the messages
+     * @param connectors Connectors
+     */
+    void start(ocpp::chargepoint::IChargePoint& charge_point, const std::vector<ConnectorData>& connectors);
+
+    /** @brief Stop sending the messages */
+    void stop();
+
+    /** @brief Get the statistics */
+    Stats stats() const;
+
+  private:
+    /** @brief Period of the messages */
+    const std::chrono::milliseconds m_period;
+    /** @brief Measurands to send */
+    std::vector<MeterValuesBuilder::MeasurandPhase> m_measurands;
+    /** @brief Sampled values builder */
+    MeterValuesBuilder m_builder;
+    /** @brief Lock to wait for the next period */
+    std::mutex m_mutex;
+    /** @brief Condition to wake up the sending thread on stop */
+    std::condition_variable m_stop_condition;
+    /** @brief Request to stop the sending thread */
+    bool m_stop;
+    /** @brief Sending thread */
+    std::thread m_thread;
+
+    /** @brief Number of sent messages */
+    std::atomic<uint64_t> m_messages;
+    /** @brief Number of messages which could not be sent */
+    std::atomic<uint64_t> m_failures;
+    /** @brief Number of skipped periods */
+    std::atomic<uint64_t> m_skipped_periods;
+    /** @brief Number of sampled values in the sent messages */
+    std::atomic<uint64_t> m_sampled_values;
+    /** @brief Cumulated time spent in building the messages in ns */
+    std::atomic<int64_t> m_build_duration;
+    /** @brief Cumulated time spent in sending the messages in ns */
+    std::atomic<int64_t> m_send_duration;
+
+    /** @brief Sending thread */
+    void sendingThread(ocpp::chargepoint::IChargePoint& charge_point, const std::vector<ConnectorData>& connectors);
+};
+
+#endif // METERVALUESSTRESS_H
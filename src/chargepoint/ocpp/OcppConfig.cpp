@@ -109,7 +109,24 @@ static const map<string, int> CONFIGURATION_VALUES = {
     {"FirmwareVersion", PARAM_READ}};
 
 /** @brief Constructor */
-OcppConfig::OcppConfig(ocpp::helpers::IniFile& config) : m_config(config) { }
+OcppConfig::OcppConfig(ocpp::helpers::IniFile& config) : m_config(config), m_listener(nullptr) { }
+
+/** @brief Set the value of a configuration key and notify the listener if the key is readable and its value has changed */
+void OcppConfig::setValue(const std::string& section, const std::string& key, const std::string& value)
+{
+    std::string previous = m_config.get(section, key).toString();
+    m_config.set(section, key, value);
+
+    IListener* listener = m_listener;
+    if (listener && (previous != value))
+    {
+        const auto it = CONFIGURATION_VALUES.find(key);
+        if ((it != CONFIGURATION_VALUES.end()) && ((it->second & PARAM_READ) != 0))
+        {
+            listener->ocppConfigChanged(it->first, value);
+        }
+    }
+}
 
 /** @copydoc void IOcppConfig::getConfiguration(const std::vector<ocpp::types::CiStringType<50u>>&,
  *                                              std::vector<ocpp::types::KeyValue>&,
@@ -188,11 +205,11 @@ ocpp::types::ConfigurationStatus OcppConfig::setConfiguration(const std::string&
         {
             if ((it->second & PARAM_OCPP) != 0)
             {
-                m_config.set(OCPP_PARAMS, key, value);
+                setValue(OCPP_PARAMS, key, value);
             }
             else
             {
-                m_config.set(STACK_PARAMS, key, value);
+                setValue(STACK_PARAMS, key, value);
             }
             if ((it->second & PARAM_REBOOT) != 0)
             {
@@ -28,6 +28,8 @@ SOFTWARE.
 #include <openocpp/IOcppConfig.h>
 #include <openocpp/IniFile.h>
 
+#include <atomic>
+
 /** @brief Section name for the parameters */
 static const std::string OCPP_PARAMS = "Ocpp";
 
@@ -35,11 +37,32 @@ static const std::string OCPP_PARAMS = "Ocpp";
 class OcppConfig : public ocpp::config::IOcppConfig
 {
   public:
+    /** @brief Listener of the configuration changes */
+    class IListener
+    {
+      public:
+        /** @brief Destructor */
+        virtual ~IListener() { }
+
+        /**
+         * @brief Called when the value of a readable configuration key has changed
+         * @param key Configuration key
+         * @param value New value
+         */
+        virtual void ocppConfigChanged(const std::string& key, const std::string& value) = 0;
+    };
+
     /** @brief Constructor */
     OcppConfig(ocpp::helpers::IniFile& config);
 
+    /** @brief Register the listener of the configuration changes (nullptr to unregister) */
+    void registerListener(IListener* listener) { m_listener = listener; }
+
     /** @brief Set the value of an OCPP configuration key */
-    void setConfigValue(const std::string& key, const std::string& value) { m_config.set(OCPP_PARAMS, key, value); }
+    void setConfigValue(const std::string& key, const std::string& value) { setValue(OCPP_PARAMS, key, value); }
+
+    /** @brief Set the value of a configuration key and notify the listener if the key is readable and its value has changed */
+    void setValue(const std::string& section, const std::string& key, const std::string& value);
 
     ///
     /// Generic getter
@@ -300,6 +323,8 @@ class OcppConfig : public ocpp::config::IOcppConfig
   private:
     /** @brief Configuration file */
     ocpp::helpers::IniFile& m_config;
+    /** @brief Listener of the configuration changes */
+    std::atomic<IListener*> m_listener;
 
     /** @brief Get a boolean parameter */
     bool getBool(const std::string& param) const { return m_config.get(OCPP_PARAMS, param).toBool(); }
@@ -0,0 +1,128 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/** @brief Sequence lock sharing a value between a single writer and multiple readers without blocking the readers */
+template <typename T>
+class SeqLock
+{
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock value must be trivially copyable");
+
+  public:
+    /**
+     * @brief Constructor
+     * @param value Initial value
+     */
+    SeqLock(const T& value = T()) : m_sequence(0), m_words() { write(value); }
+
+    /**
+     * @brief Store a new value (only one writer at a time)
+     * @param value Value to store
+     */
+    void store(const T& value)
+    {
+        uint64_t sequence = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(sequence + 1u, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        write(value);
+        m_sequence.store(sequence + 2u, std::memory_order_release);
+    }
+
+    /**
+     * @brief Load the current value
+     * @return Current value
+     */
+    T load() const
+    {
+        T        value;
+        uint64_t version;
+        read(value, version);
+        return value;
+    }
+
+    /**
+     * @brief Load the current value only if it has changed since the last load
+     * @param value Loaded value
+     * @param version Version of the last loaded value, updated on load
+     * @return true if a new value has been loaded, false otherwise
+     */
+    bool loadIfChanged(T& value, uint64_t& version) const
+    {
+        bool ret = false;
+        if (m_sequence.load(std::memory_order_acquire) != version)
+        {
+            read(value, version);
+            ret = true;
+        }
+        return ret;
+    }
+
+  private:
+    /** @brief Number of words needed to store the value */
+    static constexpr size_t WORDS_COUNT = (sizeof(T) + sizeof(uint64_t) - 1u) / sizeof(uint64_t);
+
+    /** @brief Sequence number, odd while a write is in progress */
+    std::atomic<uint64_t> m_sequence;
+    /** @brief Value stored as atomic words so that concurrent reads are not data races */
+    std::array<std::atomic<uint64_t>, WORDS_COUNT> m_words;
+
+    /** @brief Write the value words */
+    void write(const T& value)
+    {
+        uint64_t words[WORDS_COUNT] = {};
+        std::memcpy(words, &value, sizeof(T));
+        for (size_t i = 0; i < WORDS_COUNT; i++)
+        {
+            m_words[i].store(words[i], std::memory_order_relaxed);
+        }
+    }
+
+    /** @brief Read a consistent value and its version */
+    void read(T& value, uint64_t& version) const
+    {
+        uint64_t words[WORDS_COUNT];
+        uint64_t end_sequence;
+        do
+        {
+            version = m_sequence.load(std::memory_order_acquire);
+            for (size_t i = 0; i < WORDS_COUNT; i++)
+            {
+                words[i] = m_words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            end_sequence = m_sequence.load(std::memory_order_relaxed);
+        } while (((version & 1u) != 0) || (version != end_sequence));
+        std::memcpy(&value, words, sizeof(T));
+    }
+};
+
+#endif // SEQLOCK_H
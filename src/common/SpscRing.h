@@ -0,0 +1,98 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+/** @brief Bounded lock-free ring buffer between a single producer and a single consumer */
+template <typename T, size_t N>
+class SpscRing
+{
+    static_assert(N > 0, "SpscRing capacity must not be 0");
+
+  public:
+    /** @brief Constructor */
+    SpscRing() : m_head(0), m_tail(0), m_items() { }
+
+    /**
+     * @brief Push an item (producer side)
+     * @param item Item to push
+     * @return true if the item has been pushed, false if the ring is full
+     */
+    bool push(const T& item)
+    {
+        bool   ret  = false;
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if ((head - m_tail.load(std::memory_order_acquire)) < N)
+        {
+            m_items[head % N] = item;
+            m_head.store(head + 1u, std::memory_order_release);
+            ret = true;
+        }
+        return ret;
+    }
+
+    /**
+     * @brief Pop an item (consumer side)
+     * @param item Popped item
+     * @return true if an item has been popped, false if the ring is empty
+     */
+    bool pop(T& item)
+    {
+        bool   ret  = false;
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail != m_head.load(std::memory_order_acquire))
+        {
+            item = std::move(m_items[tail % N]);
+            m_tail.store(tail + 1u, std::memory_order_release);
+            ret = true;
+        }
+        return ret;
+    }
+
+    /** @brief Indicate if the ring is empty (consumer side) */
+    bool empty() const { return (m_tail.load(std::memory_order_relaxed) == m_head.load(std::memory_order_acquire)); }
+
+    /** @brief Discard all the items (consumer side) */
+    void clear()
+    {
+        T item;
+        while (pop(item)) { }
+    }
+
+  private:
+    /** @brief Index of the next item to push */
+    std::atomic<size_t> m_head;
+    /** @brief Index of the next item to pop */
+    std::atomic<size_t> m_tail;
+    /** @brief Items */
+    std::array<T, N> m_items;
+};
+
+#endif // SPSCRING_H
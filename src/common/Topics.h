@@ -37,7 +37,16 @@ SOFTWARE.
 /** @brief Topic for launcher command messages */
 #define LAUNCHER_CMD_TOPIC LAUNCHER_TOPIC "cmd"
 
+/** @brief Topic for launcher command messages load balanced between the launchers of a group */
+#define LAUNCHER_SHARED_CMD_TOPIC LAUNCHER_TOPIC "shared_cmd"
+
+/** @brief Default topic for the replies to the launcher commands */
+#define LAUNCHER_REPLY_TOPIC LAUNCHER_TOPIC "reply"
+
 /** @brief Topic for launcher status messages */
 #define LAUNCHER_STATUS_TOPIC LAUNCHER_TOPIC "status"
 
+/** @brief Topic for MQTT gateways messages */
+#define GATEWAYS_TOPIC ROOT_TOPIC "gateways/"
+
 #endif // TOPICS_H
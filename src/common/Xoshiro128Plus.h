@@ -0,0 +1,160 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef XOSHIRO128PLUS_H
+#define XOSHIRO128PLUS_H
+
+#include <cstddef>
+#include <cstdint>
+
+/** @brief Seedable xoshiro128+ pseudo random generator running independent streams in parallel lanes
+ *         so that the generation of a batch of numbers can be vectorized by the compiler */
+template <size_t LANES = 8u>
+class Xoshiro128Plus
+{
+    static_assert(LANES != 0, "Xoshiro128Plus needs at least one lane");
+
+  public:
+    /**
+     * @brief Constructor
+     * @param seed Seed, the same seed always gives the same sequence
+     */
+    Xoshiro128Plus(uint64_t seed = 0) { this->seed(seed); }
+
+    /**
+     * @brief Restart the sequence from a seed
+     * @param seed Seed
+     */
+    void seed(uint64_t seed)
+    {
+        // Expand the seed with splitmix64 as recommended by the authors of xoshiro
+        for (size_t i = 0; i < LANES; i++)
+        {
+            uint64_t low  = splitMix64(seed);
+            uint64_t high = splitMix64(seed);
+            m_s0[i]       = static_cast<uint32_t>(low);
+            m_s1[i]       = static_cast<uint32_t>(low >> 32u);
+            m_s2[i]       = static_cast<uint32_t>(high);
+            m_s3[i]       = static_cast<uint32_t>(high >> 32u);
+            if ((m_s0[i] | m_s1[i] | m_s2[i] | m_s3[i]) == 0)
+            {
+                // The all zero state is a fixed point
+                m_s0[i] = 1u;
+            }
+        }
+        m_index = LANES;
+    }
+
+    /**
+     * @brief Fill a buffer with uniform numbers in [-1, 1[
+     * @param values Buffer to fill
+     * @param count Number of values
+     */
+    void fill(float* values, size_t count)
+    {
+        size_t blocks = count / LANES;
+        generate(values, blocks);
+        for (size_t i = blocks * LANES; i < count; i++)
+        {
+            values[i] = uniform();
+        }
+    }
+
+    /** @brief Get a uniform number in [-1, 1[ */
+    float uniform()
+    {
+        if (m_index == LANES)
+        {
+            generate(m_buffer, 1u);
+            m_index = 0;
+        }
+        return m_buffer[m_index++];
+    }
+
+  private:
+    /** @brief States of the lanes */
+    uint32_t m_s0[LANES];
+    /** @brief States of the lanes */
+    uint32_t m_s1[LANES];
+    /** @brief States of the lanes */
+    uint32_t m_s2[LANES];
+    /** @brief States of the lanes */
+    uint32_t m_s3[LANES];
+    /** @brief Values generated for the single draws */
+    float m_buffer[LANES];
+    /** @brief Index of the next single draw in the buffer */
+    size_t m_index;
+
+    /** @brief Generate blocks of one value per lane, the state is kept in local arrays so that the loop can be vectorized */
+    void generate(float* values, size_t blocks)
+    {
+        uint32_t s0[LANES];
+        uint32_t s1[LANES];
+        uint32_t s2[LANES];
+        uint32_t s3[LANES];
+        for (size_t i = 0; i < LANES; i++)
+        {
+            s0[i] = m_s0[i];
+            s1[i] = m_s1[i];
+            s2[i] = m_s2[i];
+            s3[i] = m_s3[i];
+        }
+        for (size_t block = 0; block < blocks; block++)
+        {
+            float* block_values = &values[block * LANES];
+            for (size_t i = 0; i < LANES; i++)
+            {
+                uint32_t result = s0[i] + s3[i];
+                uint32_t t      = s1[i] << 9u;
+                s2[i] ^= s0[i];
+                s3[i] ^= s1[i];
+                s1[i] ^= s2[i];
+                s0[i] ^= s3[i];
+                s2[i] ^= t;
+                s3[i] = (s3[i] << 11u) | (s3[i] >> 21u);
+
+                // The upper bits have the best quality, 24 bits fill the mantissa of a float
+                block_values[i] = static_cast<float>(static_cast<int32_t>(result) >> 8) * (1.f / 8388608.f);
+            }
+        }
+        for (size_t i = 0; i < LANES; i++)
+        {
+            m_s0[i] = s0[i];
+            m_s1[i] = s1[i];
+            m_s2[i] = s2[i];
+            m_s3[i] = s3[i];
+        }
+    }
+
+    /** @brief Generate the next value of a splitmix64 sequence */
+    static uint64_t splitMix64(uint64_t& state)
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z          = (z ^ (z >> 30u)) * 0xBF58476D1CE4E5B9ull;
+        z          = (z ^ (z >> 27u)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31u);
+    }
+};
+
+#endif // XOSHIRO128PLUS_H
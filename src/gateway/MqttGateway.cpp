@@ -0,0 +1,861 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "MqttGateway.h"
+#include "MqttTopicRouter.h"
+#include "Topics.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/** @brief Upper bound of the delay before the first reconnection attempt to the broker */
+static constexpr std::chrono::milliseconds BROKER_RECONNECT_BASE_DELAY = std::chrono::milliseconds(500);
+
+/** @brief Maximum delay between 2 reconnection attempts to the broker */
+static constexpr std::chrono::seconds BROKER_RECONNECT_MAX_DELAY = std::chrono::seconds(30);
+
+/** @brief Maximum number of reconnection attempts per second for all the clients of the host */
+static constexpr unsigned int HOST_RECONNECT_RATE = 50u;
+
+/** @brief Poll period */
+static constexpr int POLL_PERIOD_MS = 500;
+
+/** @brief Maximum size of the data waiting to be sent to a local client, a client which does not read fast enough is disconnected */
+static constexpr size_t MAX_SESSION_BUFFER_SIZE = 4u * 1024u * 1024u;
+
+/** @brief Time during which the persistent session of a disconnected local client is kept */
+static constexpr std::chrono::hours PARKED_SESSION_EXPIRY = std::chrono::hours(1);
+
+/** @brief Maximum number of cached retained messages, the oldest ones are forgotten beyond */
+static constexpr size_t MAX_RETAINED_MESSAGES = 100000u;
+
+/** @brief Constructor */
+MqttGateway::MqttGateway(const std::string& id, const std::string& broker_url, const std::string& socket_path)
+    : m_id(id),
+      m_broker_url(broker_url),
+      m_socket_path(socket_path),
+      m_end(false),
+      m_connection_lost(false),
+      m_reconnect(BROKER_RECONNECT_BASE_DELAY, BROKER_RECONNECT_MAX_DELAY, HOST_RECONNECT_RATE),
+      m_status_topic(GATEWAYS_TOPIC + id + "/status"),
+      m_mqtt(IMqttClient::create(id, broker_url)),
+      m_listen_socket(-1),
+      m_wakeup_pipe{-1, -1},
+      m_mutex(),
+      m_sessions(),
+      m_parked_sessions(),
+      m_cp_sessions(),
+      m_global_sessions(),
+      m_broker_filters(),
+      m_retained(),
+      m_retained_order(),
+      m_shared_counters(),
+      m_pending()
+{
+    m_mqtt->registerListener(*this);
+    m_mqtt->setWill(m_status_topic, "Dead", IMqttClient::QoS::QOS_0, true);
+}
+
+/** @brief Destructor */
+MqttGateway::~MqttGateway()
+{
+    closeSessions(false);
+    if (m_listen_socket >= 0)
+    {
+        close(m_listen_socket);
+        unlink(m_socket_path.c_str());
+    }
+    for (int fd : m_wakeup_pipe)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+    }
+}
+
+/** @copydoc void IMqttClient::IListener::mqttConnectionLost() */
+void MqttGateway::mqttConnectionLost()
+{
+    m_connection_lost = true;
+    m_reconnect.connectionLost();
+}
+
+/** @copydoc void IMqttClient::IListener::mqttMessageReceived(const char*, const std::string&, IMqttClient::QoS, bool) */
+void MqttGateway::mqttMessageReceived(const char* topic, const std::string& message, IMqttClient::QoS qos, bool retained)
+{
+    mqttMessageViewReceived(topic, message, qos, retained);
+}
+
+/** @copydoc void IMqttClient::IListener::mqttMessageViewReceived(const char*, std::string_view, IMqttClient::QoS, bool) */
+void MqttGateway::mqttMessageViewReceived(const char* topic, std::string_view message, IMqttClient::QoS qos, bool retained)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Keep track of the retained messages for the next local subscribers
+    uint8_t flags = static_cast<uint8_t>(qos) & GatewayProtocol::FLAG_QOS_MASK;
+    updateRetained(topic, message, flags, retained);
+    if (retained)
+    {
+        flags |= GatewayProtocol::FLAG_RETAINED;
+    }
+
+    // Fan out to the local subscribers, the frames are only queued so that a slow client never stalls the others
+    std::string frame;
+    if (GatewayProtocol::serialize(frame, GatewayProtocol::FrameType::MESSAGE, flags, topic, message))
+    {
+        auto deliver = [this, &frame, qos](Session& session)
+        {
+            if (session.fd >= 0)
+            {
+                queueFrames(session, frame);
+            }
+            else if ((qos != IMqttClient::QoS::QOS_0) && ((session.tx_buffer.size() + frame.size()) <= MAX_SESSION_BUFFER_SIZE))
+            {
+                // Parked persistent session, only the QoS 1/2 messages are kept until the client reconnects
+                session.tx_buffer.append(frame);
+            }
+        };
+
+        // A session receives the message only once even if several of its filters match, the members of
+        // a shared subscription are only collected since a single one of them receives the message
+        std::map<std::string_view, std::vector<Session*>> shared_subscriptions;
+        const std::set<Session*>*                         cp_sessions = nullptr;
+        auto fanOut = [&](const std::set<Session*>& sessions, const std::set<Session*>* already_visited)
+        {
+            for (Session* session : sessions)
+            {
+                if (!already_visited || (already_visited->count(session) == 0))
+                {
+                    bool delivered = false;
+                    for (const std::string& filter : session->filters)
+                    {
+                        if (MqttTopicRouter::matches(filter, topic))
+                        {
+                            if (MqttTopicRouter::isShared(filter))
+                            {
+                                shared_subscriptions[filter].push_back(session);
+                            }
+                            else if (!delivered)
+                            {
+                                deliver(*session);
+                                delivered = true;
+                            }
+                        }
+                    }
+                }
+            }
+        };
+        std::string_view cp_level = chargePointLevel(topic);
+        if (!cp_level.empty())
+        {
+            auto iter = m_cp_sessions.find(std::string(cp_level));
+            if (iter != m_cp_sessions.end())
+            {
+                cp_sessions = &iter->second;
+                fanOut(*cp_sessions, nullptr);
+            }
+        }
+        fanOut(m_global_sessions, cp_sessions);
+
+        // Round robin between the members of each shared subscription, the connected members are preferred
+        for (auto& [filter, members] : shared_subscriptions)
+        {
+            auto    is_connected  = [](Session* member) { return (member->fd >= 0); };
+            auto    connected_end = std::stable_partition(members.begin(), members.end(), is_connected);
+            size_t  connected     = static_cast<size_t>(connected_end - members.begin());
+            size_t  count         = ((connected != 0) ? connected : members.size());
+            size_t& counter       = m_shared_counters[std::string(filter)];
+            deliver(*members[counter % count]);
+            counter++;
+        }
+    }
+    else
+    {
+        std::cout << "Message on " << topic << " too large to be forwarded to the local clients" << std::endl;
+    }
+}
+
+/** @brief Run the gateway until stop() is called (blocking) */
+bool MqttGateway::run()
+{
+    bool ret = false;
+
+    // Listen for local clients
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (m_socket_path.size() < sizeof(address.sun_path))
+    {
+        m_socket_path.copy(address.sun_path, m_socket_path.size());
+        unlink(m_socket_path.c_str());
+        m_listen_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+        if ((m_listen_socket >= 0) && (bind(m_listen_socket, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) == 0) &&
+            (listen(m_listen_socket, SOMAXCONN) == 0) && (pipe(m_wakeup_pipe) == 0))
+        {
+            fcntl(m_wakeup_pipe[0], F_SETFL, O_NONBLOCK);
+            fcntl(m_wakeup_pipe[1], F_SETFL, O_NONBLOCK);
+            ret = true;
+        }
+    }
+    if (ret)
+    {
+        std::cout << "Listening on " << m_socket_path << std::endl;
+
+        // Gateway loop
+        std::vector<struct pollfd> fds;
+        auto                       next_connection = m_reconnect.nextAttemptTime();
+        while (!m_end)
+        {
+            // Broker connection
+            if (m_connection_lost.exchange(false))
+            {
+                // The local clients are disconnected so that they go through their own reconnection logic
+                std::cout << "Disconnected from the broker, closing local sessions..." << std::endl;
+                closeSessions(false);
+                m_mqtt->close();
+                next_connection = m_reconnect.nextAttemptTime();
+            }
+            if (!m_mqtt->isConnected() && (std::chrono::steady_clock::now() >= next_connection))
+            {
+                m_mqtt->close();
+                bool connected = connectBroker();
+                m_reconnect.attemptDone(connected);
+                if (!connected)
+                {
+                    std::cout << "Couldn't connect to the broker, retrying..." << std::endl;
+                    next_connection = m_reconnect.nextAttemptTime();
+                }
+            }
+
+            // Wait for local clients activity, and for their sockets to be writable when frames are waiting to be sent
+            fds.clear();
+            fds.push_back({m_listen_socket, POLLIN, 0});
+            fds.push_back({m_wakeup_pipe[0], POLLIN, 0});
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                for (const auto& session : m_sessions)
+                {
+                    short events = (session.second->tx_buffer.empty() ? POLLIN : (POLLIN | POLLOUT));
+                    fds.push_back({session.first, events, 0});
+                }
+            }
+            if (poll(&fds[0], static_cast<nfds_t>(fds.size()), POLL_PERIOD_MS) > 0)
+            {
+                for (size_t i = 2u; i < fds.size(); i++)
+                {
+                    if (fds[i].revents != 0)
+                    {
+                        Session& session = *m_sessions[fds[i].fd];
+                        bool     alive   = true;
+                        if ((fds[i].revents & POLLOUT) != 0)
+                        {
+                            std::lock_guard<std::mutex> lock(m_mutex);
+                            alive = GatewayProtocol::sendAvailable(session.fd, session.tx_buffer);
+                        }
+                        if (alive && ((fds[i].revents & ~POLLOUT) != 0))
+                        {
+                            alive = readSession(session);
+                        }
+                        if (!alive)
+                        {
+                            // Abnormal disconnection, publish the will message on behalf of the client
+                            closeSession(fds[i].fd, true);
+                        }
+                    }
+                }
+                if (fds[1].revents != 0)
+                {
+                    char drain[64];
+                    while (read(m_wakeup_pipe[0], drain, sizeof(drain)) > 0) { }
+                }
+                if (fds[0].revents != 0)
+                {
+                    acceptSession();
+                }
+            }
+
+            // Disconnect the clients which can't keep up with their messages and forget the persistent sessions not resumed in time
+            closeFailedSessions();
+            expireParkedSessions();
+
+            // Publish the messages received during this cycle in a single batch
+            flushPending();
+        }
+
+        // The local clients can no longer reach the broker
+        closeSessions(true);
+        flushPending();
+        m_mqtt->publish(m_status_topic, "Dead", IMqttClient::QoS::QOS_0, true);
+        m_mqtt->close();
+    }
+    else
+    {
+        std::cout << "Unable to listen on " << m_socket_path << " : " << strerror(errno) << std::endl;
+    }
+
+    return ret;
+}
+
+/** @brief Connect to the broker */
+bool MqttGateway::connectBroker()
+{
+    bool ret = false;
+
+    std::cout << "Connecting to the broker (" << m_broker_url << ")..." << std::endl;
+    if (m_mqtt->connect(m_broker_url))
+    {
+        // Restore the broker subscriptions
+        ret = true;
+        for (const auto& filter : m_broker_filters)
+        {
+            ret = ret && m_mqtt->subscribe(filter.first, filter.second.qos);
+        }
+        if (ret)
+        {
+            m_mqtt->publish(m_status_topic, "Alive", IMqttClient::QoS::QOS_0, true);
+            std::cout << "Ready!" << std::endl;
+        }
+    }
+
+    return ret;
+}
+
+/** @brief Accept a new local client */
+void MqttGateway::acceptSession()
+{
+    int fd = accept(m_listen_socket, nullptr, nullptr);
+    if (fd >= 0)
+    {
+        std::unique_ptr<Session> session(new Session());
+        session->fd            = fd;
+        session->connected     = false;
+        session->clean_session = true;
+        session->closing       = false;
+        session->will_flags    = 0;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_sessions[fd] = std::move(session);
+    }
+}
+
+/** @brief Read and handle the frames of a local client, returns false if the client is disconnected */
+bool MqttGateway::readSession(Session& session)
+{
+    bool ret = session.reader.read(session.fd) && !session.reader.isCorrupted();
+
+    GatewayProtocol::Frame frame;
+    while (ret && session.reader.next(frame))
+    {
+        switch (frame.type)
+        {
+            case GatewayProtocol::FrameType::WILL:
+            {
+                session.will_topic   = frame.topic;
+                session.will_message = frame.payload;
+                session.will_flags   = frame.flags;
+            }
+            break;
+
+            case GatewayProtocol::FrameType::CONNECT:
+            {
+                // Accept the client only if the broker can be reached, a rejected client has no session to keep
+                session.id            = frame.topic;
+                session.connected     = m_mqtt->isConnected();
+                session.clean_session = (!session.connected || ((frame.flags & GatewayProtocol::FLAG_CLEAN_SESSION) != 0));
+                sendAck(session, frame.payload, session.connected);
+                if (session.connected)
+                {
+                    resumeSession(session);
+                }
+            }
+            break;
+
+            case GatewayProtocol::FrameType::PUBLISH:
+            {
+                if (session.connected)
+                {
+                    m_pending.push_back({std::string(frame.topic),
+                                         std::string(frame.payload),
+                                         static_cast<IMqttClient::QoS>(frame.flags & GatewayProtocol::FLAG_QOS_MASK),
+                                         ((frame.flags & GatewayProtocol::FLAG_RETAINED) != 0)});
+                }
+            }
+            break;
+
+            case GatewayProtocol::FrameType::SUBSCRIBE:
+            {
+                bool success = session.connected &&
+                               subscribe(session, frame.topic, static_cast<IMqttClient::QoS>(frame.flags & GatewayProtocol::FLAG_QOS_MASK));
+                sendAck(session, frame.payload, success);
+            }
+            break;
+
+            case GatewayProtocol::FrameType::UNSUBSCRIBE:
+            {
+                bool success = session.connected && unsubscribe(session, frame.topic);
+                sendAck(session, frame.payload, success);
+            }
+            break;
+
+            case GatewayProtocol::FrameType::DISCONNECT:
+            {
+                // Clean disconnection, discard the will message
+                session.will_topic.clear();
+                session.will_message.clear();
+                session.connected = false;
+            }
+            break;
+
+            default:
+            {
+                // Ignore frame
+            }
+            break;
+        }
+    }
+
+    return ret;
+}
+
+/** @brief Handle a subscription from a local client */
+bool MqttGateway::subscribe(Session& session, std::string_view filter, IMqttClient::QoS qos)
+{
+    bool ret = true;
+
+    // Subscribe on the broker if the covering filter is not already subscribed with at least the same QoS
+    // (must be done without holding the lock since the broker connection may be delivering messages)
+    std::string broker_filter = brokerFilter(filter);
+    auto        it            = m_broker_filters.find(broker_filter);
+    if ((it == m_broker_filters.end()) || (static_cast<int>(qos) > static_cast<int>(it->second.qos)))
+    {
+        ret = m_mqtt->subscribe(broker_filter, qos);
+        if (ret)
+        {
+            if (it == m_broker_filters.end())
+            {
+                it = m_broker_filters.emplace(broker_filter, BrokerFilter{0, qos}).first;
+            }
+            it->second.qos = qos;
+        }
+    }
+    if (ret)
+    {
+        it->second.subscribers++;
+
+        // Register the local subscription and replay the matching retained messages
+        std::lock_guard<std::mutex> lock(m_mutex);
+        session.filters.emplace_back(filter);
+        indexSession(session);
+
+        // Like MQTT 5 brokers, the retained messages are not sent on shared subscriptions
+        if (!MqttTopicRouter::isShared(filter))
+        {
+            // Only the retained topics starting with the literal part of the filter can match, the trailing
+            // separator is not part of the prefix since 'a/b/#' also matches 'a/b'
+            std::string_view prefix = filter.substr(0, filter.find_first_of("+#"));
+            if ((prefix.size() != filter.size()) && !prefix.empty() && (prefix.back() == '/'))
+            {
+                prefix.remove_suffix(1u);
+            }
+            std::string frames;
+            auto        iter = m_retained.lower_bound(prefix);
+            while ((iter != m_retained.end()) && (iter->first.compare(0, prefix.size(), prefix) == 0))
+            {
+                if (MqttTopicRouter::matches(filter, iter->first))
+                {
+                    GatewayProtocol::serialize(frames,
+                                               GatewayProtocol::FrameType::MESSAGE,
+                                               iter->second.flags | GatewayProtocol::FLAG_RETAINED,
+                                               iter->first,
+                                               iter->second.payload);
+                }
+                ++iter;
+            }
+            if (!frames.empty())
+            {
+                queueFrames(session, frames);
+            }
+        }
+    }
+
+    return ret;
+}
+
+/** @brief Handle an unsubscription from a local client */
+bool MqttGateway::unsubscribe(Session& session, std::string_view filter)
+{
+    bool ret = false;
+
+    // Remove the local subscription
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto it = session.filters.begin(); !ret && (it != session.filters.end()); ++it)
+        {
+            if (*it == filter)
+            {
+                session.filters.erase(it);
+                indexSession(session);
+                ret = true;
+            }
+        }
+    }
+
+    // Unsubscribe from the broker when the covering filter is no longer needed
+    if (ret)
+    {
+        auto it = m_broker_filters.find(brokerFilter(filter));
+        if ((it != m_broker_filters.end()) && (--it->second.subscribers == 0))
+        {
+            m_mqtt->unsubscribe(it->first);
+            m_broker_filters.erase(it);
+        }
+    }
+
+    return ret;
+}
+
+/** @brief Close a local client session, its will message is published if requested and its session is kept if persistent */
+void MqttGateway::closeSession(int fd, bool publish_will)
+{
+    auto iter = m_sessions.find(fd);
+    if (iter != m_sessions.end())
+    {
+        Session& session = *iter->second;
+
+        // Synthesize the will message of the client
+        if (publish_will && !session.will_topic.empty())
+        {
+            m_pending.push_back({session.will_topic,
+                                 session.will_message,
+                                 static_cast<IMqttClient::QoS>(session.will_flags & GatewayProtocol::FLAG_QOS_MASK),
+                                 ((session.will_flags & GatewayProtocol::FLAG_RETAINED) != 0)});
+        }
+
+        if (session.clean_session)
+        {
+            // Release the subscriptions
+            while (!session.filters.empty())
+            {
+                std::string filter = session.filters.back();
+                unsubscribe(session, filter);
+            }
+
+            // Release the session
+            std::lock_guard<std::mutex> lock(m_mutex);
+            close(fd);
+            m_sessions.erase(iter);
+        }
+        else
+        {
+            // Persistent session, the subscriptions are kept and the QoS 1/2 messages are stored
+            // until the client reconnects (the frames not yet sent on the socket are lost)
+            releaseParkedSession(session.id);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            close(fd);
+            session.fd        = -1;
+            session.connected = false;
+            session.closing   = false;
+            session.expiry    = std::chrono::steady_clock::now() + PARKED_SESSION_EXPIRY;
+            session.tx_buffer.clear();
+            m_parked_sessions[session.id] = std::move(iter->second);
+            m_sessions.erase(iter);
+        }
+    }
+}
+
+/** @brief Close all the local client sessions */
+void MqttGateway::closeSessions(bool publish_wills)
+{
+    while (!m_sessions.empty())
+    {
+        closeSession(m_sessions.begin()->first, publish_wills);
+    }
+}
+
+/** @brief Close the sessions which must be closed */
+void MqttGateway::closeFailedSessions()
+{
+    std::vector<int> failed;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& session : m_sessions)
+        {
+            if (session.second->closing)
+            {
+                failed.push_back(session.first);
+            }
+        }
+    }
+    for (int fd : failed)
+    {
+        std::cout << "Closing the session of " << m_sessions[fd]->id << " : client too slow or unreachable" << std::endl;
+        closeSession(fd, true);
+    }
+}
+
+/** @brief Resume or discard the parked persistent session of a connecting client */
+void MqttGateway::resumeSession(Session& session)
+{
+    auto it = m_parked_sessions.find(session.id);
+    if (it != m_parked_sessions.end())
+    {
+        if (session.clean_session)
+        {
+            // Clean session requested, the previous session is discarded
+            releaseParkedSession(session.id);
+        }
+        else
+        {
+            // Take over the subscriptions and the messages stored while the client was disconnected
+            std::lock_guard<std::mutex> lock(m_mutex);
+            Session&                    parked = *it->second;
+            unindexSession(parked);
+            session.filters = std::move(parked.filters);
+            indexSession(session);
+            if (!parked.tx_buffer.empty())
+            {
+                queueFrames(session, parked.tx_buffer);
+            }
+            m_parked_sessions.erase(it);
+        }
+    }
+}
+
+/** @brief Release the subscriptions of a parked session and discard it */
+void MqttGateway::releaseParkedSession(const std::string& id)
+{
+    auto it = m_parked_sessions.find(id);
+    if (it != m_parked_sessions.end())
+    {
+        Session& session = *it->second;
+        while (!session.filters.empty())
+        {
+            std::string filter = session.filters.back();
+            unsubscribe(session, filter);
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_parked_sessions.erase(it);
+    }
+}
+
+/** @brief Discard the expired parked sessions */
+void MqttGateway::expireParkedSessions()
+{
+    auto                     now = std::chrono::steady_clock::now();
+    std::vector<std::string> expired;
+    for (const auto& parked : m_parked_sessions)
+    {
+        if (parked.second->expiry <= now)
+        {
+            expired.push_back(parked.first);
+        }
+    }
+    for (const std::string& id : expired)
+    {
+        std::cout << "Persistent session of " << id << " expired" << std::endl;
+        releaseParkedSession(id);
+    }
+}
+
+/** @brief Send an acknowledge to a local client */
+void MqttGateway::sendAck(Session& session, std::string_view seq, bool success)
+{
+    std::string frame;
+    GatewayProtocol::serialize(frame, GatewayProtocol::FrameType::ACK, (success ? GatewayProtocol::FLAG_SUCCESS : 0u), "", seq);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    queueFrames(session, frame);
+}
+
+/** @brief Queue frames for a local client and send what can be sent without blocking (m_mutex must be held) */
+void MqttGateway::queueFrames(Session& session, const std::string& frames)
+{
+    if (!session.closing)
+    {
+        if (!session.tx_buffer.empty() && ((session.tx_buffer.size() + frames.size()) > MAX_SESSION_BUFFER_SIZE))
+        {
+            // The client does not read fast enough, it will be disconnected
+            session.closing = true;
+        }
+        else
+        {
+            session.tx_buffer.append(frames);
+            session.closing = !GatewayProtocol::sendAvailable(session.fd, session.tx_buffer);
+        }
+
+        // The remaining data is sent by the gateway loop once the socket is writable
+        if (session.closing || !session.tx_buffer.empty())
+        {
+            wakeUp();
+        }
+    }
+}
+
+/** @brief Wake up the gateway loop */
+void MqttGateway::wakeUp()
+{
+    // The pipe is non blocking, a full pipe means that a wake up is already pending
+    char    wakeup = 0;
+    ssize_t size   = write(m_wakeup_pipe[1], &wakeup, sizeof(wakeup));
+    (void)size;
+}
+
+/** @brief Update the fan out index of a session */
+void MqttGateway::indexSession(Session& session)
+{
+    // Remove previous entries
+    unindexSession(session);
+
+    // Add new entries
+    for (const std::string& filter : session.filters)
+    {
+        std::string_view cp_level = chargePointLevel(filter);
+        if (cp_level.empty() || (cp_level == "+") || (cp_level == "#"))
+        {
+            m_global_sessions.insert(&session);
+        }
+        else
+        {
+            m_cp_sessions[std::string(cp_level)].insert(&session);
+        }
+    }
+}
+
+/** @brief Remove a session from the fan out index */
+void MqttGateway::unindexSession(Session& session)
+{
+    m_global_sessions.erase(&session);
+    for (auto it = m_cp_sessions.begin(); it != m_cp_sessions.end();)
+    {
+        it->second.erase(&session);
+        if (it->second.empty())
+        {
+            it = m_cp_sessions.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+/** @brief Update the retained messages cache with a message received from the broker (m_mutex must be held) */
+void MqttGateway::updateRetained(const char* topic, std::string_view message, uint8_t flags, bool retained)
+{
+    // A message on a topic which has been retained is considered as an update of the retained message
+    auto it = m_retained.find(std::string_view(topic));
+    if (retained || (it != m_retained.end()))
+    {
+        if (message.empty())
+        {
+            if (it != m_retained.end())
+            {
+                m_retained_order.erase(it->second.order);
+                m_retained.erase(it);
+            }
+
+            // The status of a removed charge point is cleared, its other retained messages are no longer needed
+            std::string_view cp_level = chargePointLevel(topic);
+            size_t           cp_size  = strlen(CHARGE_POINTS_TOPIC) + cp_level.size();
+            if (!cp_level.empty() && (std::string_view(topic).substr(cp_size) == "/status"))
+            {
+                std::string prefix(topic, cp_size + 1u);
+                auto        iter = m_retained.lower_bound(prefix);
+                while ((iter != m_retained.end()) && (iter->first.compare(0, prefix.size(), prefix) == 0))
+                {
+                    m_retained_order.erase(iter->second.order);
+                    iter = m_retained.erase(iter);
+                }
+            }
+        }
+        else if (it != m_retained.end())
+        {
+            it->second.payload.assign(message);
+            it->second.flags = flags;
+        }
+        else
+        {
+            // New retained topic, the oldest one is forgotten when the cache is full
+            it               = m_retained.emplace(topic, RetainedMessage{std::string(message), flags, m_retained_order.end()}).first;
+            it->second.order = m_retained_order.insert(m_retained_order.end(), &it->first);
+            if (m_retained.size() > MAX_RETAINED_MESSAGES)
+            {
+                auto oldest = m_retained.find(*m_retained_order.front());
+                m_retained_order.pop_front();
+                m_retained.erase(oldest);
+            }
+        }
+    }
+}
+
+/** @brief Publish the pending messages on the broker */
+void MqttGateway::flushPending()
+{
+    if (!m_pending.empty())
+    {
+        if (m_mqtt->isConnected())
+        {
+            m_mqtt->publishBatch(m_pending.data(), m_pending.size());
+        }
+        m_pending.clear();
+    }
+}
+
+/** @brief Get the broker filter covering a local filter */
+std::string MqttGateway::brokerFilter(std::string_view filter)
+{
+    // The charge point id level is replaced by a single level wildcard so that
+    // all the charge points of the gateway share the same broker subscriptions
+    std::string      broker_filter(filter);
+    std::string_view cp_level = chargePointLevel(filter);
+    if (!cp_level.empty() && (cp_level != "#"))
+    {
+        broker_filter.replace(strlen(CHARGE_POINTS_TOPIC), cp_level.size(), "+");
+    }
+    return broker_filter;
+}
+
+/** @brief Get the charge point id level of a topic or filter, empty if not a charge point topic */
+std::string_view MqttGateway::chargePointLevel(std::string_view topic)
+{
+    std::string_view cp_level;
+    std::string_view prefix(CHARGE_POINTS_TOPIC);
+    if (topic.substr(0, prefix.size()) == prefix)
+    {
+        cp_level = topic.substr(prefix.size());
+        cp_level = cp_level.substr(0, cp_level.find('/'));
+    }
+    return cp_level;
+}
@@ -0,0 +1,211 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef MQTTGATEWAY_H
+#define MQTTGATEWAY_H
+
+#include "GatewayProtocol.h"
+#include "IMqttClient.h"
+#include "MqttReconnectPolicy.h"
+
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/** @brief Share a single broker connection between the local MQTT clients connected through a Unix domain socket */
+class MqttGateway : public IMqttClient::IListener
+{
+  public:
+    /**
+     * @brief Constructor
+     * @param id Unique id of the gateway
+     * @param broker_url URL of the broker
+     * @param socket_path Path of the Unix domain socket to listen on
+     */
+    MqttGateway(const std::string& id, const std::string& broker_url, const std::string& socket_path);
+
+    /** @brief Destructor */
+    virtual ~MqttGateway();
+
+    /** @copydoc void IMqttClient::IListener::mqttConnectionLost() */
+    void mqttConnectionLost() override;
+
+    /** @copydoc void IMqttClient::IListener::mqttMessageReceived(const char*, const std::string&, IMqttClient::QoS, bool) */
+    void mqttMessageReceived(const char* topic, const std::string& message, IMqttClient::QoS qos, bool retained) override;
+
+    /** @copydoc void IMqttClient::IListener::mqttMessageViewReceived(const char*, std::string_view, IMqttClient::QoS, bool) */
+    void mqttMessageViewReceived(const char* topic, std::string_view message, IMqttClient::QoS qos, bool retained) override;
+
+    /**
+     * @brief Run the gateway until stop() is called (blocking)
+     * @return true if the gateway has been stopped, false if it could not listen on its socket
+     */
+    bool run();
+
+    /** @brief Stop the gateway */
+    void stop() { m_end = true; }
+
+  private:
+    /** @brief Local client */
+    struct Session
+    {
+        /** @brief Socket (-1 for a parked persistent session) */
+        int fd;
+        /** @brief Client id */
+        std::string id;
+        /** @brief Indicate if the client is connected */
+        bool connected;
+        /** @brief Indicate if the client requested a clean session */
+        bool clean_session;
+        /** @brief Indicate that the session must be closed (send error or too much pending data) */
+        bool closing;
+        /** @brief Expiry of a parked persistent session */
+        std::chrono::steady_clock::time_point expiry;
+        /** @brief Frames waiting to be sent to the client, or QoS 1/2 messages kept for a parked session */
+        std::string tx_buffer;
+        /** @brief Will topic */
+        std::string will_topic;
+        /** @brief Will message */
+        std::string will_message;
+        /** @brief Will flags */
+        uint8_t will_flags;
+        /** @brief Topic filters */
+        std::vector<std::string> filters;
+        /** @brief Frame reader */
+        GatewayProtocol::Reader reader;
+    };
+
+    /** @brief Broker subscription */
+    struct BrokerFilter
+    {
+        /** @brief Number of local subscribers */
+        size_t subscribers;
+        /** @brief Highest QoS requested by the local subscribers */
+        IMqttClient::QoS qos;
+    };
+
+    /** @brief Retained message */
+    struct RetainedMessage
+    {
+        /** @brief Payload */
+        std::string payload;
+        /** @brief Frame flags */
+        uint8_t flags;
+        /** @brief Position in the insertion order */
+        std::list<const std::string*>::iterator order;
+    };
+
+    /** @brief Unique id */
+    std::string m_id;
+    /** @brief URL of the broker */
+    std::string m_broker_url;
+    /** @brief Path of the Unix domain socket */
+    std::string m_socket_path;
+    /** @brief Indicate the end of the gateway */
+    std::atomic<bool> m_end;
+    /** @brief Indicate that the connection to the broker has been lost */
+    std::atomic<bool> m_connection_lost;
+    /** @brief Reconnection policy of the broker connection */
+    MqttReconnectPolicy m_reconnect;
+    /** @brief Status topic of the gateway */
+    std::string m_status_topic;
+    /** @brief Broker connection */
+    std::unique_ptr<IMqttClient> m_mqtt;
+    /** @brief Listening socket */
+    int m_listen_socket;
+    /** @brief Pipe to wake up the gateway loop when data is waiting to be sent to a client */
+    int m_wakeup_pipe[2];
+
+    /** @brief Mutex to protect the sessions against the fan out from the broker connection */
+    std::mutex m_mutex;
+    /** @brief Sessions by socket */
+    std::map<int, std::unique_ptr<Session>> m_sessions;
+    /** @brief Persistent sessions of the disconnected clients by client id */
+    std::map<std::string, std::unique_ptr<Session>> m_parked_sessions;
+    /** @brief Sessions subscribed to the topics of a given charge point, by charge point id */
+    std::unordered_map<std::string, std::set<Session*>> m_cp_sessions;
+    /** @brief Sessions subscribed to topics which are not specific to a charge point */
+    std::set<Session*> m_global_sessions;
+    /** @brief Broker subscriptions */
+    std::map<std::string, BrokerFilter> m_broker_filters;
+    /** @brief Retained messages received from the broker, replayed to new local subscribers */
+    std::map<std::string, RetainedMessage, std::less<>> m_retained;
+    /** @brief Topics of the retained messages in insertion order */
+    std::list<const std::string*> m_retained_order;
+    /** @brief Round robin counters of the local shared subscriptions by filter */
+    std::unordered_map<std::string, size_t> m_shared_counters;
+    /** @brief Messages to publish on the broker at the end of the current poll cycle */
+    std::vector<IMqttClient::Message> m_pending;
+
+    /** @brief Connect to the broker */
+    bool connectBroker();
+    /** @brief Accept a new local client */
+    void acceptSession();
+    /** @brief Read and handle the frames of a local client, returns false if the client is disconnected */
+    bool readSession(Session& session);
+    /** @brief Handle a subscription from a local client */
+    bool subscribe(Session& session, std::string_view filter, IMqttClient::QoS qos);
+    /** @brief Handle an unsubscription from a local client */
+    bool unsubscribe(Session& session, std::string_view filter);
+    /** @brief Close a local client session, its will message is published if requested and its session is kept if persistent */
+    void closeSession(int fd, bool publish_will);
+    /** @brief Close all the local client sessions */
+    void closeSessions(bool publish_wills);
+    /** @brief Close the sessions which must be closed */
+    void closeFailedSessions();
+    /** @brief Resume or discard the parked persistent session of a connecting client */
+    void resumeSession(Session& session);
+    /** @brief Release the subscriptions of a parked session and discard it */
+    void releaseParkedSession(const std::string& id);
+    /** @brief Discard the expired parked sessions */
+    void expireParkedSessions();
+    /** @brief Send an acknowledge to a local client, echoing the sequence number of its request */
+    void sendAck(Session& session, std::string_view seq, bool success);
+    /** @brief Queue frames for a local client and send what can be sent without blocking (m_mutex must be held) */
+    void queueFrames(Session& session, const std::string& frames);
+    /** @brief Wake up the gateway loop */
+    void wakeUp();
+    /** @brief Update the fan out index of a session */
+    void indexSession(Session& session);
+    /** @brief Remove a session from the fan out index */
+    void unindexSession(Session& session);
+    /** @brief Update the retained messages cache with a message received from the broker (m_mutex must be held) */
+    void updateRetained(const char* topic, std::string_view message, uint8_t flags, bool retained);
+    /** @brief Publish the pending messages on the broker */
+    void flushPending();
+
+    /** @brief Get the broker filter covering a local filter */
+    static std::string brokerFilter(std::string_view filter);
+    /** @brief Get the charge point id level of a topic or filter, empty if not a charge point topic */
+    static std::string_view chargePointLevel(std::string_view topic);
+};
+
+#endif // MQTTGATEWAY_H
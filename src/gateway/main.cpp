@@ -0,0 +1,118 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "MqttGateway.h"
+
+#include <csignal>
+#include <cstring>
+#include <iostream>
+
+/** @brief Running gateway */
+static MqttGateway* s_gateway = nullptr;
+
+/** @brief Stop the gateway on termination signals */
+static void signalHandler(int signal)
+{
+    (void)signal;
+    if (s_gateway)
+    {
+        s_gateway->stop();
+    }
+}
+
+/** @brief Entry point */
+int main(int argc, char* argv[])
+{
+    // Default parameters
+    std::string gateway_id  = "cp_simu_gateway";
+    std::string broker_url  = "tcp://localhost:1883";
+    std::string socket_path = "/tmp/cp_simu_gateway.sock";
+
+    // Check parameters
+    if (argc > 1)
+    {
+        const char* param     = nullptr;
+        bool        bad_param = false;
+        argv++;
+        while ((argc != 1) && !bad_param)
+        {
+            if (strcmp(*argv, "-h") == 0)
+            {
+                bad_param = true;
+            }
+            else if ((strcmp(*argv, "-i") == 0) && (argc > 1))
+            {
+                argv++;
+                argc--;
+                gateway_id = *argv;
+            }
+            else if ((strcmp(*argv, "-b") == 0) && (argc > 1))
+            {
+                argv++;
+                argc--;
+                broker_url = *argv;
+            }
+            else if ((strcmp(*argv, "-s") == 0) && (argc > 1))
+            {
+                argv++;
+                argc--;
+                socket_path = *argv;
+            }
+            else
+            {
+                param     = *argv;
+                bad_param = true;
+            }
+
+            // Next param
+            argc--;
+            argv++;
+        }
+        if (bad_param)
+        {
+            if (param)
+            {
+                std::cout << "Invalid parameter : " << param << std::endl;
+            }
+            std::cout << "Usage : mqtt_gateway [-i gateway_id] [-b broker_url] [-s socket_path]" << std::endl;
+            std::cout << "    -i : Unique id of the gateway (Default = cp_simu_gateway)" << std::endl;
+            std::cout << "    -b : Url of the MQTT broker (Default = tcp://localhost:1883)" << std::endl;
+            std::cout << "    -s : Path of the Unix domain socket for the local clients (Default = /tmp/cp_simu_gateway.sock)" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "OCPP charge point simulator MQTT gateway" << std::endl;
+
+    // Gateway
+    MqttGateway gateway(gateway_id, broker_url, socket_path);
+    s_gateway = &gateway;
+    std::signal(SIGINT, signalHandler);
+    std::signal(SIGTERM, signalHandler);
+
+    bool ret  = gateway.run();
+    s_gateway = nullptr;
+
+    return (ret ? 0 : 1);
+}
@@ -37,166 +37,345 @@ SOFTWARE.
 #include <Windows.h>
 #endif // _MSC_VER
 
+/** @brief Decode a JSON payload */
+static bool parsePayload(std::string_view message, rapidjson::Document& payload)
+{
+    bool valid = false;
+    try
+    {
+        payload.Parse(message.data(), message.size());
+        valid = !payload.HasParseError();
+    }
+    catch (...)
+    {
+    }
+    if (!valid)
+    {
+        std::cout << "Invalid message : " << message << std::endl;
+    }
+    return valid;
+}
+
+/** @brief Check if an identifier matches a pattern with '*' (any sequence) and '?' (any character) wildcards */
+static bool matchPattern(std::string_view pattern, std::string_view id)
+{
+    size_t p          = 0;
+    size_t i          = 0;
+    size_t star       = std::string_view::npos;
+    size_t star_match = 0;
+    bool   mismatch   = false;
+    while (!mismatch && (i < id.size()))
+    {
+        if ((p < pattern.size()) && ((pattern[p] == '?') || (pattern[p] == id[i])))
+        {
+            p++;
+            i++;
+        }
+        else if ((p < pattern.size()) && (pattern[p] == '*'))
+        {
+            // Try first to match an empty sequence
+            star       = p++;
+            star_match = i;
+        }
+        else if (star != std::string_view::npos)
+        {
+            // Extend the sequence matched by the last '*'
+            p = star + 1u;
+            i = ++star_match;
+        }
+        else
+        {
+            mismatch = true;
+        }
+    }
+    while ((p < pattern.size()) && (pattern[p] == '*'))
+    {
+        p++;
+    }
+    return (!mismatch && (p == pattern.size()));
+}
+
 /** @brief Constructor */
-CommandHandler::CommandHandler(const std::string broker_url, std::filesystem::path chargepoints_dir)
-    : m_broker_url(broker_url), m_chargepoints_dir(chargepoints_dir), m_end(false), m_cp_status(), m_cp_pids()
+CommandHandler::CommandHandler(const std::string&    launcher_id,
+                               const std::string&    group,
+                               const std::string     broker_url,
+                               std::filesystem::path chargepoints_dir,
+                               IMqttClient&          mqtt,
+                               MqttReconnectPolicy&  reconnect)
+    : m_launcher_id(launcher_id),
+      m_group(group),
+      m_broker_url(broker_url),
+      m_chargepoints_dir(chargepoints_dir),
+      m_mqtt(mqtt),
+      m_reconnect(reconnect),
+      m_end(false),
+      m_cp_status(),
+      m_cp_pids(),
+      m_removed(),
+      m_remover(chargepoints_dir / ".trash"),
+      m_session_cleaner(broker_url),
+      m_router()
 {
+    // Message routes
+    m_router.addRoute(LAUNCHER_CMD_TOPIC,
+                      [this](const MqttTopicRouter::Captures&, std::string_view message) { cmdMessageReceived(message, false); });
+    m_router.addRoute(LAUNCHER_SHARED_CMD_TOPIC,
+                      [this](const MqttTopicRouter::Captures&, std::string_view message) { cmdMessageReceived(message, true); });
+    m_router.addRoute(CHARGE_POINTS_TOPIC "+/status",
+                      [this](const MqttTopicRouter::Captures& captures, std::string_view message)
+                      { statusMessageReceived(std::string(captures[0]), message); });
 }
 
 /** @brief Destructor */
 CommandHandler::~CommandHandler() { }
 
 /** @copydoc void IMqttClient::IListener::mqttConnectionLost() */
-void CommandHandler::mqttConnectionLost() { }
+void CommandHandler::mqttConnectionLost()
+{
+    m_reconnect.connectionLost();
+}
 
 /** @copydoc void IMqttClient::IListener::mqttMessageReceived(const char*, const std::string&, IMqttClient::QoS, bool) */
 void CommandHandler::mqttMessageReceived(const char* topic, const std::string& message, IMqttClient::QoS qos, bool retained)
+{
+    mqttMessageViewReceived(topic, message, qos, retained);
+}
+
+/** @copydoc void IMqttClient::IListener::mqttMessageViewReceived(const char*, std::string_view, IMqttClient::QoS, bool) */
+void CommandHandler::mqttMessageViewReceived(const char* topic, std::string_view message, IMqttClient::QoS qos, bool retained)
 {
     (void)qos;
     (void)retained;
 
-    // Decode message
-    bool                valid = false;
+    // Route message
+    if (!m_router.dispatch(topic, message))
+    {
+        std::cout << "Unexpected topic : " << topic << std::endl;
+    }
+}
+
+/** @brief Handle a message on the launcher's command topic or on the command topic shared by the launchers of the group */
+void CommandHandler::cmdMessageReceived(std::string_view message, bool shared)
+{
+    auto                received = std::chrono::steady_clock::now();
     rapidjson::Document payload;
-    try
+    if (!message.empty() && parsePayload(message, payload) && payload.IsObject() && payload.HasMember("type") &&
+        payload["type"].IsString())
     {
-        if (!message.empty())
+        std::vector<ChargePointResult> results;
+        bool                           result = false;
+        const char*                    type   = payload["type"].GetString();
+        if (shared != ((strcmp(type, "start") == 0) && !m_group.empty()))
         {
-            payload.Parse(message.c_str(), message.size());
-            valid = !payload.HasParseError();
+            // In a group, only the start commands are load balanced through the shared topic, the
+            // other commands must reach the launchers owning the charge points through the launcher's topic
+            std::cout << "Command " << type << " not allowed on this topic" << std::endl;
+            publishReply(payload, type, result, results, received);
         }
-        else
+        else if (strcmp(type, "close") == 0)
         {
-            valid = true;
+            std::cout << "Close command received" << std::endl;
+            publishReply(payload, type, true, results, received);
+            m_end = true;
+            m_reconnect.cancel();
         }
-    }
-    catch (...)
-    {
-    }
-    if (!valid)
-    {
-        std::cout << "Invalid message : " << message << std::endl;
-    }
-    else
-    {
-        // Split topic name
-        std::filesystem::path topic_path(topic);
-
-        // Check message type
-        if (topic_path.filename().compare("cmd") == 0)
+        else
         {
-            if (!message.empty() && payload.HasMember("type"))
+            if (strcmp(type, "start") == 0)
             {
-                const char* type = payload["type"].GetString();
-                if (strcmp(type, "close") == 0)
+                if (payload.HasMember("charge_points"))
                 {
-                    std::cout << "Close command received" << std::endl;
-                    m_end = true;
+                    rapidjson::Value& charge_points = payload["charge_points"];
+                    if (charge_points.IsArray())
+                    {
+                        result = startChargePoints(charge_points, true, &results);
+                    }
                 }
-                else if (strcmp(type, "start") == 0)
+            }
+            else if (strcmp(type, "kill") == 0)
+            {
+                if (payload.HasMember("charge_points"))
                 {
-                    if (payload.HasMember("charge_points"))
+                    rapidjson::Value& charge_points = payload["charge_points"];
+                    if (charge_points.IsArray())
                     {
-                        rapidjson::Value& charge_points = payload["charge_points"];
-                        if (charge_points.IsArray())
-                        {
-                            startChargePoints(charge_points, true);
-                        }
+                        result = killChargePoints(charge_points, &results);
                     }
                 }
-                else if (strcmp(type, "kill") == 0)
+            }
+            else if (strcmp(type, "restart") == 0)
+            {
+                if (payload.HasMember("charge_points"))
                 {
-                    if (payload.HasMember("charge_points"))
+                    rapidjson::Value& charge_points = payload["charge_points"];
+                    if (charge_points.IsArray())
                     {
-                        rapidjson::Value& charge_points = payload["charge_points"];
-                        if (charge_points.IsArray())
-                        {
-                            killChargePoints(charge_points);
-                        }
+                        result = startChargePoints(charge_points, false, &results);
                     }
                 }
-                else if (strcmp(type, "restart") == 0)
+            }
+            else if (strcmp(type, "remove") == 0)
+            {
+                // Explicit list and/or pattern
+                std::set<std::string> ids;
+                if (payload.HasMember("charge_points") && payload["charge_points"].IsArray())
                 {
-                    if (payload.HasMember("charge_points"))
+                    const rapidjson::Value& charge_points = payload["charge_points"];
+                    for (auto it_charge_point = charge_points.Begin(); it_charge_point != charge_points.End(); ++it_charge_point)
                     {
-                        rapidjson::Value& charge_points = payload["charge_points"];
-                        if (charge_points.IsArray())
+                        const rapidjson::Value& charge_point = *it_charge_point;
+                        if (charge_point.IsObject() && charge_point.HasMember("id") && charge_point["id"].IsString())
                         {
-                            startChargePoints(charge_points, false);
+                            ids.insert(charge_point["id"].GetString());
                         }
                     }
                 }
-                else
+                if (payload.HasMember("pattern") && payload["pattern"].IsString())
                 {
-                    std::cout << "Unknown command : " << type << std::endl;
+                    std::set<std::string> matching_ids = listChargePoints(payload["pattern"].GetString());
+                    ids.insert(matching_ids.begin(), matching_ids.end());
                 }
+                result = removeChargePoints(ids, &results);
+            }
+            else
+            {
+                std::cout << "Unknown command : " << type << std::endl;
             }
+            publishReply(payload, type, result, results, received);
         }
-        else
+    }
+}
+
+/** @brief Publish the reply to a command */
+void CommandHandler::publishReply(const rapidjson::Document&            payload,
+                                  const char*                           type,
+                                  bool                                  result,
+                                  const std::vector<ChargePointResult>& results,
+                                  std::chrono::steady_clock::time_point received)
+{
+    // Only the commands with a correlation id are acknowledged
+    if (payload.HasMember("cmd_id") && payload["cmd_id"].IsString())
+    {
+        std::string reply_topic = LAUNCHER_REPLY_TOPIC;
+        if (payload.HasMember("reply_to") && payload["reply_to"].IsString() && (payload["reply_to"].GetStringLength() != 0))
         {
-            // Charge point's status
+            reply_topic = payload["reply_to"].GetString();
+        }
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - received);
 
-            // Extract name
-            std::filesystem::path status_topic_path(topic);
-            auto                  iter = status_topic_path.end();
-            iter--;
-            iter--;
-            std::string charge_point = iter->string();
+        // Create the JSON message
+        rapidjson::Document                 msg;
+        rapidjson::Document::AllocatorType& allocator = msg.GetAllocator();
+        msg.SetObject();
+        msg.AddMember(rapidjson::StringRef("cmd_id"), rapidjson::Value(payload["cmd_id"].GetString(), allocator).Move(), allocator);
+        msg.AddMember(rapidjson::StringRef("launcher"), rapidjson::Value(m_launcher_id.c_str(), allocator).Move(), allocator);
+        msg.AddMember(rapidjson::StringRef("type"), rapidjson::Value(type, allocator).Move(), allocator);
+        msg.AddMember(rapidjson::StringRef("result"), rapidjson::Value(result), allocator);
+        msg.AddMember(rapidjson::StringRef("duration_us"), rapidjson::Value(static_cast<int64_t>(duration.count())), allocator);
+        rapidjson::Value charge_points(rapidjson::kArrayType);
+        for (const ChargePointResult& cp_result : results)
+        {
+            rapidjson::Value charge_point(rapidjson::kObjectType);
+            charge_point.AddMember(rapidjson::StringRef("id"), rapidjson::Value(cp_result.id.c_str(), allocator).Move(), allocator);
+            charge_point.AddMember(rapidjson::StringRef("result"), rapidjson::StringRef(cp_result.result), allocator);
+            charge_point.AddMember(
+                rapidjson::StringRef("duration_us"), rapidjson::Value(static_cast<int64_t>(cp_result.duration.count())), allocator);
+            charge_points.PushBack(charge_point, allocator);
+        }
+        msg.AddMember(rapidjson::StringRef("charge_points"), charge_points, allocator);
 
-            // Extract status
-            if (!message.empty() && payload.HasMember("status"))
-            {
-                // Save status
-                m_cp_status[charge_point] = (strcmp("Dead", payload["status"].GetString()) != 0);
-                if (m_cp_status[charge_point])
-                {
-                    m_cp_pids[charge_point] = payload["pid"].GetUint64();
-                }
+        rapidjson::StringBuffer                    buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+        msg.Accept(writer);
 
-                std::cout << "[" << charge_point << "] - " << message << std::endl;
-            }
-            else
-            {
-                // Check remove status
-                if (message.empty())
-                {
-                    // Remove charge point
-                    m_cp_status.erase(charge_point);
-                    m_cp_pids.erase(charge_point);
+        // Called from the reception callback : QoS 0 to not wait for an acknowledge of the broker
+        m_mqtt.publish(reply_topic, buffer.GetString(), IMqttClient::QoS::QOS_0, false);
+    }
+}
 
-                    // Clear working directory
-                    std::filesystem::path chargepoint_dir(m_chargepoints_dir);
-                    chargepoint_dir /= charge_point;
-                    std::filesystem::remove_all(chargepoint_dir);
+/** @brief Handle a message on the status topic of a charge point */
+void CommandHandler::statusMessageReceived(const std::string& charge_point, std::string_view message)
+{
+    // Check remove status
+    if (message.empty())
+    {
+        // Remove charge point
+        m_cp_status.erase(charge_point);
+        m_cp_pids.erase(charge_point);
 
-                    std::cout << "[" << charge_point << "] - Removed!" << std::endl;
+        // Clear working directory, already done by the remove command or stored on another launcher
+        if ((m_removed.find(charge_point) == m_removed.end()) && isOwned(charge_point))
+        {
+            m_remover.remove(m_chargepoints_dir / charge_point);
+            std::cout << "[" << charge_point << "] - Removed!" << std::endl;
+        }
+    }
+    else
+    {
+        // Extract status
+        rapidjson::Document payload;
+        if (parsePayload(message, payload))
+        {
+            if (payload.HasMember("status"))
+            {
+                const char* status = payload["status"].GetString();
+                if ((m_removed.find(charge_point) != m_removed.end()) && (strcmp("Dead", status) == 0))
+                {
+                    // Will message published after the removal, clear it again
+                    std::string status_topic = CHARGE_POINTS_TOPIC + charge_point + "/status";
+                    m_mqtt.publish(status_topic, "", IMqttClient::QoS::QOS_0, true);
                 }
                 else
                 {
-                    std::cout << "Invalid status : " << message << std::endl;
+                    // Save status
+                    m_removed.erase(charge_point);
+                    m_cp_status[charge_point] = (strcmp("Dead", status) != 0);
+                    if (m_cp_status[charge_point])
+                    {
+                        m_cp_pids[charge_point] = payload["pid"].GetUint64();
+                    }
+
+                    std::cout << "[" << charge_point << "] - " << status << std::endl;
                 }
             }
+            else
+            {
+                std::cout << "Invalid status : " << message << std::endl;
+            }
         }
     }
 }
 
 /** @brief Start simulated charge points */
-bool CommandHandler::startChargePoints(const rapidjson::Value& charge_points, bool clean_env)
+bool CommandHandler::startChargePoints(const rapidjson::Value&         charge_points,
+                                       bool                            clean_env,
+                                       std::vector<ChargePointResult>* results)
 {
     unsigned int total_count   = 0;
     unsigned int total_started = 0;
 
     for (auto it_charge_point = charge_points.Begin(); it_charge_point != charge_points.End(); ++it_charge_point)
     {
+        auto        start  = std::chrono::steady_clock::now();
+        const char* result = "invalid";
+        std::string id;
+        bool        handled = true;
+
         // Check charge point parameters
         const rapidjson::Value& charge_point = *it_charge_point;
-        if (charge_point.HasMember("id") && charge_point.HasMember("vendor") && charge_point.HasMember("type") && charge_point.HasMember("model") &&
-            charge_point.HasMember("serial") && charge_point.HasMember("max_setpoint") && charge_point.HasMember("nb_connectors") &&
-            charge_point.HasMember("max_setpoint_per_connector") && charge_point.HasMember("nb_phases") &&
-            charge_point.HasMember("central_system") && charge_point.HasMember("voltage"))
+        if (!clean_env && charge_point.IsObject() && charge_point.HasMember("id") && charge_point["id"].IsString() &&
+            !isHandled(charge_point["id"].GetString()))
+        {
+            // Restarted by the launcher owning the charge point
+            handled = false;
+        }
+        else if (charge_point.IsObject() && charge_point.HasMember("id") && charge_point.HasMember("vendor") && charge_point.HasMember("type") &&
+            charge_point.HasMember("model") && charge_point.HasMember("serial") && charge_point.HasMember("max_setpoint") &&
+            charge_point.HasMember("nb_connectors") && charge_point.HasMember("max_setpoint_per_connector") &&
+            charge_point.HasMember("nb_phases") && charge_point.HasMember("central_system") && charge_point.HasMember("voltage"))
         {
             // Extract charge point parameters
-            std::string  id                        = charge_point["id"].GetString();
+            id                                     = charge_point["id"].GetString();
             std::string  type                      = charge_point["type"].GetString();
             std::string  vendor                    = charge_point["vendor"].GetString();
             std::string  model                     = charge_point["model"].GetString();
@@ -207,16 +386,20 @@ bool CommandHandler::startChargePoints(const rapidjson::Value& charge_points, bo
             unsigned int max_setpoint              = charge_point["max_setpoint"].GetUint();
             unsigned int max_current_per_connector = charge_point["max_setpoint_per_connector"].GetUint();
             float voltage                          = charge_point["voltage"].GetFloat();
+            bool local_control = (charge_point.HasMember("local_control") && charge_point["local_control"].IsBool() &&
+                                  charge_point["local_control"].GetBool());
 
             // Check if charge point is already running
             if ((m_cp_status.find(id) == m_cp_status.end()) || !m_cp_status[id])
             {
+                m_removed.erase(id);
+
                 // Clean and (re)-create working directory
                 std::filesystem::path chargepoint_dir(m_chargepoints_dir);
                 chargepoint_dir /= id;
                 if (clean_env)
                 {
-                    std::filesystem::remove_all(chargepoint_dir);
+                    m_remover.remove(chargepoint_dir);
                     std::filesystem::create_directories(chargepoint_dir);
                 }
 
@@ -250,13 +433,22 @@ bool CommandHandler::startChargePoints(const rapidjson::Value& charge_points, bo
                 cmd << " -m " << max_setpoint;
                 cmd << " -i " << max_current_per_connector;
                 cmd << " -e " << type;
+                if (local_control)
+                {
+                    cmd << " -l \"" << (chargepoint_dir / "control.sock").string() << "\"";
+                }
 #ifndef _MSC_VER
                 cmd << " &" << std::endl;
 #endif // _MSC_VER
 
                 // Start charge point
+                result = "failed";
 #ifndef _MSC_VER
-                system(cmd.str().c_str());
+                if (system(cmd.str().c_str()) == 0)
+                {
+                    result = "started";
+                    total_started++;
+                }
 #else // _MSC_VER
                 STARTUPINFO         si;
                 PROCESS_INFORMATION pi;
@@ -265,68 +457,222 @@ bool CommandHandler::startChargePoints(const rapidjson::Value& charge_points, bo
                 si.cb = sizeof(si);
                 ZeroMemory(&pi, sizeof(pi));
 
-                CreateProcess("chargepoint.exe",
-                              const_cast<char*>(cmd.str().c_str()),
-                              nullptr,
-                              nullptr,
-                              FALSE,
-                              NORMAL_PRIORITY_CLASS,
-                              nullptr,
-                              nullptr,
-                              &si,
-                              &pi);
-                CloseHandle(pi.hProcess);
-                CloseHandle(pi.hThread);
+                if (CreateProcess("chargepoint.exe",
+                                  const_cast<char*>(cmd.str().c_str()),
+                                  nullptr,
+                                  nullptr,
+                                  FALSE,
+                                  NORMAL_PRIORITY_CLASS,
+                                  nullptr,
+                                  nullptr,
+                                  &si,
+                                  &pi) != 0)
+                {
+                    CloseHandle(pi.hProcess);
+                    CloseHandle(pi.hThread);
+                    result = "started";
+                    total_started++;
+                }
 #endif // _MSC_VER
-                total_started++;
+            }
+            else
+            {
+                result = "running";
             }
         }
-        total_count++;
+        if (handled)
+        {
+            total_count++;
+        }
+
+        if (handled && results)
+        {
+            results->push_back(
+                {id, result, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start)});
+        }
     }
 
     return (total_started == total_count);
 }
 
 /** @brief Kill simulated charge points */
-bool CommandHandler::killChargePoints(const rapidjson::Value& charge_points)
+bool CommandHandler::killChargePoints(const rapidjson::Value& charge_points, std::vector<ChargePointResult>* results)
 {
     unsigned int total_count  = 0;
     unsigned int total_killed = 0;
 
     for (auto it_charge_point = charge_points.Begin(); it_charge_point != charge_points.End(); ++it_charge_point)
     {
+        auto        start   = std::chrono::steady_clock::now();
+        const char* result  = "invalid";
+        std::string id;
+        bool        handled = true;
+
         // Check charge point parameters
         const rapidjson::Value& charge_point = *it_charge_point;
-        if (charge_point.HasMember("id"))
+        if (charge_point.IsObject() && charge_point.HasMember("id"))
         {
-            // Look for the corresponding charge point
-            std::string id      = charge_point["id"].GetString();
-            auto        iter_cp = m_cp_pids.find(id);
-            if ((iter_cp != m_cp_pids.end()) && m_cp_status[id])
+            // Kill the corresponding charge point
+            id      = charge_point["id"].GetString();
+            handled = isHandled(id);
+            if (handled)
             {
-                // Kill charge point
-                uint64_t pid = iter_cp->second;
-#ifdef _MSC_VER
-                HANDLE chargepoint_proc = OpenProcess(PROCESS_TERMINATE, FALSE, static_cast<DWORD>(pid));
-                if (chargepoint_proc != nullptr)
-                {
-                    if (TerminateProcess(chargepoint_proc, 0) != 0)
-                    {
-                        total_killed++;
-                    }
-                    CloseHandle(chargepoint_proc);
-                }
-#else // _MSC_VER
-                int err = kill(pid, SIGKILL);
-                if (err == 0)
+                result = killChargePoint(id);
+                if (strcmp(result, "killed") == 0)
                 {
                     total_killed++;
                 }
-#endif // _MSC_VER
             }
         }
-        total_count++;
+        if (handled)
+        {
+            total_count++;
+        }
+
+        if (handled && results)
+        {
+            results->push_back(
+                {id, result, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start)});
+        }
     }
 
     return (total_killed == total_count);
 }
+
+/** @brief Remove simulated charge points : kill them, clear their retained topics and delete their working directory */
+bool CommandHandler::removeChargePoints(const std::set<std::string>& ids, std::vector<ChargePointResult>* results)
+{
+    unsigned int total_count   = 0;
+    unsigned int total_removed = 0;
+
+    std::vector<IMqttClient::Message> messages;
+    for (const std::string& id : ids)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        // Kill charge point, in a group only the launcher owning the charge point removes it
+        const char* result = "not_owned";
+        if (isHandled(id))
+        {
+            result = killChargePoint(id);
+            total_count++;
+        }
+        if ((strcmp(result, "failed") != 0) && (strcmp(result, "not_owned") != 0))
+        {
+            // Number of connectors from its configuration, before the working directory is moved away
+            std::filesystem::path  chargepoint_dir = m_chargepoints_dir / id;
+            ocpp::helpers::IniFile config((chargepoint_dir / "config.ini").string());
+            unsigned int           nb_connectors = config.get("Ocpp", "NumberOfConnectors", 1u).toUInt();
+            if (!config.get("Mqtt", "CleanSession").toBool())
+            {
+                // Discard the persistent session so that the broker does not keep queuing its commands
+                m_session_cleaner.clean(id);
+            }
+
+            // Clear the retained topics
+            std::string chargepoint_topic = CHARGE_POINTS_TOPIC + id + "/";
+            messages.push_back({chargepoint_topic + "status", "", IMqttClient::QoS::QOS_0, true});
+            messages.push_back({chargepoint_topic + "ocpp_config", "", IMqttClient::QoS::QOS_0, true});
+            messages.push_back({chargepoint_topic + "ocpp_config/delta", "", IMqttClient::QoS::QOS_0, true});
+            for (unsigned int connector_id = 1u; connector_id <= nb_connectors; connector_id++)
+            {
+                std::string connector_topic = chargepoint_topic + "connectors/" + std::to_string(connector_id) + "/status";
+                messages.push_back({connector_topic, "", IMqttClient::QoS::QOS_0, true});
+            }
+            m_cp_status.erase(id);
+            m_cp_pids.erase(id);
+            m_removed.insert(id);
+
+            // Delete the working directory in background
+            if (m_remover.remove(chargepoint_dir))
+            {
+                result = "removed";
+                total_removed++;
+            }
+            else
+            {
+                result = "failed";
+            }
+            std::cout << "[" << id << "] - Removed!" << std::endl;
+        }
+
+        if (results && (strcmp(result, "not_owned") != 0))
+        {
+            results->push_back(
+                {id, result, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start)});
+        }
+    }
+
+    // Clear all the retained topics in a single batch, called from the reception
+    // callback : QoS 0 to not wait for an acknowledge of the broker
+    size_t published = m_mqtt.publishBatch(messages.data(), messages.size());
+
+    return ((total_removed == total_count) && (published == messages.size()));
+}
+
+/** @brief List the known charge points (running or with a working directory) whose identifier matches a pattern ('*' and '?') */
+std::set<std::string> CommandHandler::listChargePoints(const std::string& pattern) const
+{
+    std::set<std::string> ids;
+
+    for (const auto& cp_status : m_cp_status)
+    {
+        if (matchPattern(pattern, cp_status.first))
+        {
+            ids.insert(cp_status.first);
+        }
+    }
+    std::error_code err;
+    for (const auto& entry : std::filesystem::directory_iterator(m_chargepoints_dir, err))
+    {
+        // Skip the trash directory
+        std::string id = entry.path().filename().string();
+        if (entry.is_directory(err) && (id[0] != '.') && matchPattern(pattern, id))
+        {
+            ids.insert(id);
+        }
+    }
+
+    return ids;
+}
+
+/** @brief Kill a simulated charge point, returns the result of the operation */
+const char* CommandHandler::killChargePoint(const std::string& id)
+{
+    const char* result = "not_running";
+
+    // Look for the corresponding charge point, its pid is only meaningful on the launcher which started it
+    auto iter_cp = m_cp_pids.find(id);
+    if ((iter_cp != m_cp_pids.end()) && m_cp_status[id] && isOwned(id))
+    {
+        // Kill charge point
+        uint64_t pid = iter_cp->second;
+        result       = "failed";
+#ifdef _MSC_VER
+        HANDLE chargepoint_proc = OpenProcess(PROCESS_TERMINATE, FALSE, static_cast<DWORD>(pid));
+        if (chargepoint_proc != nullptr)
+        {
+            if (TerminateProcess(chargepoint_proc, 0) != 0)
+            {
+                result = "killed";
+            }
+            CloseHandle(chargepoint_proc);
+        }
+#else // _MSC_VER
+        int err = kill(pid, SIGKILL);
+        if (err == 0)
+        {
+            result = "killed";
+        }
+#endif // _MSC_VER
+    }
+
+    return result;
+}
+
+/** @brief Indicate if the working directory of a charge point is on this launcher */
+bool CommandHandler::isOwned(const std::string& id) const
+{
+    std::error_code err;
+    return std::filesystem::is_directory(m_chargepoints_dir / id, err);
+}
@@ -25,19 +25,50 @@ SOFTWARE.
 #ifndef COMMANDHANDLER_H
 #define COMMANDHANDLER_H
 
+#include "DirectoryRemover.h"
 #include "IMqttClient.h"
+#include "MqttReconnectPolicy.h"
+#include "MqttTopicRouter.h"
+#include "SessionCleaner.h"
 
 #include <openocpp/json.h>
+#include <chrono>
 #include <filesystem>
 #include <map>
 #include <cstdint>
+#include <set>
+#include <vector>
 
 /** @brief Handler for incoming MQTT events */
 class CommandHandler : public IMqttClient::IListener
 {
   public:
-    /** @brief Constructor */
-    CommandHandler(const std::string broker_url, std::filesystem::path chargepoints_dir);
+    /** @brief Result of a command on a charge point */
+    struct ChargePointResult
+    {
+        /** @brief Charge point identifier */
+        std::string id;
+        /** @brief Result */
+        const char* result;
+        /** @brief Time spent to process the command */
+        std::chrono::microseconds duration;
+    };
+
+    /**
+     * @brief Constructor
+     * @param launcher_id Unique id of the launcher
+     * @param group Group of launchers sharing the start commands (empty = no group)
+     * @param broker_url URL of the broker
+     * @param chargepoints_dir Directory to store charge points data
+     * @param mqtt MQTT client
+     * @param reconnect Reconnection policy of the MQTT client
+     */
+    CommandHandler(const std::string&     launcher_id,
+                   const std::string&     group,
+                   const std::string      broker_url,
+                   std::filesystem::path  chargepoints_dir,
+                   IMqttClient&           mqtt,
+                   MqttReconnectPolicy&   reconnect);
 
     /** @brief Destructor */
     virtual ~CommandHandler();
@@ -48,26 +79,76 @@ class CommandHandler : public IMqttClient::IListener
     /** @copydoc void IMqttClient::IListener::mqttMessageReceived(const char*, const std::string&, IMqttClient::QoS, bool) */
     void mqttMessageReceived(const char* topic, const std::string& message, IMqttClient::QoS qos, bool retained) override;
 
+    /** @copydoc void IMqttClient::IListener::mqttMessageViewReceived(const char*, std::string_view, IMqttClient::QoS, bool) */
+    void mqttMessageViewReceived(const char* topic, std::string_view message, IMqttClient::QoS qos, bool retained) override;
+
     /** @brief Indicate that an end of application command has been received */
     bool isEndOfApplication() const { return m_end; }
 
-    /** @brief Start simulated charge points */
-    bool startChargePoints(const rapidjson::Value& charge_points, bool clean_env);
+    /** @brief Start simulated charge points, the result for each charge point is optionally returned */
+    bool startChargePoints(const rapidjson::Value& charge_points, bool clean_env, std::vector<ChargePointResult>* results = nullptr);
+
+    /** @brief Kill simulated charge points, the result for each charge point is optionally returned */
+    bool killChargePoints(const rapidjson::Value& charge_points, std::vector<ChargePointResult>* results = nullptr);
+
+    /**
+     * @brief Remove simulated charge points : kill them, clear their retained topics and delete their working directory
+     * @param ids Identifiers of the charge points
+     * @param results Result for each charge point (optional)
+     * @return true if all the charge points have been removed, false otherwise
+     */
+    bool removeChargePoints(const std::set<std::string>& ids, std::vector<ChargePointResult>* results = nullptr);
 
-    /** @brief Kill simulated charge points */
-    bool killChargePoints(const rapidjson::Value& charge_points);
+    /** @brief List the known charge points (running or with a working directory) whose identifier matches a pattern ('*' and '?') */
+    std::set<std::string> listChargePoints(const std::string& pattern) const;
 
   private:
+    /** @brief Unique id of the launcher */
+    const std::string m_launcher_id;
+    /** @brief Group of launchers sharing the start commands (empty = no group) */
+    const std::string m_group;
     /** @brief URL of the broker */
     const std::string m_broker_url;
     /** @brief Directory to store charge points data */
     const std::filesystem::path m_chargepoints_dir;
+    /** @brief MQTT client */
+    IMqttClient& m_mqtt;
+    /** @brief Reconnection policy of the MQTT client */
+    MqttReconnectPolicy& m_reconnect;
     /** @brief Indicate that an end of application command has been received */
     bool m_end;
     /** @brief Simulated charge points' statuses */
     std::map<std::string, bool> m_cp_status;
     /** @brief Simulated charge points' pids */
     std::map<std::string, uint64_t> m_cp_pids;
+    /** @brief Removed charge points, their late will messages are cleared */
+    std::set<std::string> m_removed;
+    /** @brief Removal of the working directories */
+    DirectoryRemover m_remover;
+    /** @brief Cleanup of the persistent MQTT sessions of the removed charge points */
+    SessionCleaner m_session_cleaner;
+    /** @brief Router for the incoming messages */
+    MqttTopicRouter m_router;
+
+    /** @brief Handle a message on the launcher's command topic or on the command topic shared by the launchers of the group */
+    void cmdMessageReceived(std::string_view message, bool shared);
+    /** @brief Handle a message on the status topic of a charge point */
+    void statusMessageReceived(const std::string& charge_point, std::string_view message);
+    /** @brief Kill a simulated charge point, returns the result of the operation */
+    const char* killChargePoint(const std::string& id);
+    /** @brief Indicate if the working directory of a charge point is on this launcher */
+    bool isOwned(const std::string& id) const;
+    /**
+     * @brief Indicate if this launcher handles the kill, restart and remove commands on a charge point :
+     *        without group all the charge points, in a group only the charge points it owns
+     */
+    bool isHandled(const std::string& id) const { return m_group.empty() || isOwned(id); }
+    /** @brief Publish the reply to a command */
+    void publishReply(const rapidjson::Document&            payload,
+                      const char*                           type,
+                      bool                                  result,
+                      const std::vector<ChargePointResult>& results,
+                      std::chrono::steady_clock::time_point received);
 };
 
 #endif // COMMANDHANDLER_H
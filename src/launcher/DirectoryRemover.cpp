@@ -0,0 +1,131 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "DirectoryRemover.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+/** @brief Constructor */
+DirectoryRemover::DirectoryRemover(const std::filesystem::path& trash_dir)
+    : m_trash_dir(trash_dir),
+      m_mutex(),
+      m_cond_var(),
+      m_stop(false),
+      m_queue(),
+      m_counter(static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch().count())),
+      m_thread()
+{
+    // Remove the content left by a previous run
+    std::error_code err;
+    if (std::filesystem::exists(m_trash_dir, err))
+    {
+        for (const auto& entry : std::filesystem::directory_iterator(m_trash_dir, err))
+        {
+            m_queue.push_back(entry.path());
+        }
+    }
+    else
+    {
+        std::filesystem::create_directories(m_trash_dir, err);
+    }
+
+    // Start the removal thread once the queue is ready
+    m_thread = std::thread(&DirectoryRemover::removalThread, this);
+}
+
+/** @brief Destructor, waits for the pending removals */
+DirectoryRemover::~DirectoryRemover()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+        m_cond_var.notify_one();
+    }
+    m_thread.join();
+}
+
+/** @brief Move a directory to the trash directory and schedule its removal */
+bool DirectoryRemover::remove(const std::filesystem::path& dir)
+{
+    bool ret = true;
+
+    std::error_code err;
+    if (std::filesystem::exists(dir, err))
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // Renaming is immediate, the removal of the content is left to the thread
+        std::filesystem::path trash_path = m_trash_dir / (std::to_string(m_counter) + "_" + dir.filename().string());
+        std::filesystem::rename(dir, trash_path, err);
+        if (!err)
+        {
+            m_counter++;
+            m_queue.push_back(trash_path);
+            m_cond_var.notify_one();
+        }
+        else
+        {
+            std::cout << "Unable to remove " << dir << " : " << err.message() << std::endl;
+            ret = false;
+        }
+    }
+
+    return ret;
+}
+
+/** @brief Number of directories waiting for their removal */
+size_t DirectoryRemover::pending() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_queue.size();
+}
+
+/** @brief Removal thread */
+void DirectoryRemover::removalThread()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stop || !m_queue.empty())
+    {
+        if (m_queue.empty())
+        {
+            m_cond_var.wait(lock);
+        }
+        else
+        {
+            // Remove outside of the lock, the directory stays in the queue until removed
+            std::filesystem::path dir = m_queue.front();
+            lock.unlock();
+            std::error_code err;
+            std::filesystem::remove_all(dir, err);
+            if (err)
+            {
+                std::cout << "Unable to remove " << dir << " : " << err.message() << std::endl;
+            }
+            lock.lock();
+            m_queue.pop_front();
+        }
+    }
+}
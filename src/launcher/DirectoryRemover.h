@@ -0,0 +1,80 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef DIRECTORYREMOVER_H
+#define DIRECTORYREMOVER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+
+/** @brief Remove directories on a background thread so that the command processing never waits for the file system */
+class DirectoryRemover
+{
+  public:
+    /**
+     * @brief Constructor
+     * @param trash_dir Directory where the directories are moved before their removal,
+     *                  its content left by a previous run is removed
+     */
+    DirectoryRemover(const std::filesystem::path& trash_dir);
+
+    /** @brief Destructor, waits for the pending removals */
+    virtual ~DirectoryRemover();
+
+    /**
+     * @brief Move a directory to the trash directory and schedule its removal,
+     *        the original path can then be immediately re-used
+     * @param dir Directory to remove
+     * @return true if the directory has been moved or does not exist, false otherwise
+     */
+    bool remove(const std::filesystem::path& dir);
+
+    /** @brief Number of directories waiting for their removal */
+    size_t pending() const;
+
+  private:
+    /** @brief Trash directory */
+    const std::filesystem::path m_trash_dir;
+    /** @brief Mutex to protect the removal queue */
+    mutable std::mutex m_mutex;
+    /** @brief Condition variable to wake up the removal thread */
+    std::condition_variable m_cond_var;
+    /** @brief Indicate that the removal thread must stop once the queue is empty */
+    bool m_stop;
+    /** @brief Directories to remove */
+    std::deque<std::filesystem::path> m_queue;
+    /** @brief Counter to generate unique names in the trash directory, initialized with the current time to be unique between runs */
+    uint64_t m_counter;
+    /** @brief Removal thread */
+    std::thread m_thread;
+
+    /** @brief Removal thread */
+    void removalThread();
+};
+
+#endif // DIRECTORYREMOVER_H
@@ -0,0 +1,85 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "SessionCleaner.h"
+#include "IMqttClient.h"
+
+#include <iostream>
+#include <memory>
+
+/** @brief Constructor */
+SessionCleaner::SessionCleaner(const std::string& broker_url)
+    : m_broker_url(broker_url), m_mutex(), m_cond_var(), m_stop(false), m_queue(), m_thread(&SessionCleaner::cleanupThread, this)
+{
+}
+
+/** @brief Destructor, waits for the pending cleanups */
+SessionCleaner::~SessionCleaner()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+        m_cond_var.notify_one();
+    }
+    m_thread.join();
+}
+
+/** @brief Schedule the cleanup of the session of a charge point */
+void SessionCleaner::clean(const std::string& id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_queue.push_back(id);
+    m_cond_var.notify_one();
+}
+
+/** @brief Cleanup thread */
+void SessionCleaner::cleanupThread()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stop || !m_queue.empty())
+    {
+        if (m_queue.empty())
+        {
+            m_cond_var.wait(lock);
+        }
+        else
+        {
+            // Connect outside of the lock, the broker discards the previous session on a clean session connection
+            std::string id = m_queue.front();
+            m_queue.pop_front();
+            lock.unlock();
+            std::unique_ptr<IMqttClient> mqtt(IMqttClient::create(id, m_broker_url));
+            if (mqtt->connect(m_broker_url, true))
+            {
+                mqtt->close();
+                std::cout << "[" << id << "] - MQTT session discarded" << std::endl;
+            }
+            else
+            {
+                std::cout << "[" << id << "] - Unable to discard the MQTT session" << std::endl;
+            }
+            lock.lock();
+        }
+    }
+}
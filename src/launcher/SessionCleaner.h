@@ -0,0 +1,75 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef SESSIONCLEANER_H
+#define SESSIONCLEANER_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * @brief Discard the persistent MQTT sessions of the removed charge points on a background thread :
+ *        the broker keeps a persistent session until it expires (never with MQTT 3.1.1), connecting
+ *        once with the charge point's client identifier and a clean session discards it
+ */
+class SessionCleaner
+{
+  public:
+    /**
+     * @brief Constructor
+     * @param broker_url URL of the broker used by the charge points
+     */
+    SessionCleaner(const std::string& broker_url);
+
+    /** @brief Destructor, waits for the pending cleanups */
+    virtual ~SessionCleaner();
+
+    /**
+     * @brief Schedule the cleanup of the session of a charge point
+     * @param id Client identifier of the charge point
+     */
+    void clean(const std::string& id);
+
+  private:
+    /** @brief URL of the broker used by the charge points */
+    const std::string m_broker_url;
+    /** @brief Mutex to protect the cleanup queue */
+    std::mutex m_mutex;
+    /** @brief Condition variable to wake up the cleanup thread */
+    std::condition_variable m_cond_var;
+    /** @brief Indicate that the cleanup thread must stop once the queue is empty */
+    bool m_stop;
+    /** @brief Client identifiers whose session must be discarded */
+    std::deque<std::string> m_queue;
+    /** @brief Cleanup thread */
+    std::thread m_thread;
+
+    /** @brief Cleanup thread */
+    void cleanupThread();
+};
+
+#endif // SESSIONCLEANER_H
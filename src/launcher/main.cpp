@@ -24,6 +24,7 @@ SOFTWARE.
 
 #include "CommandHandler.h"
 #include "IMqttClient.h"
+#include "MqttReconnectPolicy.h"
 #include "Topics.h"
 
 #include <openocpp/json.h>
@@ -32,7 +33,38 @@ SOFTWARE.
 #include <filesystem>
 #include <fstream>
 #include <iostream>
-#include <thread>
+
+#ifdef _MSC_VER
+#include <Windows.h>
+#else // _MSC_VER
+#include <unistd.h>
+#endif // _MSC_VER
+
+/** @brief Build an identifier unique among the launchers connected to the broker : host name, process id and group */
+static std::string launcherId(const std::string& group)
+{
+    std::string host_name = "localhost";
+#ifdef _MSC_VER
+    const char* computer_name = getenv("COMPUTERNAME");
+    if (computer_name)
+    {
+        host_name = computer_name;
+    }
+    std::string id = "cp_simu_launcher_" + host_name + "_" + std::to_string(GetCurrentProcessId());
+#else  // _MSC_VER
+    char name[256] = {0};
+    if (gethostname(name, sizeof(name) - 1u) == 0)
+    {
+        host_name = name;
+    }
+    std::string id = "cp_simu_launcher_" + host_name + "_" + std::to_string(getpid());
+#endif // _MSC_VER
+    if (!group.empty())
+    {
+        id += "_" + group;
+    }
+    return id;
+}
 
 /** @brief Entry point */
 int main(int argc, char* argv[])
@@ -42,6 +74,8 @@ int main(int argc, char* argv[])
     std::string broker_url        = "tcp://localhost:1883";
     std::string config_file       = "";
     bool        reset_working_dir = false;
+    bool        mqtt5             = false;
+    std::string shared_group      = "";
 
     // Check parameters
     if (argc > 1)
@@ -77,6 +111,17 @@ int main(int argc, char* argv[])
             {
                 reset_working_dir = true;
             }
+            else if (strcmp(*argv, "-5") == 0)
+            {
+                mqtt5 = true;
+            }
+            else if ((strcmp(*argv, "-g") == 0) && (argc > 1))
+            {
+                argv++;
+                argc--;
+                shared_group = *argv;
+                mqtt5        = true;
+            }
             else
             {
                 param     = *argv;
@@ -93,12 +138,15 @@ int main(int argc, char* argv[])
             {
                 std::cout << "Invalid parameter : " << param << std::endl;
             }
-            std::cout << "Usage : launcher [-w working_dir] [-b broker_url] [-c config_file] [-r]" << std::endl;
+            std::cout << "Usage : launcher [-w working_dir] [-b broker_url] [-c config_file] [-r] [-5] [-g group]" << std::endl;
             std::cout << "    -w : Working directory where to store the charge point persistent data (Default = current directory)"
                       << std::endl;
             std::cout << "    -b : Url of the MQTT broker (Default = tcp://localhost:1883)" << std::endl;
             std::cout << "    -c : Configuration file (Default = none)" << std::endl;
             std::cout << "    -r : Reset working directory (Default = False)" << std::endl;
+            std::cout << "    -5 : Use MQTT 5 (Default = False)" << std::endl;
+            std::cout << "    -g : Load balance the start commands between the launchers of a group, implies -5 (Default = none)"
+                      << std::endl;
             return 1;
         }
     }
@@ -120,13 +168,36 @@ int main(int argc, char* argv[])
         return 1;
     }
 
-    // MQTT client
-    IMqttClient* mqtt = IMqttClient::create("OCPP charge point simulator launcher");
+    // MQTT client, its identifier must be unique so that the launchers don't evict each other from the broker
+    std::string launcher_id = launcherId(shared_group);
+    std::cout << "Launcher id : " << launcher_id << std::endl;
+    IMqttClient* mqtt = IMqttClient::create(launcher_id, broker_url);
+
+    // Reconnection policy
+    MqttReconnectPolicy reconnect(std::chrono::milliseconds(500), std::chrono::seconds(30), 50u);
 
     // Command handler
-    CommandHandler cmd_handler(broker_url, chargepoint_dir);
+    CommandHandler cmd_handler(launcher_id, shared_group, broker_url, chargepoint_dir, *mqtt, reconnect);
     mqtt->registerListener(cmd_handler);
 
+    // Protocol options
+    IMqttClient::ProtocolOptions protocol_options;
+    protocol_options.mqtt5               = mqtt5;
+    protocol_options.topic_alias_maximum = 16u;
+    protocol_options.retained_expiry     = std::chrono::seconds(0);
+    protocol_options.session_expiry      = std::chrono::seconds(0);
+    protocol_options.max_inflight        = 0u;
+    mqtt->setProtocolOptions(protocol_options);
+
+    // Start commands filter, shared between the launchers of the same group so that each start command is handled by only one of them.
+    // The charge point status and the other commands are not shared : each launcher must know the status of all the charge points
+    // (including the retained ones which are not sent on shared subscriptions) and kill/restart/remove the ones it owns
+    std::string shared_cmd_filter;
+    if (!shared_group.empty())
+    {
+        shared_cmd_filter = IMqttClient::sharedFilter(shared_group, LAUNCHER_SHARED_CMD_TOPIC);
+    }
+
     // Configuration file
     if (!config_file.empty())
     {
@@ -183,61 +254,66 @@ int main(int argc, char* argv[])
     // Set the will message
     mqtt->setWill(LAUNCHER_STATUS_TOPIC, "Dead", IMqttClient::QoS::QOS_0, true);
 
-    // Connection loop
-    do
+    // Connection loop, the attempts are spread in time by the reconnection policy
+    while (!cmd_handler.isEndOfApplication() && reconnect.waitNextAttempt())
     {
         // Connection to the broker
+        bool connected = false;
         std::cout << "Connecting to the broker (" << broker_url << ")..." << std::endl;
         if (mqtt->connect(broker_url))
         {
             std::cout << "Subscribing to simulated charge point's topics..." << std::endl;
             if (mqtt->subscribe(CHARGE_POINTS_TOPIC "+/status"))
             {
-                std::cout << "Subscribing to launcher's command topic..." << std::endl;
-                if (mqtt->subscribe(LAUNCHER_CMD_TOPIC))
+                std::cout << "Subscribing to launcher's command topics..." << std::endl;
+                if (mqtt->subscribe(LAUNCHER_CMD_TOPIC) && (shared_cmd_filter.empty() || mqtt->subscribe(shared_cmd_filter)))
                 {
+                    connected = true;
+                    reconnect.attemptDone(true);
+
                     // Set the status message
                     mqtt->publish(LAUNCHER_STATUS_TOPIC, "Alive", IMqttClient::QoS::QOS_0, true);
 
                     // Wait for disconnection or end of application
                     std::cout << "Ready!" << std::endl;
-                    while (!cmd_handler.isEndOfApplication() && mqtt->isConnected())
-                    {
-                        std::this_thread::sleep_for(std::chrono::milliseconds(500));
-                    }
-                    if (!mqtt->isConnected())
+                    reconnect.waitConnectionLost();
+                    if (reconnect.isConnectionLost())
                     {
-                        std::cout << "Disconnected, next retry in 5s..." << std::endl;
+                        MqttReconnectPolicy::Stats stats = reconnect.stats();
+                        std::cout << "Disconnected, reconnecting... (attempts : " << stats.attempts << ", successes : " << stats.successes
+                                  << ")" << std::endl;
                     }
                 }
                 else
                 {
-                    std::cout << "Couldn't subscribe, next retry in 5s..." << std::endl;
+                    std::cout << "Couldn't subscribe, retrying..." << std::endl;
                 }
             }
             else
             {
-                std::cout << "Couldn't subscribe, next retry in 5s..." << std::endl;
+                std::cout << "Couldn't subscribe, retrying..." << std::endl;
             }
         }
         else
         {
-            std::cout << "Couldn't connect to the broker, next retry in 5s..." << std::endl;
+            std::cout << "Couldn't connect to the broker, retrying..." << std::endl;
+        }
+        if (!connected)
+        {
+            reconnect.attemptDone(false);
         }
 
-        // Delay before retry
+        // Prepare next attempt
         if (!cmd_handler.isEndOfApplication())
         {
             mqtt->close();
-            std::this_thread::sleep_for(std::chrono::seconds(5));
         }
         else
         {
             // Update the status message
             mqtt->publish(LAUNCHER_STATUS_TOPIC, "Dead", IMqttClient::QoS::QOS_0, true);
         }
-
-    } while (!cmd_handler.isEndOfApplication());
+    }
 
     // Release resources
     delete mqtt;
@@ -0,0 +1,193 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "GatewayProtocol.h"
+
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/** @brief Size of a frame header : payload size (4 bytes), topic size (2 bytes), type (1 byte), flags (1 byte) */
+static constexpr size_t FRAME_HEADER_SIZE = 8u;
+
+/** @brief Minimum size of a read on the socket */
+static constexpr size_t MIN_READ_SIZE = 4096u;
+
+/** @brief Serialize a frame at the end of a buffer */
+bool GatewayProtocol::serialize(std::string& buffer, FrameType type, uint8_t flags, std::string_view topic, std::string_view payload)
+{
+    bool ret = false;
+
+    // The sizes must fit in the header fields and be accepted by the reader
+    if ((topic.size() <= MAX_TOPIC_SIZE) && (payload.size() <= MAX_FRAME_SIZE) && ((topic.size() + payload.size()) <= MAX_FRAME_SIZE))
+    {
+        uint32_t payload_size = static_cast<uint32_t>(payload.size());
+        uint16_t topic_size   = static_cast<uint16_t>(topic.size());
+        char     header[FRAME_HEADER_SIZE];
+        memcpy(&header[0], &payload_size, sizeof(payload_size));
+        memcpy(&header[4], &topic_size, sizeof(topic_size));
+        header[6] = static_cast<char>(type);
+        header[7] = static_cast<char>(flags);
+
+        buffer.reserve(buffer.size() + FRAME_HEADER_SIZE + topic.size() + payload.size());
+        buffer.append(header, FRAME_HEADER_SIZE);
+        buffer.append(topic);
+        buffer.append(payload);
+        ret = true;
+    }
+
+    return ret;
+}
+
+/** @brief Send a buffer on a socket */
+bool GatewayProtocol::send(int fd, const std::string& buffer)
+{
+    size_t sent = 0;
+    bool   ret  = true;
+    while (ret && (sent < buffer.size()))
+    {
+        ssize_t size = ::send(fd, &buffer[sent], buffer.size() - sent, MSG_NOSIGNAL);
+        if (size > 0)
+        {
+            sent += static_cast<size_t>(size);
+        }
+        else if ((size < 0) && (errno == EINTR))
+        {
+            // Retry
+        }
+        else
+        {
+            ret = false;
+        }
+    }
+    return ret;
+}
+
+/** @brief Send as much of a buffer as possible on a socket without blocking */
+bool GatewayProtocol::sendAvailable(int fd, std::string& buffer)
+{
+    size_t sent = 0;
+    bool   ret  = true;
+    bool   full = false;
+    while (ret && !full && (sent < buffer.size()))
+    {
+        ssize_t size = ::send(fd, &buffer[sent], buffer.size() - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (size > 0)
+        {
+            sent += static_cast<size_t>(size);
+        }
+        else if ((size < 0) && (errno == EINTR))
+        {
+            // Retry
+        }
+        else if ((size < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK)))
+        {
+            // Socket buffer full, the remaining data will be sent later
+            full = true;
+        }
+        else
+        {
+            ret = false;
+        }
+    }
+    buffer.erase(0, sent);
+    return ret;
+}
+
+/** @brief Constructor */
+GatewayProtocol::Reader::Reader() : m_buffer(MIN_READ_SIZE), m_start(0), m_end(0), m_corrupted(false) { }
+
+/** @brief Read the available data from a socket */
+bool GatewayProtocol::Reader::read(int fd)
+{
+    // Move the unprocessed data at the start of the buffer
+    if (m_start != 0)
+    {
+        memmove(&m_buffer[0], &m_buffer[m_start], m_end - m_start);
+        m_end -= m_start;
+        m_start = 0;
+    }
+    if ((m_buffer.size() - m_end) < MIN_READ_SIZE)
+    {
+        m_buffer.resize(m_buffer.size() * 2u);
+    }
+
+    // Read the socket
+    ssize_t size = 0;
+    do
+    {
+        size = ::recv(fd, &m_buffer[m_end], m_buffer.size() - m_end, 0);
+    } while ((size < 0) && (errno == EINTR));
+    if (size > 0)
+    {
+        m_end += static_cast<size_t>(size);
+    }
+
+    return (size > 0);
+}
+
+/** @brief Get the next complete frame */
+bool GatewayProtocol::Reader::next(Frame& frame)
+{
+    bool ret = false;
+
+    if (!m_corrupted && ((m_end - m_start) >= FRAME_HEADER_SIZE))
+    {
+        // Decode header
+        uint32_t    payload_size = 0;
+        uint16_t    topic_size   = 0;
+        const char* header       = &m_buffer[m_start];
+        memcpy(&payload_size, &header[0], sizeof(payload_size));
+        memcpy(&topic_size, &header[4], sizeof(topic_size));
+        // The sizes are added in size_t so that a malformed header can not wrap around the limit
+        size_t body_size  = static_cast<size_t>(topic_size) + static_cast<size_t>(payload_size);
+        size_t frame_size = FRAME_HEADER_SIZE + body_size;
+        if ((payload_size > MAX_FRAME_SIZE) || (body_size > MAX_FRAME_SIZE))
+        {
+            m_corrupted = true;
+        }
+        else if ((m_end - m_start) >= frame_size)
+        {
+            // Complete frame
+            frame.type    = static_cast<FrameType>(header[6]);
+            frame.flags   = static_cast<uint8_t>(header[7]);
+            frame.topic   = std::string_view(&header[FRAME_HEADER_SIZE], topic_size);
+            frame.payload = std::string_view(&header[FRAME_HEADER_SIZE + topic_size], payload_size);
+            m_start += frame_size;
+            ret = true;
+        }
+        else if (m_buffer.size() < frame_size)
+        {
+            // Make room for the whole frame
+            m_buffer.resize(frame_size + MIN_READ_SIZE);
+        }
+        else
+        {
+            // Wait for more data
+        }
+    }
+
+    return ret;
+}
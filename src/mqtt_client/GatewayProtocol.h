@@ -0,0 +1,151 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef GATEWAYPROTOCOL_H
+#define GATEWAYPROTOCOL_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/** @brief URL scheme to connect to an MQTT gateway through a Unix domain socket */
+#define GATEWAY_URL_SCHEME "unix://"
+
+/** @brief Frames exchanged between the local MQTT gateway and its clients over a stream socket */
+class GatewayProtocol
+{
+  public:
+    /** @brief Frame types */
+    enum class FrameType : uint8_t
+    {
+        /** @brief Client -> gateway : will message, topic = will topic, payload = will message */
+        WILL = 1u,
+        /** @brief Client -> gateway : connection request, topic = client id, payload = request sequence number */
+        CONNECT,
+        /** @brief Client -> gateway : message to publish */
+        PUBLISH,
+        /** @brief Client -> gateway : subscription, topic = topic filter, payload = request sequence number */
+        SUBSCRIBE,
+        /** @brief Client -> gateway : unsubscription, topic = topic filter, payload = request sequence number */
+        UNSUBSCRIBE,
+        /** @brief Client -> gateway : clean disconnection, the will message is discarded */
+        DISCONNECT,
+        /** @brief Gateway -> client : acknowledge of a CONNECT, SUBSCRIBE or UNSUBSCRIBE frame, payload = request sequence number */
+        ACK,
+        /** @brief Gateway -> client : received message */
+        MESSAGE
+    };
+
+    /** @brief Mask of the QoS in the frame flags */
+    static constexpr uint8_t FLAG_QOS_MASK = 0x03u;
+    /** @brief Retained message flag */
+    static constexpr uint8_t FLAG_RETAINED = 0x04u;
+    /** @brief Clean session flag (CONNECT) */
+    static constexpr uint8_t FLAG_CLEAN_SESSION = 0x08u;
+    /** @brief Success flag (ACK) */
+    static constexpr uint8_t FLAG_SUCCESS = 0x10u;
+
+    /** @brief Maximum size of the topic and payload of a frame */
+    static constexpr size_t MAX_FRAME_SIZE = 16u * 1024u * 1024u;
+    /** @brief Maximum size of the topic of a frame */
+    static constexpr size_t MAX_TOPIC_SIZE = 65535u;
+
+    /** @brief Frame decoded in place in the reception buffer */
+    struct Frame
+    {
+        /** @brief Type */
+        FrameType type;
+        /** @brief Flags */
+        uint8_t flags;
+        /** @brief Topic */
+        std::string_view topic;
+        /** @brief Payload */
+        std::string_view payload;
+    };
+
+    /**
+     * @brief Serialize a frame at the end of a buffer
+     * @param buffer Buffer to append the frame to
+     * @param type Frame type
+     * @param flags Frame flags
+     * @param topic Topic
+     * @param payload Payload
+     * @return true if the frame has been serialized, false if the topic or the payload is too large (the buffer is left unchanged)
+     */
+    static bool serialize(std::string& buffer, FrameType type, uint8_t flags, std::string_view topic, std::string_view payload);
+
+    /**
+     * @brief Send a buffer on a socket
+     * @param fd Socket
+     * @param buffer Buffer to send
+     * @return true if the whole buffer has been sent, false otherwise
+     */
+    static bool send(int fd, const std::string& buffer);
+
+    /**
+     * @brief Send as much of a buffer as possible on a socket without blocking
+     * @param fd Socket
+     * @param buffer Buffer to send, the sent data is removed from the buffer
+     * @return true if no error occured (the buffer may not be empty), false otherwise
+     */
+    static bool sendAvailable(int fd, std::string& buffer);
+
+    /** @brief Reassemble the frames received on a stream socket */
+    class Reader
+    {
+      public:
+        /** @brief Constructor */
+        Reader();
+
+        /**
+         * @brief Read the available data from a socket (blocks if no data is available on a blocking socket)
+         * @param fd Socket
+         * @return true if data has been read, false if the socket has been closed or an error occured
+         */
+        bool read(int fd);
+
+        /**
+         * @brief Get the next complete frame, the frame stays valid until the next call to read() or next()
+         * @param frame Decoded frame
+         * @return true if a complete frame is available, false otherwise
+         */
+        bool next(Frame& frame);
+
+        /** @brief Indicate if a frame exceeded the maximum frame size */
+        bool isCorrupted() const { return m_corrupted; }
+
+      private:
+        /** @brief Reception buffer */
+        std::vector<char> m_buffer;
+        /** @brief Start of the unprocessed data in the buffer */
+        size_t m_start;
+        /** @brief End of the received data in the buffer */
+        size_t m_end;
+        /** @brief Indicate if a frame exceeded the maximum frame size */
+        bool m_corrupted;
+    };
+};
+
+#endif // GATEWAYPROTOCOL_H
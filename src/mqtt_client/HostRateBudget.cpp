@@ -0,0 +1,195 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "HostRateBudget.h"
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#ifndef _MSC_VER
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _MSC_VER
+
+/** @brief Prefix of the name of the files holding the budgets of the host */
+static constexpr const char* HOST_BUDGET_FILE_PREFIX = "cp_simu_";
+
+/** @brief Suffix of the name of the files holding the budgets of the host */
+static constexpr const char* HOST_BUDGET_FILE_SUFFIX = ".budget";
+
+/** @brief A budget further than this in the future is stale (from a previous boot of the host) */
+static constexpr std::chrono::hours HOST_BUDGET_HORIZON = std::chrono::hours(1);
+
+static_assert(std::atomic<int64_t>::is_always_lock_free, "The host budget must be lock free to be shared between processes");
+
+#ifndef _MSC_VER
+/** @brief Permissions of the files holding the budgets of the host : shared by the processes of all the users */
+static constexpr mode_t HOST_BUDGET_FILE_MODE = 0666;
+#endif // _MSC_VER
+
+/** @brief Get the state word of a budget, each budget is mapped only once per process */
+static std::atomic<int64_t>& mapBudget(const std::string& name, unsigned int rate, unsigned int burst)
+{
+    static std::mutex                                                  mutex;
+    static std::map<std::string, std::unique_ptr<std::atomic<int64_t>>> local_budgets;
+    static std::map<std::string, std::atomic<int64_t>*>                budgets;
+
+    // The state word is only meaningful for a given rate and burst, the processes using the same name
+    // with different limits must not share it
+    std::string key = name + "_" + std::to_string(rate) + "_" + std::to_string(burst);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto                        it = budgets.find(key);
+    if (it == budgets.end())
+    {
+        std::atomic<int64_t>* budget = nullptr;
+#ifndef _MSC_VER
+        std::error_code       error;
+        std::string           filename = HOST_BUDGET_FILE_PREFIX + key + HOST_BUDGET_FILE_SUFFIX;
+        std::filesystem::path path     = std::filesystem::temp_directory_path(error) / filename;
+        int                   fd       = open(path.c_str(), O_RDWR | O_CREAT | O_NOFOLLOW | O_CLOEXEC, HOST_BUDGET_FILE_MODE);
+        if (fd >= 0)
+        {
+            // The creation mode is restricted by the umask, only the owner of the file can widen it
+            struct stat file_stat;
+            if ((fstat(fd, &file_stat) == 0) && (file_stat.st_uid == geteuid()))
+            {
+                fchmod(fd, HOST_BUDGET_FILE_MODE);
+            }
+
+            // A newly created file is zero filled which is a valid initial budget
+            if (ftruncate(fd, sizeof(std::atomic<int64_t>)) == 0)
+            {
+                void* memory = mmap(nullptr, sizeof(std::atomic<int64_t>), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                if (memory != MAP_FAILED)
+                {
+                    budget = reinterpret_cast<std::atomic<int64_t>*>(memory);
+                }
+            }
+            close(fd);
+        }
+        if (!budget)
+        {
+            std::cout << "Unable to map the host rate budget file " << path.string() << " (" << strerror(errno)
+                      << "), the budget is only shared within the process" << std::endl;
+        }
+#endif // _MSC_VER
+        if (!budget)
+        {
+            // Process local fallback
+            budget = local_budgets.emplace(key, std::make_unique<std::atomic<int64_t>>(0)).first->second.get();
+        }
+        it = budgets.emplace(key, budget).first;
+    }
+    return *it->second;
+}
+
+/** @brief Constructor */
+HostRateBudget::HostRateBudget(const std::string& name, unsigned int rate, unsigned int burst)
+    : m_interval((rate != 0) ? (std::chrono::nanoseconds(std::chrono::seconds(1)) / rate) : std::chrono::nanoseconds(0)),
+      m_tolerance(m_interval * (std::max(burst, 1u) - 1u)),
+      m_budget(mapBudget(name, rate, burst))
+{
+}
+
+/** @brief Destructor */
+HostRateBudget::~HostRateBudget() { }
+
+/** @brief Reserve a slot in the budget */
+std::chrono::steady_clock::time_point HostRateBudget::reserve(std::chrono::steady_clock::time_point earliest)
+{
+    std::chrono::steady_clock::time_point slot_time = earliest;
+    if (!isUnlimited())
+    {
+        // Lock free reservation : the slot is the earliest time conforming to the budget
+        int64_t earliest_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(earliest.time_since_epoch()).count();
+        int64_t slot        = 0;
+        int64_t budget      = m_budget.load();
+        int64_t new_budget  = 0;
+        do
+        {
+            int64_t arrival = arrivalTime(budget, earliest_ns);
+            slot            = std::max(earliest_ns, arrival - m_tolerance.count());
+            new_budget      = std::max(arrival, slot) + m_interval.count();
+        } while (!m_budget.compare_exchange_weak(budget, new_budget));
+        slot_time = std::chrono::steady_clock::time_point(
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(slot)));
+    }
+    return slot_time;
+}
+
+/** @brief Take a slot in the budget if one is available */
+bool HostRateBudget::tryAcquire(std::chrono::steady_clock::time_point now)
+{
+    bool ret = true;
+    if (!isUnlimited())
+    {
+        int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+        int64_t budget = m_budget.load();
+        bool    end    = false;
+        while (!end)
+        {
+            int64_t arrival = arrivalTime(budget, now_ns);
+            if ((arrival - m_tolerance.count()) <= now_ns)
+            {
+                end = m_budget.compare_exchange_weak(budget, std::max(arrival, now_ns) + m_interval.count());
+            }
+            else
+            {
+                // Budget exhausted
+                ret = false;
+                end = true;
+            }
+        }
+    }
+    return ret;
+}
+
+/** @brief Get the time at which the next slot will be available */
+std::chrono::steady_clock::time_point HostRateBudget::nextSlotTime(std::chrono::steady_clock::time_point now) const
+{
+    std::chrono::steady_clock::time_point slot_time = now;
+    if (!isUnlimited())
+    {
+        int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+        int64_t slot   = std::max(now_ns, arrivalTime(m_budget.load(), now_ns) - m_tolerance.count());
+        slot_time      = std::chrono::steady_clock::time_point(
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(slot)));
+    }
+    return slot_time;
+}
+
+/** @brief Get the theoretical arrival time stored in the budget, ignoring a stale value */
+int64_t HostRateBudget::arrivalTime(int64_t budget, int64_t now)
+{
+    int64_t horizon = now + std::chrono::duration_cast<std::chrono::nanoseconds>(HOST_BUDGET_HORIZON).count();
+    return ((budget > horizon) ? 0 : budget);
+}
@@ -0,0 +1,88 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef HOSTRATEBUDGET_H
+#define HOSTRATEBUDGET_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Rate budget shared by all the processes of the host : token bucket implemented as a generic cell rate
+ *        algorithm whose single state word lives in a memory mapped file so that concurrent processes never
+ *        share a slot (process local on Windows or if the file cannot be mapped)
+ */
+class HostRateBudget
+{
+  public:
+    /**
+     * @brief Constructor
+     * @param name Name of the budget, the processes using the same name, rate and burst share the budget
+     * @param rate Maximum number of events per second (0 = unlimited)
+     * @param burst Maximum number of events allowed at once
+     */
+    HostRateBudget(const std::string& name, unsigned int rate, unsigned int burst);
+
+    /** @brief Destructor */
+    virtual ~HostRateBudget();
+
+    /** @brief Indicate if the budget is unlimited */
+    bool isUnlimited() const { return (m_interval.count() == 0); }
+
+    /**
+     * @brief Reserve a slot in the budget
+     * @param earliest Earliest time of the slot
+     * @return Time of the reserved slot
+     */
+    std::chrono::steady_clock::time_point reserve(std::chrono::steady_clock::time_point earliest);
+
+    /**
+     * @brief Take a slot in the budget if one is available
+     * @param now Current time
+     * @return true if a slot has been taken, false if the budget is exhausted
+     */
+    bool tryAcquire(std::chrono::steady_clock::time_point now);
+
+    /**
+     * @brief Get the time at which the next slot will be available
+     * @param now Current time
+     * @return Time of the next available slot
+     */
+    std::chrono::steady_clock::time_point nextSlotTime(std::chrono::steady_clock::time_point now) const;
+
+  private:
+    /** @brief Minimum interval between 2 events (0 = unlimited) */
+    const std::chrono::nanoseconds m_interval;
+    /** @brief Tolerance allowing bursts */
+    const std::chrono::nanoseconds m_tolerance;
+    /** @brief Theoretical arrival time of the next event, shared between processes when possible */
+    std::atomic<int64_t>& m_budget;
+
+    /** @brief Get the theoretical arrival time stored in the budget, ignoring a stale value */
+    static int64_t arrivalTime(int64_t budget, int64_t now);
+};
+
+#endif // HOSTRATEBUDGET_H
@@ -0,0 +1,64 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "IMqttClient.h"
+#include "private/LoopbackMqttClient.h"
+#include "private/PahoMqttClient.h"
+#ifndef _MSC_VER
+#include "GatewayProtocol.h"
+#include "private/GatewayMqttClient.h"
+#endif // _MSC_VER
+
+/** @brief Build an MQTT 5 shared subscription filter */
+std::string IMqttClient::sharedFilter(const std::string& group, const std::string& filter)
+{
+    return SHARED_SUBSCRIPTION_PREFIX + group + "/" + filter;
+}
+
+/** @brief Instanciate an MQTT client */
+IMqttClient* IMqttClient::create(const std::string& id)
+{
+    return new PahoMqttClient(id);
+}
+
+/** @brief Instanciate an MQTT client suitable for a broker URL */
+IMqttClient* IMqttClient::create(const std::string& id, const std::string& url)
+{
+    IMqttClient* client = nullptr;
+    if (url.find(LOOPBACK_URL_SCHEME) == 0)
+    {
+        client = new LoopbackMqttClient(id);
+    }
+#ifndef _MSC_VER
+    else if (url.find(GATEWAY_URL_SCHEME) == 0)
+    {
+        client = new GatewayMqttClient(id);
+    }
+#endif // _MSC_VER
+    else
+    {
+        client = new PahoMqttClient(id);
+    }
+    return client;
+}
@@ -26,7 +26,13 @@ SOFTWARE.
 #define IMQTTCLIENT_H
 
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
+
+/** @brief Prefix of the MQTT 5 shared subscription filters */
+#define SHARED_SUBSCRIPTION_PREFIX "$share/"
 
 /** @brief Interface for MQTT clients implementations */
 class IMqttClient
@@ -49,6 +55,51 @@ class IMqttClient
         QOS_2
     };
 
+    /** @brief Message to publish in a batch */
+    struct Message
+    {
+        /** @brief Topic on which the message must be published */
+        std::string topic;
+        /** @brief Message to publish */
+        std::string payload;
+        /** @brief Desired QoS */
+        QoS qos;
+        /** @brief Indicate if the message must be retained on the broker */
+        bool retained;
+    };
+
+    /** @brief Statistics of the batch publications */
+    struct PublishStats
+    {
+        /** @brief Number of published batches */
+        uint64_t batches;
+        /** @brief Number of messages published in batches */
+        uint64_t messages;
+        /** @brief Number of messages of the batches which could not be published */
+        uint64_t failures;
+        /** @brief Latency of the last batch (from first publish to last completion) */
+        std::chrono::microseconds last_latency;
+        /** @brief Longest batch latency */
+        std::chrono::microseconds max_latency;
+        /** @brief Cumulated batch latency */
+        std::chrono::microseconds total_latency;
+    };
+
+    /** @brief Protocol options */
+    struct ProtocolOptions
+    {
+        /** @brief Use MQTT 5 instead of MQTT 3.1.1 */
+        bool mqtt5;
+        /** @brief Maximum number of topic aliases for the published messages, also limited by the broker (MQTT 5 only, 0 = disabled) */
+        unsigned int topic_alias_maximum;
+        /** @brief Expiry interval of the retained messages (MQTT 5 only, 0 = never expire) */
+        std::chrono::seconds retained_expiry;
+        /** @brief Expiry interval of a persistent session after disconnection (MQTT 5 only, 0 = end with the connection) */
+        std::chrono::seconds session_expiry;
+        /** @brief Maximum number of QoS 1 and 2 messages in flight (0 = implementation default) */
+        unsigned int max_inflight;
+    };
+
     /** @brief Destructor */
     virtual ~IMqttClient() { }
 
@@ -68,6 +119,14 @@ class IMqttClient
      */
     virtual bool setWill(const std::string& topic, const std::string& message, QoS qos = QoS::QOS_0, bool retained = false) = 0;
 
+    /**
+     * @brief Configure the protocol options (must be done before connect),
+     *        implementations which do not support an option ignore it
+     * @param options Protocol options
+     * @return true if the options have been applied, false otherwise
+     */
+    virtual bool setProtocolOptions(const ProtocolOptions& options) = 0;
+
     /** 
      * @brief Connect to a broker 
      * @param url URL of the broker
@@ -109,6 +168,22 @@ class IMqttClient
      */
     virtual bool publish(const std::string& topic, const std::string& message, QoS qos = QoS::QOS_0, bool retained = false) = 0;
 
+    /**
+     * @brief Publish a batch of messages, all the messages are sent before waiting
+     *        for a single completion of the messages with a QoS greater than 0
+     * @param messages Messages to publish
+     * @param count Number of messages to publish
+     * @param results If not null, array of count elements receiving the publication result of each message
+     * @return Number of messages which have been published
+     */
+    virtual size_t publishBatch(const Message* messages, size_t count, bool* results = nullptr) = 0;
+
+    /**
+     * @brief Get the statistics of the batch publications
+     * @return Statistics of the batch publications
+     */
+    virtual PublishStats publishStats() const = 0;
+
     /**
      * @brief Subscribe to messages on a topic
      * @param topic Topic on which the message must be received
@@ -124,12 +199,30 @@ class IMqttClient
      */
     virtual bool unsubscribe(const std::string& topic) = 0;
 
+    /**
+     * @brief Build an MQTT 5 shared subscription filter, the messages matching the filter are
+     *        load balanced between the clients subscribed with the same group
+     * @param group Name of the group of subscribers
+     * @param filter Topic filter
+     * @return Shared subscription filter
+     */
+    static std::string sharedFilter(const std::string& group, const std::string& filter);
+
     /**
      * @brief Instanciate an MQTT client
      * @param id Unique id for the client
      */
     static IMqttClient* create(const std::string& id);
 
+    /**
+     * @brief Instanciate an MQTT client suitable for a broker URL
+     *        (unix://path connects through the local MQTT gateway listening on path,
+     *        loop://name connects to the in-process loopback broker named name)
+     * @param id Unique id for the client
+     * @param url URL of the broker
+     */
+    static IMqttClient* create(const std::string& id, const std::string& url);
+
     /** @brief Interface for listeners to MQTT client events */
     class IListener
     {
@@ -148,6 +241,19 @@ class IMqttClient
          * @param retained Indicate if the message has been retained
          */
         virtual void mqttMessageReceived(const char* topic, const std::string& message, QoS qos, bool retained) = 0;
+
+        /** 
+         * @brief Called when a message has been received, without copying its payload
+         *        (the default implementation copies the payload and calls mqttMessageReceived())
+         * @param topic Topic on which the message has been received
+         * @param message View on the received message, only valid during the call
+         * @param qos QoS of the received message
+         * @param retained Indicate if the message has been retained
+         */
+        virtual void mqttMessageViewReceived(const char* topic, std::string_view message, QoS qos, bool retained)
+        {
+            mqttMessageReceived(topic, std::string(message), qos, retained);
+        }
     };
 };
 
@@ -0,0 +1,362 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "MqttPublishQueue.h"
+
+#include <algorithm>
+#include <iterator>
+
+/** @brief Name of the publish rate budget of the host */
+static constexpr const char* HOST_BUDGET_NAME = "publish";
+
+/** @brief Constructor */
+MqttPublishQueue::MqttPublishQueue(size_t capacity)
+    : m_capacity(capacity),
+      m_mutex(),
+      m_cond_var(),
+      m_wakeup(false),
+      m_messages(),
+      m_retained(),
+      m_batch(),
+      m_batch_classes(),
+      m_limits(),
+      m_host_budget(),
+      m_max_depth(0),
+      m_pushed(0),
+      m_coalesced(0),
+      m_dropped(0),
+      m_published(0),
+      m_host_throttled(0),
+      m_class_stats()
+{
+    for (RateLimit& limit : m_limits)
+    {
+        limit = {0.0, 0.0, 0.0, std::chrono::steady_clock::now()};
+    }
+}
+
+/** @brief Destructor */
+MqttPublishQueue::~MqttPublishQueue() { }
+
+/** @brief Set the rate limit of a message class (token bucket) */
+void MqttPublishQueue::setRateLimit(PublishClass publish_class, unsigned int rate, unsigned int burst)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RateLimit&                  limit = m_limits[static_cast<size_t>(publish_class)];
+    limit.rate                        = static_cast<double>(rate);
+    limit.burst                       = static_cast<double>(std::max(burst, 1u));
+    limit.tokens                      = limit.burst;
+    limit.last_update                 = std::chrono::steady_clock::now();
+}
+
+/** @brief Set the rate limit shared by all the queues of the host using the same limit */
+void MqttPublishQueue::setHostRateLimit(unsigned int rate, unsigned int burst)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_host_budget.reset();
+    if (rate != 0)
+    {
+        m_host_budget = std::make_unique<HostRateBudget>(HOST_BUDGET_NAME, rate, burst);
+    }
+}
+
+/** @brief Push a message in the queue (never blocks on the network) */
+bool MqttPublishQueue::push(
+    const std::string& topic, const std::string& message, IMqttClient::QoS qos, bool retained, PublishClass publish_class)
+{
+    bool ret = false;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pushed++;
+
+    // Retained messages only need their latest value
+    auto it = m_retained.end();
+    if (retained)
+    {
+        it = m_retained.find(topic);
+    }
+    if (it != m_retained.end())
+    {
+        it->second->message.payload = message;
+        it->second->message.qos     = qos;
+        m_coalesced++;
+        m_class_stats[static_cast<size_t>(it->second->publish_class)].coalesced++;
+        ret = true;
+    }
+    else
+    {
+        if ((m_messages.size() < m_capacity) || makeRoom(retained))
+        {
+            m_messages.push_back({{topic, message, qos, retained}, publish_class, false});
+            if (retained)
+            {
+                m_retained[topic] = std::prev(m_messages.end());
+            }
+            if (m_messages.size() > m_max_depth)
+            {
+                m_max_depth = m_messages.size();
+            }
+            ret = true;
+        }
+        else
+        {
+            m_dropped++;
+        }
+    }
+
+    // Wake up the publishing thread
+    m_cond_var.notify_one();
+
+    return ret;
+}
+
+/** @brief Wait for messages which can be published within the rate limits */
+bool MqttPublishQueue::wait(std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // Wait until a message is ready, the throttled messages are ready when their rate limit allows it
+    auto now      = std::chrono::steady_clock::now();
+    auto deadline = now + timeout;
+    auto ready    = nextReadyTime(now);
+    while (!m_wakeup && (ready > now) && (now < deadline))
+    {
+        m_cond_var.wait_until(lock, std::min(ready, deadline));
+        now   = std::chrono::steady_clock::now();
+        ready = nextReadyTime(now);
+    }
+    m_wakeup = false;
+
+    return (ready <= now);
+}
+
+/** @brief Wake up the thread waiting for messages */
+void MqttPublishQueue::wakeUp()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_wakeup = true;
+    m_cond_var.notify_one();
+}
+
+/** @brief Publish all the pending messages in a single batch */
+bool MqttPublishQueue::flush(IMqttClient& client)
+{
+    // Take the pending messages allowed by the rate limits, the batch is only accessed by the publishing thread
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto                        now = std::chrono::steady_clock::now();
+        for (RateLimit& limit : m_limits)
+        {
+            limit.tokens      = availableTokens(limit, now);
+            limit.last_update = now;
+        }
+
+        // Retained state updates first, then the other messages in publication order
+        bool host_exhausted = false;
+        for (bool retained : {true, false})
+        {
+            auto it = m_messages.begin();
+            while (it != m_messages.end())
+            {
+                Entry&     entry = *it;
+                RateLimit& limit = m_limits[static_cast<size_t>(entry.publish_class)];
+                if (entry.message.retained != retained)
+                {
+                    ++it;
+                }
+                else if ((limit.rate != 0.0) && (limit.tokens < 1.0))
+                {
+                    // Held back by the class, a retained message keeps coalescing meanwhile
+                    if (!entry.throttled)
+                    {
+                        entry.throttled = true;
+                        m_class_stats[static_cast<size_t>(entry.publish_class)].throttled++;
+                    }
+                    ++it;
+                }
+                else if (host_exhausted || (m_host_budget && !m_host_budget->tryAcquire(now)))
+                {
+                    // Held back by the host
+                    host_exhausted = true;
+                    if (!entry.throttled)
+                    {
+                        entry.throttled = true;
+                        m_host_throttled++;
+                    }
+                    ++it;
+                }
+                else
+                {
+                    if (limit.rate != 0.0)
+                    {
+                        limit.tokens -= 1.0;
+                    }
+                    if (retained)
+                    {
+                        m_retained.erase(entry.message.topic);
+                    }
+                    m_batch.push_back(std::move(entry.message));
+                    m_batch_classes.push_back(entry.publish_class);
+                    it = m_messages.erase(it);
+                }
+            }
+        }
+    }
+
+    // Publish without holding the lock
+    size_t                  published = 0;
+    std::unique_ptr<bool[]> results   = std::make_unique<bool[]>(m_batch.size());
+    if (!m_batch.empty())
+    {
+        published = client.publishBatch(m_batch.data(), m_batch.size(), results.get());
+    }
+
+    // Update statistics
+    std::lock_guard<std::mutex> lock(m_mutex);
+    bool                        ret = (published == m_batch.size());
+    m_published += published;
+    for (size_t i = m_batch.size(); i > 0; i--)
+    {
+        IMqttClient::Message& message = m_batch[i - 1u];
+        ClassStats&           stats   = m_class_stats[static_cast<size_t>(m_batch_classes[i - 1u])];
+        if (results[i - 1u])
+        {
+            stats.sent++;
+        }
+        else if (message.retained && (m_retained.find(message.topic) != m_retained.end()))
+        {
+            // A newer value has been pushed meanwhile
+            m_coalesced++;
+            stats.coalesced++;
+        }
+        else if ((message.retained || (message.qos != IMqttClient::QoS::QOS_0)) && (m_messages.size() < m_capacity))
+        {
+            // Requeued in front of the queue to keep the publication order
+            m_messages.push_front({std::move(message), m_batch_classes[i - 1u], false});
+            if (m_messages.front().message.retained)
+            {
+                m_retained[m_messages.front().message.topic] = m_messages.begin();
+            }
+        }
+        else
+        {
+            m_dropped++;
+        }
+    }
+    m_batch.clear();
+    m_batch_classes.clear();
+
+    return ret;
+}
+
+/** @brief Get the queue statistics */
+MqttPublishQueue::Stats MqttPublishQueue::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Stats stats;
+    stats.capacity  = m_capacity;
+    stats.depth     = m_messages.size();
+    stats.max_depth = m_max_depth;
+    stats.pushed    = m_pushed;
+    stats.coalesced = m_coalesced;
+    stats.dropped   = m_dropped;
+    stats.published      = m_published;
+    stats.host_throttled = m_host_throttled;
+    stats.classes        = m_class_stats;
+    return stats;
+}
+
+/** @brief Make room for a new message, returns false if no message can be dropped */
+bool MqttPublishQueue::makeRoom(bool retained)
+{
+    bool ret = false;
+
+    // Drop the oldest non-retained message
+    auto it = m_messages.begin();
+    while ((it != m_messages.end()) && it->message.retained)
+    {
+        ++it;
+    }
+    if ((it == m_messages.end()) && retained && !m_messages.empty())
+    {
+        // Only retained messages, drop the oldest one to keep the latest states
+        it = m_messages.begin();
+        m_retained.erase(it->message.topic);
+    }
+    if (it != m_messages.end())
+    {
+        m_messages.erase(it);
+        m_dropped++;
+        ret = true;
+    }
+
+    return ret;
+}
+
+/** @brief Get the time at which a pending message can be published */
+std::chrono::steady_clock::time_point MqttPublishQueue::nextReadyTime(std::chrono::steady_clock::time_point now) const
+{
+    auto ready = std::chrono::steady_clock::time_point::max();
+    if (!m_messages.empty())
+    {
+        // Earliest token among the classes of the pending messages
+        std::array<bool, PUBLISH_CLASS_COUNT> pending = {};
+        for (const Entry& entry : m_messages)
+        {
+            pending[static_cast<size_t>(entry.publish_class)] = true;
+        }
+        for (size_t i = 0; (i < PUBLISH_CLASS_COUNT) && (ready > now); i++)
+        {
+            if (pending[i])
+            {
+                const RateLimit& limit  = m_limits[i];
+                double           tokens = availableTokens(limit, now);
+                if ((limit.rate == 0.0) || (tokens >= 1.0))
+                {
+                    ready = now;
+                }
+                else
+                {
+                    auto missing = std::chrono::duration<double>((1.0 - tokens) / limit.rate);
+                    ready        = std::min(ready, now + std::chrono::ceil<std::chrono::steady_clock::duration>(missing));
+                }
+            }
+        }
+
+        // The host must also allow it
+        if (m_host_budget)
+        {
+            ready = std::max(ready, m_host_budget->nextSlotTime(now));
+        }
+    }
+    return ready;
+}
+
+/** @brief Get the number of tokens of a rate limit at a given time */
+double MqttPublishQueue::availableTokens(const RateLimit& limit, std::chrono::steady_clock::time_point now)
+{
+    double elapsed = std::chrono::duration<double>(now - limit.last_update).count();
+    return std::min(limit.burst, limit.tokens + (elapsed * limit.rate));
+}
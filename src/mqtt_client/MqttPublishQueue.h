@@ -0,0 +1,228 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef MQTTPUBLISHQUEUE_H
+#define MQTTPUBLISHQUEUE_H
+
+#include "HostRateBudget.h"
+#include "IMqttClient.h"
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/** @brief Bounded and rate limited queue of the messages to publish, decoupling the producers from the network */
+class MqttPublishQueue
+{
+  public:
+    /** @brief Class of a message, each class has its own rate limit */
+    enum class PublishClass : int
+    {
+        /** @brief Status of the charge point */
+        STATUS = 0,
+        /** @brief Data of the connectors */
+        DATA,
+        /** @brief Configuration dumps */
+        CONFIG,
+        /** @brief Other messages, only limited by the host rate limit */
+        OTHER
+    };
+
+    /** @brief Number of message classes */
+    static constexpr size_t PUBLISH_CLASS_COUNT = 4u;
+
+    /** @brief Statistics of a message class */
+    struct ClassStats
+    {
+        /** @brief Number of messages sent to the broker */
+        uint64_t sent;
+        /** @brief Number of messages which have been held back by the rate limit of the class */
+        uint64_t throttled;
+        /** @brief Number of retained messages which replaced a pending message on the same topic */
+        uint64_t coalesced;
+    };
+
+    /** @brief Queue statistics */
+    struct Stats
+    {
+        /** @brief Maximum number of messages in the queue */
+        size_t capacity;
+        /** @brief Number of messages in the queue */
+        size_t depth;
+        /** @brief Highest number of messages in the queue */
+        size_t max_depth;
+        /** @brief Number of messages pushed in the queue */
+        uint64_t pushed;
+        /** @brief Number of retained messages which replaced a pending message on the same topic */
+        uint64_t coalesced;
+        /** @brief Number of messages dropped because the queue was full or their publication failed */
+        uint64_t dropped;
+        /** @brief Number of published messages */
+        uint64_t published;
+        /** @brief Number of messages which have been held back by the rate limit of the host */
+        uint64_t host_throttled;
+        /** @brief Statistics by message class */
+        std::array<ClassStats, PUBLISH_CLASS_COUNT> classes;
+    };
+
+    /**
+     * @brief Constructor
+     * @param capacity Maximum number of messages in the queue
+     */
+    MqttPublishQueue(size_t capacity);
+
+    /** @brief Destructor */
+    virtual ~MqttPublishQueue();
+
+    /**
+     * @brief Set the rate limit of a message class (token bucket)
+     * @param publish_class Message class
+     * @param rate Maximum number of messages per second (0 = unlimited)
+     * @param burst Maximum number of messages sent at once
+     */
+    void setRateLimit(PublishClass publish_class, unsigned int rate, unsigned int burst);
+
+    /**
+     * @brief Set the rate limit shared by all the queues of the host using the same limit
+     * @param rate Maximum number of messages per second (0 = unlimited)
+     * @param burst Maximum number of messages sent at once
+     */
+    void setHostRateLimit(unsigned int rate, unsigned int burst);
+
+    /**
+     * @brief Push a message in the queue (never blocks on the network)
+     *        A retained message replaces the pending message on the same topic,
+     *        when the queue is full the oldest non-retained message is dropped
+     * @param topic Topic on which the message must be published
+     * @param message Message to publish
+     * @param qos Desired QoS
+     * @param retained Indicate if the message must be retained on the broker
+     * @param publish_class Class of the message
+     * @return true if the message has been queued, false if it has been dropped
+     */
+    bool push(const std::string& topic,
+              const std::string& message,
+              IMqttClient::QoS   qos,
+              bool               retained,
+              PublishClass       publish_class = PublishClass::OTHER);
+
+    /**
+     * @brief Wait for messages which can be published within the rate limits
+     * @param timeout Maximum time to wait
+     * @return true if messages can be published, false otherwise
+     */
+    bool wait(std::chrono::milliseconds timeout);
+
+    /** @brief Wake up the thread waiting for messages */
+    void wakeUp();
+
+    /**
+     * @brief Publish the pending messages allowed by the rate limits in a single batch, the retained
+     *        messages first, the messages held back keep coalescing until the next flush
+     *        (the retained and QoS 1/2 messages which could not be published are kept for the next flush,
+     *        the QoS 0 messages which could not be published are dropped)
+     * @param client MQTT client to use
+     * @return true if all the messages have been published, false otherwise
+     */
+    bool flush(IMqttClient& client);
+
+    /** @brief Get the queue statistics */
+    Stats stats() const;
+
+  private:
+    /** @brief Message in the queue */
+    struct Entry
+    {
+        /** @brief Message to publish */
+        IMqttClient::Message message;
+        /** @brief Class of the message */
+        PublishClass publish_class;
+        /** @brief Indicate if the message has already been held back by a rate limit */
+        bool throttled;
+    };
+
+    /** @brief Token bucket of a message class */
+    struct RateLimit
+    {
+        /** @brief Number of tokens added per second (0 = unlimited) */
+        double rate;
+        /** @brief Maximum number of tokens */
+        double burst;
+        /** @brief Available tokens */
+        double tokens;
+        /** @brief Last time the tokens have been updated */
+        std::chrono::steady_clock::time_point last_update;
+    };
+
+    /** @brief Maximum number of messages in the queue */
+    const size_t m_capacity;
+    /** @brief Mutex to protect the queue */
+    mutable std::mutex m_mutex;
+    /** @brief Condition variable to wait for messages */
+    std::condition_variable m_cond_var;
+    /** @brief Indicate that the waiting thread must wake up */
+    bool m_wakeup;
+    /** @brief Pending messages in publication order */
+    std::list<Entry> m_messages;
+    /** @brief Pending retained messages by topic */
+    std::unordered_map<std::string, std::list<Entry>::iterator> m_retained;
+    /** @brief Messages being published */
+    std::vector<IMqttClient::Message> m_batch;
+    /** @brief Classes of the messages being published */
+    std::vector<PublishClass> m_batch_classes;
+    /** @brief Rate limits by message class */
+    std::array<RateLimit, PUBLISH_CLASS_COUNT> m_limits;
+    /** @brief Rate limit of the host (null = unlimited) */
+    std::unique_ptr<HostRateBudget> m_host_budget;
+
+    /** @brief Highest number of messages in the queue */
+    size_t m_max_depth;
+    /** @brief Number of messages pushed in the queue */
+    uint64_t m_pushed;
+    /** @brief Number of retained messages which replaced a pending message on the same topic */
+    uint64_t m_coalesced;
+    /** @brief Number of messages dropped */
+    uint64_t m_dropped;
+    /** @brief Number of published messages */
+    uint64_t m_published;
+    /** @brief Number of messages held back by the rate limit of the host */
+    uint64_t m_host_throttled;
+    /** @brief Statistics by message class */
+    std::array<ClassStats, PUBLISH_CLASS_COUNT> m_class_stats;
+
+    /** @brief Make room for a new message, returns false if no message can be dropped */
+    bool makeRoom(bool retained);
+    /** @brief Get the time at which a pending message can be published */
+    std::chrono::steady_clock::time_point nextReadyTime(std::chrono::steady_clock::time_point now) const;
+    /** @brief Get the number of tokens of a rate limit at a given time */
+    static double availableTokens(const RateLimit& limit, std::chrono::steady_clock::time_point now);
+};
+
+#endif // MQTTPUBLISHQUEUE_H
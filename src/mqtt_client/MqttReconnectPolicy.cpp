@@ -0,0 +1,134 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "MqttReconnectPolicy.h"
+
+#include <algorithm>
+
+/** @brief Name of the reconnection rate budget of the host */
+static constexpr const char* HOST_BUDGET_NAME = "reconnect";
+
+/** @brief Constructor */
+MqttReconnectPolicy::MqttReconnectPolicy(std::chrono::milliseconds base_delay, std::chrono::milliseconds max_delay, unsigned int host_rate)
+    : m_base_delay(base_delay),
+      m_max_delay(std::max(base_delay, max_delay)),
+      m_host_budget(HOST_BUDGET_NAME, host_rate, host_rate),
+      m_mutex(),
+      m_cond_var(),
+      m_connection_lost(false),
+      m_cancelled(false),
+      m_failures(0),
+      m_random(std::random_device()()),
+      m_attempts(0),
+      m_successes(0),
+      m_connection_losses(0),
+      m_last_delay(0)
+{
+}
+
+/** @brief Destructor */
+MqttReconnectPolicy::~MqttReconnectPolicy() { }
+
+/** @brief Notify a connection loss, to be called from IMqttClient::IListener::mqttConnectionLost() */
+void MqttReconnectPolicy::connectionLost()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_connection_lost = true;
+    m_connection_losses++;
+    m_cond_var.notify_all();
+}
+
+/** @brief Wait until the connection is lost or the policy is cancelled */
+void MqttReconnectPolicy::waitConnectionLost()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cond_var.wait(lock, [this] { return (m_connection_lost || m_cancelled); });
+}
+
+/** @brief Compute the time of the next connection attempt (non blocking) */
+std::chrono::steady_clock::time_point MqttReconnectPolicy::nextAttemptTime()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // A connection loss notified after this point concerns the next attempt
+    m_connection_lost = false;
+
+    // Full jitter : uniform delay between 0 and the exponential backoff
+    std::chrono::milliseconds backoff = m_max_delay;
+    if (m_failures < 32u)
+    {
+        backoff = std::min(m_max_delay, m_base_delay * (INT64_C(1) << m_failures));
+    }
+    std::uniform_int_distribution<int64_t> distribution(0, backoff.count());
+    auto                                   now  = std::chrono::steady_clock::now();
+    auto                                   time = m_host_budget.reserve(now + std::chrono::milliseconds(distribution(m_random)));
+    m_last_delay                                = std::chrono::duration_cast<std::chrono::milliseconds>(time - now);
+
+    return time;
+}
+
+/** @brief Wait for the time of the next connection attempt */
+bool MqttReconnectPolicy::waitNextAttempt()
+{
+    auto                         time = nextAttemptTime();
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cond_var.wait_until(lock, time, [this] { return m_cancelled; });
+    return !m_cancelled;
+}
+
+/** @brief Notify the result of a connection attempt */
+void MqttReconnectPolicy::attemptDone(bool success)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_attempts++;
+    if (success)
+    {
+        m_successes++;
+        m_failures = 0;
+    }
+    else if (m_failures < 32u)
+    {
+        m_failures++;
+    }
+}
+
+/** @brief Cancel the waits, to be called at the end of the application */
+void MqttReconnectPolicy::cancel()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_cancelled = true;
+    m_cond_var.notify_all();
+}
+
+/** @brief Get the reconnection statistics */
+MqttReconnectPolicy::Stats MqttReconnectPolicy::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats                       stats;
+    stats.attempts          = m_attempts;
+    stats.successes         = m_successes;
+    stats.connection_losses = m_connection_losses;
+    stats.last_delay        = m_last_delay;
+    return stats;
+}
@@ -0,0 +1,133 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef MQTTRECONNECTPOLICY_H
+#define MQTTRECONNECTPOLICY_H
+
+#include "HostRateBudget.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <random>
+
+/**
+ * @brief Reconnection policy of an MQTT client : exponential backoff with full jitter between the attempts,
+ *        and a reconnection rate budget shared by all the clients of the host so that they do not reconnect
+ *        to a restarted broker in synchronized waves
+ */
+class MqttReconnectPolicy
+{
+  public:
+    /** @brief Reconnection statistics */
+    struct Stats
+    {
+        /** @brief Number of connection attempts */
+        uint64_t attempts;
+        /** @brief Number of successful connections */
+        uint64_t successes;
+        /** @brief Number of connection losses */
+        uint64_t connection_losses;
+        /** @brief Delay before the last attempt (backoff and host budget) */
+        std::chrono::milliseconds last_delay;
+    };
+
+    /**
+     * @brief Constructor
+     * @param base_delay Upper bound of the delay before the first attempt, doubled after each failed attempt
+     * @param max_delay Maximum upper bound of the delay between 2 attempts
+     * @param host_rate Maximum number of connection attempts per second for all the clients of the host (0 = unlimited)
+     */
+    MqttReconnectPolicy(std::chrono::milliseconds base_delay, std::chrono::milliseconds max_delay, unsigned int host_rate);
+
+    /** @brief Destructor */
+    virtual ~MqttReconnectPolicy();
+
+    /** @brief Notify a connection loss, to be called from IMqttClient::IListener::mqttConnectionLost() */
+    void connectionLost();
+
+    /** @brief Indicate if the connection has been lost since the beginning of the last attempt */
+    bool isConnectionLost() const { return m_connection_lost; }
+
+    /** @brief Wait until the connection is lost or the policy is cancelled */
+    void waitConnectionLost();
+
+    /**
+     * @brief Begin a connection attempt and compute its time (non blocking)
+     * @return Time at which the next connection attempt can be made
+     */
+    std::chrono::steady_clock::time_point nextAttemptTime();
+
+    /**
+     * @brief Begin a connection attempt and wait for its time
+     * @return true if the connection can be attempted, false if the policy has been cancelled
+     */
+    bool waitNextAttempt();
+
+    /**
+     * @brief Notify the result of a connection attempt
+     * @param success Indicate if the client is connected, the backoff is reset on success
+     */
+    void attemptDone(bool success);
+
+    /** @brief Cancel the waits, to be called at the end of the application */
+    void cancel();
+
+    /** @brief Get the reconnection statistics */
+    Stats stats() const;
+
+  private:
+    /** @brief Upper bound of the delay before the first attempt */
+    const std::chrono::milliseconds m_base_delay;
+    /** @brief Maximum upper bound of the delay between 2 attempts */
+    const std::chrono::milliseconds m_max_delay;
+    /** @brief Reconnection rate budget of the host */
+    HostRateBudget m_host_budget;
+
+    /** @brief Mutex to protect the state */
+    mutable std::mutex m_mutex;
+    /** @brief Condition variable to wait for state changes */
+    std::condition_variable m_cond_var;
+    /** @brief Indicate if the connection has been lost */
+    std::atomic<bool> m_connection_lost;
+    /** @brief Indicate if the policy has been cancelled */
+    bool m_cancelled;
+    /** @brief Number of consecutive failed attempts */
+    unsigned int m_failures;
+    /** @brief Random generator for the jitter */
+    std::mt19937 m_random;
+
+    /** @brief Number of connection attempts */
+    uint64_t m_attempts;
+    /** @brief Number of successful connections */
+    uint64_t m_successes;
+    /** @brief Number of connection losses */
+    uint64_t m_connection_losses;
+    /** @brief Delay before the last attempt */
+    std::chrono::milliseconds m_last_delay;
+};
+
+#endif // MQTTRECONNECTPOLICY_H
@@ -0,0 +1,318 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "MqttTopicRouter.h"
+#include "IMqttClient.h"
+
+#include <charconv>
+
+/** @brief Split a topic into its levels, returns the number of levels or MAX_LEVELS + 1 if there are too many levels */
+static size_t splitTopic(std::string_view topic, std::string_view* levels)
+{
+    size_t count = 0;
+    size_t start = 0;
+    bool   end   = false;
+    while (!end)
+    {
+        if (count == MqttTopicRouter::MAX_LEVELS)
+        {
+            // Too many levels
+            count++;
+            end = true;
+        }
+        else
+        {
+            size_t separator = topic.find('/', start);
+            if (separator == std::string_view::npos)
+            {
+                levels[count] = topic.substr(start);
+                end           = true;
+            }
+            else
+            {
+                levels[count] = topic.substr(start, separator - start);
+                start         = separator + 1u;
+            }
+            count++;
+        }
+    }
+    return count;
+}
+
+/** @brief Constructor */
+MqttTopicRouter::MqttTopicRouter()
+    : m_root(), m_dispatched(0), m_unrouted(0), m_rejected(0), m_total_lookup_time(0), m_max_lookup_time(0)
+{
+}
+
+/** @brief Destructor */
+MqttTopicRouter::~MqttTopicRouter() { }
+
+/** @brief Register a route */
+bool MqttTopicRouter::addRoute(const std::string& filter, Handler handler)
+{
+    bool ret = false;
+
+    // Split filter
+    std::string_view levels[MAX_LEVELS + 1u];
+    size_t           count = splitTopic(filter, levels);
+    if (!filter.empty() && handler && (count <= MAX_LEVELS))
+    {
+        // Walk through the trie and create the missing nodes
+        Node*  node     = &m_root;
+        size_t captures = 0;
+        ret             = true;
+        for (size_t i = 0; ret && (i < count); i++)
+        {
+            const std::string_view& level = levels[i];
+            if (level == "#")
+            {
+                // Multi level wildcard must be the last level
+                if ((i == (count - 1u)) && !node->multi_level)
+                {
+                    node->multi_level = handler;
+                    node              = nullptr;
+                }
+                else
+                {
+                    ret = false;
+                }
+            }
+            else if (level == "+")
+            {
+                captures++;
+                if (captures <= MAX_CAPTURES)
+                {
+                    if (!node->single_level)
+                    {
+                        node->single_level = std::make_unique<Node>();
+                    }
+                    node = node->single_level.get();
+                }
+                else
+                {
+                    ret = false;
+                }
+            }
+            else if ((level.find('+') == std::string_view::npos) && (level.find('#') == std::string_view::npos))
+            {
+                auto it = node->children.find(level);
+                if (it == node->children.end())
+                {
+                    it = node->children.emplace(std::string(level), std::make_unique<Node>()).first;
+                }
+                node = it->second.get();
+            }
+            else
+            {
+                // Wildcards must occupy a whole level
+                ret = false;
+            }
+        }
+
+        // Register handler
+        if (ret && node)
+        {
+            if (!node->handler)
+            {
+                node->handler = handler;
+            }
+            else
+            {
+                ret = false;
+            }
+        }
+    }
+
+    return ret;
+}
+
+/** @brief Dispatch a message to the handler of the matching route */
+bool MqttTopicRouter::dispatch(const char* topic, std::string_view message)
+{
+    bool ret = false;
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Split topic
+    std::string_view levels[MAX_LEVELS + 1u];
+    size_t           count = splitTopic(topic, levels);
+    if (count <= MAX_LEVELS)
+    {
+        // Look for the matching route
+        Captures       captures;
+        const Handler* handler = lookup(m_root, levels, count, 0, captures);
+
+        // Update statistics
+        int64_t lookup_time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        m_total_lookup_time += lookup_time;
+        int64_t max_lookup_time = m_max_lookup_time.load();
+        while ((lookup_time > max_lookup_time) && !m_max_lookup_time.compare_exchange_weak(max_lookup_time, lookup_time)) { }
+
+        if (handler)
+        {
+            // Call handler
+            m_dispatched++;
+            (*handler)(captures, message);
+            ret = true;
+        }
+        else
+        {
+            m_unrouted++;
+        }
+    }
+    else
+    {
+        m_rejected++;
+    }
+
+    return ret;
+}
+
+/** @brief Get the dispatch statistics */
+MqttTopicRouter::Stats MqttTopicRouter::stats() const
+{
+    Stats stats;
+    stats.dispatched        = m_dispatched;
+    stats.unrouted          = m_unrouted;
+    stats.rejected          = m_rejected;
+    stats.total_lookup_time = std::chrono::nanoseconds(m_total_lookup_time.load());
+    stats.max_lookup_time   = std::chrono::nanoseconds(m_max_lookup_time.load());
+    return stats;
+}
+
+/** @brief Check if a topic matches an MQTT topic filter */
+bool MqttTopicRouter::matches(std::string_view filter, std::string_view topic)
+{
+    bool ret = false;
+    bool end = false;
+
+    // Shared subscriptions match the topics of their filter
+    if (isShared(filter))
+    {
+        constexpr std::string_view shared_prefix(SHARED_SUBSCRIPTION_PREFIX);
+        size_t                     group_separator = filter.find('/', shared_prefix.size());
+        if (group_separator != std::string_view::npos)
+        {
+            filter.remove_prefix(group_separator + 1u);
+        }
+        else
+        {
+            end = true;
+        }
+    }
+
+    while (!end)
+    {
+        size_t           filter_separator = filter.find('/');
+        size_t           topic_separator  = topic.find('/');
+        std::string_view filter_level     = filter.substr(0, filter_separator);
+        std::string_view topic_level      = topic.substr(0, topic_separator);
+        if (filter_level == "#")
+        {
+            // Matches the remaining levels and the parent level
+            ret = true;
+            end = true;
+        }
+        else if ((filter_level != "+") && (filter_level != topic_level))
+        {
+            end = true;
+        }
+        else if ((filter_separator == std::string_view::npos) || (topic_separator == std::string_view::npos))
+        {
+            // Last level of the filter or of the topic
+            ret = (filter_separator == topic_separator) || (filter.substr(filter_separator + 1u) == "#");
+            end = true;
+        }
+        else
+        {
+            filter.remove_prefix(filter_separator + 1u);
+            topic.remove_prefix(topic_separator + 1u);
+        }
+    }
+    return ret;
+}
+
+/** @brief Check if a topic filter is a shared subscription filter ($share/<group>/<filter>) */
+bool MqttTopicRouter::isShared(std::string_view filter)
+{
+    constexpr std::string_view shared_prefix(SHARED_SUBSCRIPTION_PREFIX);
+    return (filter.substr(0, shared_prefix.size()) == shared_prefix);
+}
+
+/** @brief Look for the handler matching the topic levels */
+const MqttTopicRouter::Handler* MqttTopicRouter::lookup(
+    const Node& node, const std::string_view* levels, size_t count, size_t level, Captures& captures) const
+{
+    const Handler* handler = nullptr;
+
+    if (level == count)
+    {
+        // End of topic, '#' also matches the parent level
+        if (node.handler)
+        {
+            handler = &node.handler;
+        }
+        else if (node.multi_level)
+        {
+            handler = &node.multi_level;
+        }
+    }
+    else
+    {
+        // Literal level
+        const std::string_view& current = levels[level];
+        auto                    it      = node.children.find(current);
+        if (it != node.children.end())
+        {
+            handler = lookup(*it->second, levels, count, level + 1u, captures);
+        }
+
+        // Single level wildcard
+        if (!handler && node.single_level)
+        {
+            size_t       index           = captures.m_count;
+            const char*  end             = current.data() + current.size();
+            unsigned int value           = 0;
+            auto         result          = std::from_chars(current.data(), end, value);
+            captures.m_levels[index]     = current;
+            captures.m_is_integer[index] = (!current.empty() && (result.ec == std::errc()) && (result.ptr == end));
+            captures.m_integers[index]   = (captures.m_is_integer[index] ? value : 0u);
+            captures.m_count++;
+            handler = lookup(*node.single_level, levels, count, level + 1u, captures);
+            if (!handler)
+            {
+                captures.m_count--;
+            }
+        }
+
+        // Multi level wildcard
+        if (!handler && node.multi_level)
+        {
+            handler = &node.multi_level;
+        }
+    }
+
+    return handler;
+}
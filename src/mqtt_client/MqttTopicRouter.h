@@ -0,0 +1,170 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef MQTTTOPICROUTER_H
+#define MQTTTOPICROUTER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+
+/** @brief Route the incoming MQTT messages to their handlers using a precompiled trie of topic levels */
+class MqttTopicRouter
+{
+  public:
+    /** @brief Maximum number of levels in a routed topic */
+    static constexpr size_t MAX_LEVELS = 16u;
+    /** @brief Maximum number of single level wildcards in a route */
+    static constexpr size_t MAX_CAPTURES = 4u;
+
+    /** @brief Topic levels captured by the single level wildcards ('+') of a route */
+    class Captures
+    {
+      public:
+        /** @brief Constructor */
+        Captures() : m_count(0), m_levels(), m_integers(), m_is_integer() { }
+
+        /** @brief Number of captured levels */
+        size_t size() const { return m_count; }
+
+        /** @brief Get a captured level */
+        std::string_view operator[](size_t index) const { return m_levels[index]; }
+
+        /** @brief Indicate if a captured level is an unsigned integer */
+        bool isInteger(size_t index) const { return m_is_integer[index]; }
+
+        /** @brief Get a captured level as an unsigned integer (0 if the level is not an integer) */
+        unsigned int integer(size_t index) const { return m_integers[index]; }
+
+      private:
+        friend class MqttTopicRouter;
+
+        /** @brief Number of captured levels */
+        size_t m_count;
+        /** @brief Captured levels */
+        std::array<std::string_view, MAX_CAPTURES> m_levels;
+        /** @brief Captured levels parsed as unsigned integers */
+        std::array<unsigned int, MAX_CAPTURES> m_integers;
+        /** @brief Indicate which captured levels are unsigned integers */
+        std::array<bool, MAX_CAPTURES> m_is_integer;
+    };
+
+    /** @brief Handler for a route */
+    using Handler = std::function<void(const Captures& captures, std::string_view message)>;
+
+    /** @brief Dispatch statistics */
+    struct Stats
+    {
+        /** @brief Number of messages dispatched to a handler */
+        uint64_t dispatched;
+        /** @brief Number of messages which did not match any route */
+        uint64_t unrouted;
+        /** @brief Number of messages rejected because their topic has too many levels */
+        uint64_t rejected;
+        /** @brief Cumulated time spent in route lookup */
+        std::chrono::nanoseconds total_lookup_time;
+        /** @brief Longest route lookup */
+        std::chrono::nanoseconds max_lookup_time;
+    };
+
+    /** @brief Constructor */
+    MqttTopicRouter();
+
+    /** @brief Destructor */
+    virtual ~MqttTopicRouter();
+
+    /**
+     * @brief Register a route
+     * @param filter MQTT topic filter of the route, '+' levels are captured and '#' must be the last level
+     * @param handler Handler to call when a message matches the route
+     * @return true if the route has been registered, false if the filter is invalid or already routed
+     */
+    bool addRoute(const std::string& filter, Handler handler);
+
+    /**
+     * @brief Dispatch a message to the handler of the matching route
+     *        (literal levels have precedence over '+' which has precedence over '#')
+     * @param topic Topic on which the message has been received
+     * @param message Received message
+     * @return true if a route has been found, false otherwise
+     */
+    bool dispatch(const char* topic, std::string_view message);
+
+    /** @brief Get the dispatch statistics */
+    Stats stats() const;
+
+    /**
+     * @brief Check if a topic matches an MQTT topic filter
+     * @param filter MQTT topic filter, shared subscription filters match the topics of their inner filter
+     * @param topic Topic
+     * @return true if the topic matches the filter, false otherwise
+     */
+    static bool matches(std::string_view filter, std::string_view topic);
+
+    /**
+     * @brief Check if a topic filter is a shared subscription filter ($share/<group>/<filter>)
+     * @param filter MQTT topic filter
+     * @return true if each message must be delivered to a single subscriber of the group, false otherwise
+     */
+    static bool isShared(std::string_view filter);
+
+  private:
+    /** @brief Node of the trie */
+    struct Node
+    {
+        /** @brief Children for literal levels */
+        std::map<std::string, std::unique_ptr<Node>, std::less<>> children;
+        /** @brief Child for the single level wildcard */
+        std::unique_ptr<Node> single_level;
+        /** @brief Handler when the topic ends on this node */
+        Handler handler;
+        /** @brief Handler for the multi level wildcard */
+        Handler multi_level;
+    };
+
+    /** @brief Root node */
+    Node m_root;
+
+    /** @brief Number of messages dispatched to a handler */
+    std::atomic<uint64_t> m_dispatched;
+    /** @brief Number of messages which did not match any route */
+    std::atomic<uint64_t> m_unrouted;
+    /** @brief Number of messages rejected because their topic has too many levels */
+    std::atomic<uint64_t> m_rejected;
+    /** @brief Cumulated time spent in route lookup in ns */
+    std::atomic<int64_t> m_total_lookup_time;
+    /** @brief Longest route lookup in ns */
+    std::atomic<int64_t> m_max_lookup_time;
+
+    /** @brief Look for the handler matching the topic levels */
+    const Handler* lookup(const Node& node, const std::string_view* levels, size_t count, size_t level, Captures& captures) const;
+};
+
+#endif // MQTTTOPICROUTER_H
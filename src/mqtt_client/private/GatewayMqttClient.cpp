@@ -0,0 +1,366 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "GatewayMqttClient.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+
+/** @brief Constructor */
+GatewayMqttClient::GatewayMqttClient(const std::string& id)
+    : m_id(id),
+      m_url(),
+      m_socket(-1),
+      m_connected(false),
+      m_listener(nullptr),
+      m_will(),
+      m_timeout(1),
+      m_send_mutex(),
+      m_request_mutex(),
+      m_ack_mutex(),
+      m_ack_cond_var(),
+      m_ack_received(false),
+      m_ack_result(false),
+      m_request_seq(0),
+      m_rx_thread(),
+      m_publish_stats()
+{
+}
+
+/** @brief Destructor */
+GatewayMqttClient::~GatewayMqttClient()
+{
+    close();
+}
+
+/** @copydoc bool IMqttClient::setWill(const std::string&, const std::string&, QoS, bool) */
+bool GatewayMqttClient::setWill(const std::string& topic, const std::string& message, QoS qos, bool retained)
+{
+    bool ret = false;
+
+    // Check if already connected
+    if (m_socket < 0)
+    {
+        // Save the will frame, it will be sent just before the connection request
+        uint8_t flags = static_cast<uint8_t>(qos) & GatewayProtocol::FLAG_QOS_MASK;
+        if (retained)
+        {
+            flags |= GatewayProtocol::FLAG_RETAINED;
+        }
+        m_will.clear();
+        ret = GatewayProtocol::serialize(m_will, GatewayProtocol::FrameType::WILL, flags, topic, message);
+    }
+
+    return ret;
+}
+
+/** @copydoc bool IMqttClient::connect(const std::string&, bool, std::chrono::seconds, std::chrono::seconds) */
+bool GatewayMqttClient::connect(const std::string& url, bool clean_session, std::chrono::seconds timeout, std::chrono::seconds keep_alive)
+{
+    (void)keep_alive;
+
+    bool ret = false;
+
+    // Check if already connected
+    if ((m_socket < 0) && (url.find(GATEWAY_URL_SCHEME) == 0))
+    {
+        // Connect to the gateway's socket
+        std::string        path = url.substr(strlen(GATEWAY_URL_SCHEME));
+        struct sockaddr_un address;
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (path.size() < sizeof(address.sun_path))
+        {
+            path.copy(address.sun_path, path.size());
+            m_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+            if ((m_socket >= 0) && (::connect(m_socket, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) == 0))
+            {
+                // Start reception
+                m_timeout   = timeout;
+                m_rx_thread = std::thread(&GatewayMqttClient::rxThread, this);
+
+                // Connection request, the gateway acknowledges once it is connected to the broker
+                uint8_t flags = (clean_session ? GatewayProtocol::FLAG_CLEAN_SESSION : 0u);
+                if (request(m_will, GatewayProtocol::FrameType::CONNECT, flags, m_id))
+                {
+                    m_url       = url;
+                    m_connected = true;
+                    ret         = true;
+                }
+            }
+            if (!ret)
+            {
+                close();
+            }
+        }
+    }
+
+    return ret;
+}
+
+/** @copydoc bool IMqttClient::close() */
+bool GatewayMqttClient::close()
+{
+    bool ret = false;
+
+    // Check if connected
+    if (m_socket >= 0)
+    {
+        // Clean disconnection
+        if (m_connected.exchange(false))
+        {
+            std::string frame;
+            GatewayProtocol::serialize(frame, GatewayProtocol::FrameType::DISCONNECT, 0, "", "");
+            send(frame);
+        }
+
+        // Stop reception
+        shutdown(m_socket, SHUT_RDWR);
+        if (m_rx_thread.joinable())
+        {
+            if (m_rx_thread.get_id() == std::this_thread::get_id())
+            {
+                m_rx_thread.detach();
+            }
+            else
+            {
+                m_rx_thread.join();
+            }
+        }
+
+        // Release resources
+        ::close(m_socket);
+        m_socket = -1;
+        m_url    = "";
+
+        ret = true;
+    }
+
+    return ret;
+}
+
+/** @copydoc bool IMqttClient::publish(const std::string&, const std::string&, QoS, bool) */
+bool GatewayMqttClient::publish(const std::string& topic, const std::string& message, QoS qos, bool retained)
+{
+    bool ret = false;
+
+    // Check if connected
+    if (m_connected)
+    {
+        uint8_t flags = static_cast<uint8_t>(qos) & GatewayProtocol::FLAG_QOS_MASK;
+        if (retained)
+        {
+            flags |= GatewayProtocol::FLAG_RETAINED;
+        }
+        std::string frame;
+        if (GatewayProtocol::serialize(frame, GatewayProtocol::FrameType::PUBLISH, flags, topic, message))
+        {
+            ret = send(frame);
+        }
+    }
+
+    return ret;
+}
+
+/** @copydoc size_t IMqttClient::publishBatch(const Message*, size_t, bool*) */
+size_t GatewayMqttClient::publishBatch(const Message* messages, size_t count, bool* results)
+{
+    size_t published = 0;
+    if (results)
+    {
+        std::fill(results, results + count, false);
+    }
+
+    // Check if connected
+    if (m_connected && messages && (count != 0))
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        // The whole batch is sent with a single write, the gateway handles the acknowledges with the broker
+        std::string       frames;
+        std::vector<bool> serialized(count, false);
+        size_t            serialized_count = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            const Message& message = messages[i];
+            uint8_t        flags   = static_cast<uint8_t>(message.qos) & GatewayProtocol::FLAG_QOS_MASK;
+            if (message.retained)
+            {
+                flags |= GatewayProtocol::FLAG_RETAINED;
+            }
+            if (GatewayProtocol::serialize(frames, GatewayProtocol::FrameType::PUBLISH, flags, message.topic, message.payload))
+            {
+                serialized[i] = true;
+                serialized_count++;
+            }
+        }
+        if ((serialized_count != 0) && send(frames))
+        {
+            published = serialized_count;
+            if (results)
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    results[i] = serialized[i];
+                }
+            }
+        }
+
+        // Update statistics
+        m_publish_stats.update(count, published, start);
+    }
+
+    return published;
+}
+
+/** @copydoc PublishStats IMqttClient::publishStats() const */
+IMqttClient::PublishStats GatewayMqttClient::publishStats() const
+{
+    return m_publish_stats.get();
+}
+
+/** @copydoc bool IMqttClient::subscribe(const std::string&, QoS) */
+bool GatewayMqttClient::subscribe(const std::string& topic, QoS qos)
+{
+    bool ret = false;
+
+    // Check if connected
+    if (m_connected)
+    {
+        ret = request("", GatewayProtocol::FrameType::SUBSCRIBE, static_cast<uint8_t>(qos) & GatewayProtocol::FLAG_QOS_MASK, topic);
+    }
+
+    return ret;
+}
+
+/** @copydoc bool IMqttClient::unsubscribe(const std::string&) */
+bool GatewayMqttClient::unsubscribe(const std::string& topic)
+{
+    bool ret = false;
+
+    // Check if connected
+    if (m_connected)
+    {
+        ret = request("", GatewayProtocol::FrameType::UNSUBSCRIBE, 0, topic);
+    }
+
+    return ret;
+}
+
+/** @brief Send a request frame (after the given prefix frames) and wait for its acknowledge */
+bool GatewayMqttClient::request(std::string frames, GatewayProtocol::FrameType type, uint8_t flags, std::string_view topic)
+{
+    bool ret = false;
+
+    // The request carries a sequence number which is echoed in the acknowledge, so that a late
+    // acknowledge of a timed out request can not be taken for the acknowledge of this one
+    std::lock_guard<std::mutex> request_lock(m_request_mutex);
+    uint32_t                    seq = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_ack_mutex);
+        m_request_seq++;
+        seq            = m_request_seq;
+        m_ack_received = false;
+        m_ack_result   = false;
+    }
+    if (GatewayProtocol::serialize(frames, type, flags, topic, std::string_view(reinterpret_cast<const char*>(&seq), sizeof(seq))) &&
+        send(frames))
+    {
+        std::unique_lock<std::mutex> lock(m_ack_mutex);
+        if (m_ack_cond_var.wait_for(lock, m_timeout, [this] { return m_ack_received; }))
+        {
+            ret = m_ack_result;
+        }
+    }
+
+    return ret;
+}
+
+/** @brief Send a frame */
+bool GatewayMqttClient::send(const std::string& frame)
+{
+    std::lock_guard<std::mutex> lock(m_send_mutex);
+    return GatewayProtocol::send(m_socket, frame);
+}
+
+/** @brief Reception thread */
+void GatewayMqttClient::rxThread()
+{
+    GatewayProtocol::Reader reader;
+    GatewayProtocol::Frame  frame;
+    std::string             topic;
+    while (reader.read(m_socket) && !reader.isCorrupted())
+    {
+        while (reader.next(frame))
+        {
+            if (frame.type == GatewayProtocol::FrameType::ACK)
+            {
+                // Wake up the pending request, acknowledges of older requests are ignored
+                uint32_t seq = 0;
+                if (frame.payload.size() == sizeof(seq))
+                {
+                    memcpy(&seq, frame.payload.data(), sizeof(seq));
+                }
+                std::lock_guard<std::mutex> lock(m_ack_mutex);
+                if ((seq == m_request_seq) && !m_ack_received)
+                {
+                    m_ack_received = true;
+                    m_ack_result   = ((frame.flags & GatewayProtocol::FLAG_SUCCESS) != 0);
+                    m_ack_cond_var.notify_one();
+                }
+            }
+            else if ((frame.type == GatewayProtocol::FrameType::MESSAGE) && m_listener)
+            {
+                // Notify listener, the payload is not copied
+                topic.assign(frame.topic);
+                m_listener->mqttMessageViewReceived(topic.c_str(),
+                                                    frame.payload,
+                                                    static_cast<QoS>(frame.flags & GatewayProtocol::FLAG_QOS_MASK),
+                                                    ((frame.flags & GatewayProtocol::FLAG_RETAINED) != 0));
+            }
+            else
+            {
+                // Ignore frame
+            }
+        }
+    }
+
+    // Wake up the pending request
+    {
+        std::lock_guard<std::mutex> lock(m_ack_mutex);
+        m_ack_received = true;
+        m_ack_result   = false;
+        m_ack_cond_var.notify_one();
+    }
+
+    // Notify the connection loss
+    if (m_connected.exchange(false) && m_listener)
+    {
+        m_listener->mqttConnectionLost();
+    }
+}
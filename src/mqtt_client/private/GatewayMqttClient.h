@@ -0,0 +1,135 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef GATEWAYMQTTCLIENT_H
+#define GATEWAYMQTTCLIENT_H
+
+#include "GatewayProtocol.h"
+#include "IMqttClient.h"
+#include "PublishStatsCounter.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/** @brief MQTT client implementation sharing the broker connection of a local MQTT gateway through a Unix domain socket */
+class GatewayMqttClient : public IMqttClient
+{
+  public:
+    /**
+     * @brief Constructor
+     * @param id Unique id
+     */
+    GatewayMqttClient(const std::string& id);
+
+    /** @brief Destructor */
+    virtual ~GatewayMqttClient();
+
+    /** @copydoc void IMqttClient::registerListener(IListener&) */
+    void registerListener(IListener& listener) override { m_listener = &listener; }
+
+    /** @copydoc bool IMqttClient::setWill(const std::string&, const std::string&, QoS, bool) */
+    bool setWill(const std::string& topic, const std::string& message, QoS qos, bool retained) override;
+
+    /** @copydoc bool IMqttClient::setProtocolOptions(const ProtocolOptions&) */
+    bool setProtocolOptions(const ProtocolOptions& options) override
+    {
+        // Ignored, broker connection is owned by the gateway
+        (void)options;
+        return true;
+    }
+
+    /** @copydoc bool IMqttClient::connect(const std::string&, bool, std::chrono::seconds, std::chrono::seconds) */
+    bool connect(const std::string& url, bool clean_session, std::chrono::seconds timeout, std::chrono::seconds keep_alive) override;
+
+    /** @copydoc bool IMqttClient::close() */
+    bool close() override;
+
+    /** @copydoc bool IMqttClient::isConnected() const */
+    bool isConnected() const override { return m_connected; }
+
+    /** @copydoc std::string IMqttClient::brokerUrl() const */
+    std::string brokerUrl() const override { return m_url; }
+
+    /** @copydoc bool IMqttClient::publish(const std::string&, const std::string&, QoS, bool) */
+    bool publish(const std::string& topic, const std::string& message, QoS qos, bool retained) override;
+
+    /** @copydoc size_t IMqttClient::publishBatch(const Message*, size_t, bool*) */
+    size_t publishBatch(const Message* messages, size_t count, bool* results) override;
+
+    /** @copydoc PublishStats IMqttClient::publishStats() const */
+    PublishStats publishStats() const override;
+
+    /** @copydoc bool IMqttClient::subscribe(const std::string&, QoS) */
+    bool subscribe(const std::string& topic, QoS qos) override;
+
+    /** @copydoc bool IMqttClient::unsubscribe(const std::string&) */
+    bool unsubscribe(const std::string& topic) override;
+
+  private:
+    /** @brief Unique id */
+    std::string m_id;
+    /** @brief Gateway's URL */
+    std::string m_url;
+    /** @brief Socket to the gateway */
+    int m_socket;
+    /** @brief Indicate if the client is connected */
+    std::atomic<bool> m_connected;
+    /** @brief Listener */
+    IListener* m_listener;
+    /** @brief Will message frame */
+    std::string m_will;
+    /** @brief Request timeout */
+    std::chrono::seconds m_timeout;
+
+    /** @brief Mutex to serialize the frames sent on the socket */
+    std::mutex m_send_mutex;
+    /** @brief Mutex to serialize the requests */
+    std::mutex m_request_mutex;
+    /** @brief Mutex to protect the acknowledge */
+    std::mutex m_ack_mutex;
+    /** @brief Condition variable to wait for the acknowledge */
+    std::condition_variable m_ack_cond_var;
+    /** @brief Indicate that an acknowledge has been received */
+    bool m_ack_received;
+    /** @brief Result of the last acknowledge */
+    bool m_ack_result;
+    /** @brief Sequence number of the pending request, echoed by the gateway in its acknowledge */
+    uint32_t m_request_seq;
+    /** @brief Reception thread */
+    std::thread m_rx_thread;
+
+    /** @brief Batch publish statistics */
+    PublishStatsCounter m_publish_stats;
+
+    /** @brief Send a request frame (after the given prefix frames) and wait for its acknowledge */
+    bool request(std::string frames, GatewayProtocol::FrameType type, uint8_t flags, std::string_view topic);
+    /** @brief Send a frame */
+    bool send(const std::string& frame);
+    /** @brief Reception thread */
+    void rxThread();
+};
+
+#endif // GATEWAYMQTTCLIENT_H
@@ -0,0 +1,192 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "LoopbackBroker.h"
+#include "MqttTopicRouter.h"
+
+/** @brief Get the broker associated to an URL, it is created on first use */
+LoopbackBroker& LoopbackBroker::get(const std::string& url)
+{
+    static std::mutex                                             s_mutex;
+    static std::map<std::string, std::unique_ptr<LoopbackBroker>> s_brokers;
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    std::unique_ptr<LoopbackBroker>& broker = s_brokers[url];
+    if (!broker)
+    {
+        broker = std::make_unique<LoopbackBroker>();
+    }
+    return *broker;
+}
+
+/** @brief Constructor */
+LoopbackBroker::LoopbackBroker()
+    : m_mutex(),
+      m_cond_var(),
+      m_stop(false),
+      m_sessions(),
+      m_retained(),
+      m_shared_counters(),
+      m_deliveries(),
+      m_thread(&LoopbackBroker::deliveryThread, this)
+{
+}
+
+/** @brief Destructor */
+LoopbackBroker::~LoopbackBroker()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+        m_cond_var.notify_one();
+    }
+    m_thread.join();
+}
+
+/** @brief Connect a client */
+std::shared_ptr<LoopbackBroker::Session> LoopbackBroker::connect(IMqttClient::IListener* listener)
+{
+    auto session = std::make_shared<Session>(listener);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_sessions.insert(session);
+
+    return session;
+}
+
+/** @brief Disconnect a client, waits for the end of an ongoing delivery to the client */
+void LoopbackBroker::disconnect(const std::shared_ptr<Session>& session)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_sessions.erase(session);
+    }
+    std::lock_guard<std::recursive_mutex> lock(session->mutex);
+    session->connected = false;
+}
+
+/** @brief Publish a message, the message is delivered asynchronously to the subscribers */
+void LoopbackBroker::publish(const std::string& topic, const std::string& message, IMqttClient::QoS qos, bool retained)
+{
+    auto shared_message = std::make_shared<const std::string>(message);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Retained message, an empty message removes the retained message
+    if (retained)
+    {
+        if (message.empty())
+        {
+            m_retained.erase(topic);
+        }
+        else
+        {
+            m_retained[topic] = std::make_pair(shared_message, qos);
+        }
+    }
+
+    // Look for the subscribers, a session receives the message only once even if several of its filters match,
+    // the members of a shared subscription are only collected since a single one of them receives the message
+    std::map<std::string_view, std::vector<std::shared_ptr<Session>>> shared_subscriptions;
+    for (const auto& session : m_sessions)
+    {
+        bool delivered = false;
+        for (const std::string& filter : session->filters)
+        {
+            if (MqttTopicRouter::matches(filter, topic))
+            {
+                if (MqttTopicRouter::isShared(filter))
+                {
+                    shared_subscriptions[filter].push_back(session);
+                }
+                else if (!delivered)
+                {
+                    m_deliveries.push_back({session, topic, shared_message, qos, false});
+                    delivered = true;
+                }
+            }
+        }
+    }
+    for (const auto& [filter, members] : shared_subscriptions)
+    {
+        size_t& counter = m_shared_counters[std::string(filter)];
+        m_deliveries.push_back({members[counter % members.size()], topic, shared_message, qos, false});
+        counter++;
+    }
+    m_cond_var.notify_one();
+}
+
+/** @brief Subscribe a client to a topic filter, the matching retained messages are delivered to the client */
+void LoopbackBroker::subscribe(const std::shared_ptr<Session>& session, const std::string& filter)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    session->filters.insert(filter);
+
+    // Like MQTT 5 brokers, the retained messages are not sent on shared subscriptions
+    if (!MqttTopicRouter::isShared(filter))
+    {
+        for (const auto& retained : m_retained)
+        {
+            if (MqttTopicRouter::matches(filter, retained.first))
+            {
+                m_deliveries.push_back({session, retained.first, retained.second.first, retained.second.second, true});
+            }
+        }
+        m_cond_var.notify_one();
+    }
+}
+
+/** @brief Unsubscribe a client from a topic filter */
+bool LoopbackBroker::unsubscribe(const std::shared_ptr<Session>& session, const std::string& filter)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return (session->filters.erase(filter) != 0);
+}
+
+/** @brief Delivery thread */
+void LoopbackBroker::deliveryThread()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stop)
+    {
+        m_cond_var.wait(lock, [this] { return (m_stop || !m_deliveries.empty()); });
+        while (!m_deliveries.empty())
+        {
+            Delivery delivery = std::move(m_deliveries.front());
+            m_deliveries.pop_front();
+
+            // Deliver without holding the broker's lock so that the listeners can publish
+            lock.unlock();
+            {
+                std::lock_guard<std::recursive_mutex> session_lock(delivery.session->mutex);
+                if (delivery.session->connected && delivery.session->listener)
+                {
+                    delivery.session->listener->mqttMessageViewReceived(
+                        delivery.topic.c_str(), *delivery.message, delivery.qos, delivery.retained);
+                }
+            }
+            lock.lock();
+        }
+    }
+}
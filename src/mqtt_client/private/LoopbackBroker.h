@@ -0,0 +1,151 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef LOOPBACKBROKER_H
+#define LOOPBACKBROKER_H
+
+#include "IMqttClient.h"
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+/** @brief URL scheme of the in-process loopback brokers */
+#define LOOPBACK_URL_SCHEME "loop://"
+
+/** @brief In-process MQTT broker stand-in shared by the loopback clients using the same URL */
+class LoopbackBroker
+{
+  public:
+    /** @brief Connection of a loopback client */
+    struct Session
+    {
+        /** @brief Constructor */
+        Session(IMqttClient::IListener* session_listener) : mutex(), listener(session_listener), connected(true), filters() { }
+
+        /** @brief Mutex held during the deliveries to the listener */
+        std::recursive_mutex mutex;
+        /** @brief Listener */
+        IMqttClient::IListener* listener;
+        /** @brief Indicate if the session is connected */
+        bool connected;
+        /** @brief Topic filters (protected by the broker's mutex) */
+        std::set<std::string> filters;
+    };
+
+    /**
+     * @brief Get the broker associated to an URL, it is created on first use
+     * @param url URL of the broker
+     * @return Broker
+     */
+    static LoopbackBroker& get(const std::string& url);
+
+    /** @brief Constructor */
+    LoopbackBroker();
+
+    /** @brief Destructor */
+    virtual ~LoopbackBroker();
+
+    /**
+     * @brief Connect a client
+     * @param listener Listener of the client
+     * @return Session of the client
+     */
+    std::shared_ptr<Session> connect(IMqttClient::IListener* listener);
+
+    /**
+     * @brief Disconnect a client, waits for the end of an ongoing delivery to the client
+     * @param session Session of the client
+     */
+    void disconnect(const std::shared_ptr<Session>& session);
+
+    /**
+     * @brief Publish a message, the message is delivered asynchronously to the subscribers
+     * @param topic Topic on which the message must be published
+     * @param message Message to publish
+     * @param qos Desired QoS
+     * @param retained Indicate if the message must be retained on the broker
+     */
+    void publish(const std::string& topic, const std::string& message, IMqttClient::QoS qos, bool retained);
+
+    /**
+     * @brief Subscribe a client to a topic filter, the matching retained messages are delivered to the client
+     *        unless the filter is a shared subscription filter
+     * @param session Session of the client
+     * @param filter Topic filter
+     */
+    void subscribe(const std::shared_ptr<Session>& session, const std::string& filter);
+
+    /**
+     * @brief Unsubscribe a client from a topic filter
+     * @param session Session of the client
+     * @param filter Topic filter
+     * @return true if the client was subscribed to the filter, false otherwise
+     */
+    bool unsubscribe(const std::shared_ptr<Session>& session, const std::string& filter);
+
+  private:
+    /** @brief Message waiting to be delivered */
+    struct Delivery
+    {
+        /** @brief Destination */
+        std::shared_ptr<Session> session;
+        /** @brief Topic */
+        std::string topic;
+        /** @brief Message shared between the destinations */
+        std::shared_ptr<const std::string> message;
+        /** @brief QoS */
+        IMqttClient::QoS qos;
+        /** @brief Retained flag */
+        bool retained;
+    };
+
+    /** @brief Mutex to protect the sessions, retained messages and pending deliveries */
+    std::mutex m_mutex;
+    /** @brief Condition variable to wake up the delivery thread */
+    std::condition_variable m_cond_var;
+    /** @brief Indicate that the delivery thread must stop */
+    bool m_stop;
+    /** @brief Connected sessions */
+    std::set<std::shared_ptr<Session>> m_sessions;
+    /** @brief Retained messages by topic */
+    std::map<std::string, std::pair<std::shared_ptr<const std::string>, IMqttClient::QoS>> m_retained;
+    /** @brief Round robin counters of the shared subscriptions by filter */
+    std::map<std::string, size_t> m_shared_counters;
+    /** @brief Pending deliveries */
+    std::deque<Delivery> m_deliveries;
+    /** @brief Delivery thread, the listeners are always called outside of the broker's lock */
+    std::thread m_thread;
+
+    /** @brief Delivery thread */
+    void deliveryThread();
+};
+
+#endif // LOOPBACKBROKER_H
@@ -0,0 +1,175 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "LoopbackMqttClient.h"
+
+#include <algorithm>
+
+/** @brief Constructor */
+LoopbackMqttClient::LoopbackMqttClient(const std::string& id)
+    : m_id(id), m_url(), m_listener(nullptr), m_broker(nullptr), m_session(), m_has_will(false), m_will(), m_publish_stats()
+{
+}
+
+/** @brief Destructor, the will message is published if the client has not been closed */
+LoopbackMqttClient::~LoopbackMqttClient()
+{
+    if (m_session)
+    {
+        m_broker->disconnect(m_session);
+        if (m_has_will)
+        {
+            m_broker->publish(m_will.topic, m_will.payload, m_will.qos, m_will.retained);
+        }
+    }
+}
+
+/** @copydoc bool IMqttClient::setWill(const std::string&, const std::string&, QoS, bool) */
+bool LoopbackMqttClient::setWill(const std::string& topic, const std::string& message, QoS qos, bool retained)
+{
+    bool ret = false;
+
+    // Check if already connected
+    if (!m_session)
+    {
+        m_will     = {topic, message, qos, retained};
+        m_has_will = true;
+        ret        = true;
+    }
+
+    return ret;
+}
+
+/** @copydoc bool IMqttClient::connect(const std::string&, bool, std::chrono::seconds, std::chrono::seconds) */
+bool LoopbackMqttClient::connect(const std::string& url, bool clean_session, std::chrono::seconds timeout, std::chrono::seconds keep_alive)
+{
+    (void)clean_session;
+    (void)timeout;
+    (void)keep_alive;
+
+    bool ret = false;
+
+    // Check if already connected
+    if (!m_session && (url.find(LOOPBACK_URL_SCHEME) == 0))
+    {
+        m_broker  = &LoopbackBroker::get(url);
+        m_session = m_broker->connect(m_listener);
+        m_url     = url;
+        ret       = true;
+    }
+
+    return ret;
+}
+
+/** @copydoc bool IMqttClient::close() */
+bool LoopbackMqttClient::close()
+{
+    bool ret = false;
+
+    // Check if connected
+    if (m_session)
+    {
+        // Clean disconnection, the will message is discarded
+        m_broker->disconnect(m_session);
+        m_session.reset();
+        m_url = "";
+        ret   = true;
+    }
+
+    return ret;
+}
+
+/** @copydoc bool IMqttClient::publish(const std::string&, const std::string&, QoS, bool) */
+bool LoopbackMqttClient::publish(const std::string& topic, const std::string& message, QoS qos, bool retained)
+{
+    bool ret = false;
+
+    // Check if connected
+    if (m_session)
+    {
+        m_broker->publish(topic, message, qos, retained);
+        ret = true;
+    }
+
+    return ret;
+}
+
+/** @copydoc size_t IMqttClient::publishBatch(const Message*, size_t, bool*) */
+size_t LoopbackMqttClient::publishBatch(const Message* messages, size_t count, bool* results)
+{
+    size_t published = 0;
+    if (results)
+    {
+        std::fill(results, results + count, false);
+    }
+
+    // Check if connected
+    if (m_session && messages && (count != 0))
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; i++)
+        {
+            m_broker->publish(messages[i].topic, messages[i].payload, messages[i].qos, messages[i].retained);
+        }
+        published = count;
+        if (results)
+        {
+            std::fill(results, results + count, true);
+        }
+        m_publish_stats.update(count, published, start);
+    }
+
+    return published;
+}
+
+/** @copydoc bool IMqttClient::subscribe(const std::string&, QoS) */
+bool LoopbackMqttClient::subscribe(const std::string& topic, QoS qos)
+{
+    (void)qos;
+
+    bool ret = false;
+
+    // Check if connected
+    if (m_session)
+    {
+        m_broker->subscribe(m_session, topic);
+        ret = true;
+    }
+
+    return ret;
+}
+
+/** @copydoc bool IMqttClient::unsubscribe(const std::string&) */
+bool LoopbackMqttClient::unsubscribe(const std::string& topic)
+{
+    bool ret = false;
+
+    // Check if connected
+    if (m_session)
+    {
+        ret = m_broker->unsubscribe(m_session, topic);
+    }
+
+    return ret;
+}
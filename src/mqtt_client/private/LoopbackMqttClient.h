@@ -0,0 +1,105 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef LOOPBACKMQTTCLIENT_H
+#define LOOPBACKMQTTCLIENT_H
+
+#include "IMqttClient.h"
+#include "LoopbackBroker.h"
+#include "PublishStatsCounter.h"
+
+/** @brief MQTT client implementation connected to an in-process loopback broker (loop://name URLs) */
+class LoopbackMqttClient : public IMqttClient
+{
+  public:
+    /**
+     * @brief Constructor
+     * @param id Unique id
+     */
+    LoopbackMqttClient(const std::string& id);
+
+    /** @brief Destructor, the will message is published if the client has not been closed */
+    virtual ~LoopbackMqttClient();
+
+    /** @copydoc void IMqttClient::registerListener(IListener&) */
+    void registerListener(IListener& listener) override { m_listener = &listener; }
+
+    /** @copydoc bool IMqttClient::setWill(const std::string&, const std::string&, QoS, bool) */
+    bool setWill(const std::string& topic, const std::string& message, QoS qos, bool retained) override;
+
+    /** @copydoc bool IMqttClient::setProtocolOptions(const ProtocolOptions&) */
+    bool setProtocolOptions(const ProtocolOptions& options) override
+    {
+        // Ignored, no wire protocol
+        (void)options;
+        return true;
+    }
+
+    /** @copydoc bool IMqttClient::connect(const std::string&, bool, std::chrono::seconds, std::chrono::seconds) */
+    bool connect(const std::string& url, bool clean_session, std::chrono::seconds timeout, std::chrono::seconds keep_alive) override;
+
+    /** @copydoc bool IMqttClient::close() */
+    bool close() override;
+
+    /** @copydoc bool IMqttClient::isConnected() const */
+    bool isConnected() const override { return (m_session != nullptr); }
+
+    /** @copydoc std::string IMqttClient::brokerUrl() const */
+    std::string brokerUrl() const override { return m_url; }
+
+    /** @copydoc bool IMqttClient::publish(const std::string&, const std::string&, QoS, bool) */
+    bool publish(const std::string& topic, const std::string& message, QoS qos, bool retained) override;
+
+    /** @copydoc size_t IMqttClient::publishBatch(const Message*, size_t, bool*) */
+    size_t publishBatch(const Message* messages, size_t count, bool* results) override;
+
+    /** @copydoc PublishStats IMqttClient::publishStats() const */
+    PublishStats publishStats() const override { return m_publish_stats.get(); }
+
+    /** @copydoc bool IMqttClient::subscribe(const std::string&, QoS) */
+    bool subscribe(const std::string& topic, QoS qos) override;
+
+    /** @copydoc bool IMqttClient::unsubscribe(const std::string&) */
+    bool unsubscribe(const std::string& topic) override;
+
+  private:
+    /** @brief Unique id */
+    std::string m_id;
+    /** @brief Broker's URL */
+    std::string m_url;
+    /** @brief Listener */
+    IListener* m_listener;
+    /** @brief Broker */
+    LoopbackBroker* m_broker;
+    /** @brief Session on the broker */
+    std::shared_ptr<LoopbackBroker::Session> m_session;
+    /** @brief Indicate if a will message has been configured */
+    bool m_has_will;
+    /** @brief Will message */
+    Message m_will;
+    /** @brief Batch publish statistics */
+    PublishStatsCounter m_publish_stats;
+};
+
+#endif // LOOPBACKMQTTCLIENT_H
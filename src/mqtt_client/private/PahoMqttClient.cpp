@@ -24,15 +24,22 @@ SOFTWARE.
 
 #include "PahoMqttClient.h"
 
-/** @brief Instanciate an MQTT client */
-IMqttClient* IMqttClient::create(const std::string& id)
-{
-    return new PahoMqttClient(id);
-}
+#include <algorithm>
+#include <vector>
 
 /** @brief Constructor */
 PahoMqttClient::PahoMqttClient(const std::string& id)
-    : m_id(id), m_url(), m_client(nullptr), m_pub_timeout(1), m_listener(nullptr), m_will(MQTTClient_willOptions_initializer)
+    : m_id(id),
+      m_url(),
+      m_client(nullptr),
+      m_pub_timeout(1),
+      m_listener(nullptr),
+      m_will(MQTTClient_willOptions_initializer),
+      m_publish_stats(),
+      m_options{false, 0u, std::chrono::seconds(0), std::chrono::seconds(0), 0u},
+      m_topic_alias_maximum(0),
+      m_aliases_mutex(),
+      m_aliases()
 {
 }
 
@@ -74,6 +81,21 @@ bool PahoMqttClient::setWill(const std::string& topic, const std::string& messag
     return ret;
 }
 
+/** @copydoc bool IMqttClient::setProtocolOptions(const ProtocolOptions&) */
+bool PahoMqttClient::setProtocolOptions(const ProtocolOptions& options)
+{
+    bool ret = false;
+
+    // Check if already connected
+    if (!m_client)
+    {
+        m_options = options;
+        ret       = true;
+    }
+
+    return ret;
+}
+
 /** @copydoc bool IMqttClient::connect(const std::string&, bool, std::chrono::seconds, std::chrono::seconds) */
 bool PahoMqttClient::connect(const std::string& url, bool clean_session, std::chrono::seconds timeout, std::chrono::seconds keep_alive)
 {
@@ -83,7 +105,13 @@ bool PahoMqttClient::connect(const std::string& url, bool clean_session, std::ch
     if (!m_client)
     {
         // Create handle
-        if (MQTTClient_create(&m_client, url.c_str(), m_id.c_str(), MQTTCLIENT_PERSISTENCE_NONE, nullptr) == MQTTCLIENT_SUCCESS)
+        MQTTClient_createOptions create_options = MQTTClient_createOptions_initializer;
+        if (m_options.mqtt5)
+        {
+            create_options.MQTTVersion = MQTTVERSION_5;
+        }
+        if (MQTTClient_createWithOptions(&m_client, url.c_str(), m_id.c_str(), MQTTCLIENT_PERSISTENCE_NONE, nullptr, &create_options) ==
+            MQTTCLIENT_SUCCESS)
         {
             // Connect to the broker
 #ifdef __clang__
@@ -94,21 +122,65 @@ bool PahoMqttClient::connect(const std::string& url, bool clean_session, std::ch
 #ifdef __clang__
 #pragma clang diagnostic pop
 #endif // __clang
-            options.cleansession      = static_cast<int>(clean_session);
             options.connectTimeout    = static_cast<int>(timeout.count());
             options.keepAliveInterval = static_cast<int>(keep_alive.count());
+            if (m_options.max_inflight != 0)
+            {
+                options.maxInflightMessages = static_cast<int>(m_options.max_inflight);
+            }
             if (m_will.topicName)
             {
                 options.will = &m_will;
             }
 
             MQTTClient_setCallbacks(m_client, this, &PahoMqttClient::onConnectionLost, &PahoMqttClient::onMessageReceived, nullptr);
-            if (MQTTClient_connect(m_client, &options) == MQTTCLIENT_SUCCESS)
+            if (m_options.mqtt5)
             {
-                m_url = url;
-                ret   = true;
+                // MQTT 5 replaces the clean session by the clean start flag
+                options.MQTTVersion  = MQTTVERSION_5;
+                options.cleansession = 0;
+                options.cleanstart   = static_cast<int>(clean_session);
+
+                // A persistent session must outlive the connection to keep the messages received while disconnected
+                MQTTProperties properties = MQTTProperties_initializer;
+                if (!clean_session && (m_options.session_expiry.count() != 0))
+                {
+                    MQTTProperty expiry;
+                    expiry.identifier     = MQTTPROPERTY_CODE_SESSION_EXPIRY_INTERVAL;
+                    expiry.value.integer4 = static_cast<unsigned int>(m_options.session_expiry.count());
+                    MQTTProperties_add(&properties, &expiry);
+                }
+
+                MQTTResponse response = MQTTClient_connect5(m_client, &options, &properties, nullptr);
+                MQTTProperties_free(&properties);
+                if (response.reasonCode == MQTTREASONCODE_SUCCESS)
+                {
+                    // The topic aliases are only valid for the current connection and are limited by the broker
+                    unsigned int broker_maximum = 0;
+                    if (response.properties && MQTTProperties_hasProperty(response.properties, MQTTPROPERTY_CODE_TOPIC_ALIAS_MAXIMUM))
+                    {
+                        broker_maximum = static_cast<unsigned int>(
+                            MQTTProperties_getNumericValue(response.properties, MQTTPROPERTY_CODE_TOPIC_ALIAS_MAXIMUM));
+                    }
+                    std::lock_guard<std::mutex> lock(m_aliases_mutex);
+                    m_topic_alias_maximum = std::min(m_options.topic_alias_maximum, broker_maximum);
+                    m_aliases.clear();
+
+                    m_url = url;
+                    ret   = true;
+                }
+                MQTTResponse_free(response);
             }
             else
+            {
+                options.cleansession = static_cast<int>(clean_session);
+                if (MQTTClient_connect(m_client, &options) == MQTTCLIENT_SUCCESS)
+                {
+                    m_url = url;
+                    ret   = true;
+                }
+            }
+            if (!ret)
             {
                 close();
             }
@@ -127,10 +199,8 @@ bool PahoMqttClient::publish(const std::string& topic, const std::string& messag
     if (m_client)
     {
         // Publish message
-        MQTTClient_deliveryToken token;
-        if (MQTTClient_publish(
-                m_client, topic.c_str(), static_cast<int>(message.size()), message.c_str(), static_cast<int>(qos), static_cast<int>(retained), &token) ==
-            MQTTCLIENT_SUCCESS)
+        MQTTClient_deliveryToken token = 0;
+        if (sendMessage(topic, message, qos, retained, token))
         {
             // Wait for completion
             if (MQTTClient_waitForCompletion(m_client, token, static_cast<unsigned int>(m_pub_timeout.count())) == MQTTCLIENT_SUCCESS)
@@ -143,6 +213,78 @@ bool PahoMqttClient::publish(const std::string& topic, const std::string& messag
     return ret;
 }
 
+/** @copydoc size_t IMqttClient::publishBatch(const Message*, size_t, bool*) */
+size_t PahoMqttClient::publishBatch(const Message* messages, size_t count, bool* results)
+{
+    size_t published = 0;
+    if (results)
+    {
+        std::fill(results, results + count, false);
+    }
+
+    // Check if connected
+    if (m_client && messages && (count != 0))
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        // Send all the messages without waiting for their completion
+        std::vector<std::pair<size_t, MQTTClient_deliveryToken>> tokens;
+        tokens.reserve(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            const Message&           message = messages[i];
+            MQTTClient_deliveryToken token   = 0;
+            if (sendMessage(message.topic, message.payload, message.qos, message.retained, token))
+            {
+                if (message.qos == QoS::QOS_0)
+                {
+                    // Already written to the network, no acknowledge to wait for
+                    published++;
+                    if (results)
+                    {
+                        results[i] = true;
+                    }
+                }
+                else
+                {
+                    tokens.emplace_back(i, token);
+                }
+            }
+        }
+
+        // Wait for the completion of the acknowledged messages
+        auto deadline = start + m_pub_timeout;
+        for (const auto& [index, token] : tokens)
+        {
+            auto          now     = std::chrono::steady_clock::now();
+            unsigned long timeout = 0;
+            if (now < deadline)
+            {
+                timeout = static_cast<unsigned long>(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count());
+            }
+            if (MQTTClient_waitForCompletion(m_client, token, timeout) == MQTTCLIENT_SUCCESS)
+            {
+                published++;
+                if (results)
+                {
+                    results[index] = true;
+                }
+            }
+        }
+
+        // Update statistics
+        m_publish_stats.update(count, published, start);
+    }
+
+    return published;
+}
+
+/** @copydoc PublishStats IMqttClient::publishStats() const */
+IMqttClient::PublishStats PahoMqttClient::publishStats() const
+{
+    return m_publish_stats.get();
+}
+
 /** @copydoc bool IMqttClient::subscribe(const std::string&, QoS) */
 bool PahoMqttClient::subscribe(const std::string& topic, QoS qos)
 {
@@ -152,7 +294,14 @@ bool PahoMqttClient::subscribe(const std::string& topic, QoS qos)
     if (m_client)
     {
         // Subscribe to topic
-        if (MQTTClient_subscribe(m_client, topic.c_str(), static_cast<int>(qos)) == MQTTCLIENT_SUCCESS)
+        if (m_options.mqtt5)
+        {
+            // The reason code is the granted QoS on success
+            MQTTResponse response = MQTTClient_subscribe5(m_client, topic.c_str(), static_cast<int>(qos), nullptr, nullptr);
+            ret = ((response.reasonCode >= MQTTREASONCODE_SUCCESS) && (response.reasonCode <= MQTTREASONCODE_GRANTED_QOS_2));
+            MQTTResponse_free(response);
+        }
+        else if (MQTTClient_subscribe(m_client, topic.c_str(), static_cast<int>(qos)) == MQTTCLIENT_SUCCESS)
         {
             ret = true;
         }
@@ -169,8 +318,14 @@ bool PahoMqttClient::unsubscribe(const std::string& topic)
     // Check if connected
     if (m_client)
     {
-        // Subscribe to topic
-        if (MQTTClient_unsubscribe(m_client, topic.c_str()) == MQTTCLIENT_SUCCESS)
+        // Unsubscribe from topic
+        if (m_options.mqtt5)
+        {
+            MQTTResponse response = MQTTClient_unsubscribe5(m_client, topic.c_str(), nullptr);
+            ret                   = (response.reasonCode == MQTTREASONCODE_SUCCESS);
+            MQTTResponse_free(response);
+        }
+        else if (MQTTClient_unsubscribe(m_client, topic.c_str()) == MQTTCLIENT_SUCCESS)
         {
             ret = true;
         }
@@ -215,6 +370,82 @@ bool PahoMqttClient::isConnected() const
     return ret;
 }
 
+/** @brief Send a message without waiting for its completion */
+bool PahoMqttClient::sendMessage(
+    const std::string& topic, const std::string& payload, QoS qos, bool retained, MQTTClient_deliveryToken& token)
+{
+    bool ret = false;
+
+    if (m_options.mqtt5)
+    {
+        MQTTProperties properties = MQTTProperties_initializer;
+
+        // Expiry of the retained messages
+        if (retained && (m_options.retained_expiry.count() != 0))
+        {
+            MQTTProperty expiry;
+            expiry.identifier     = MQTTPROPERTY_CODE_MESSAGE_EXPIRY_INTERVAL;
+            expiry.value.integer4 = static_cast<unsigned int>(m_options.retained_expiry.count());
+            MQTTProperties_add(&properties, &expiry);
+        }
+
+        // Topic alias, the topic is only sent until the broker has received it along with its alias
+        TopicAlias* alias = nullptr;
+        TopicAlias  sent_alias{0, false};
+        {
+            std::lock_guard<std::mutex> lock(m_aliases_mutex);
+            auto                        it = m_aliases.find(topic);
+            if ((it == m_aliases.end()) && (m_aliases.size() < m_topic_alias_maximum))
+            {
+                it = m_aliases.emplace(topic, TopicAlias{static_cast<int>(m_aliases.size() + 1u), false}).first;
+            }
+            if (it != m_aliases.end())
+            {
+                alias      = &it->second;
+                sent_alias = it->second;
+            }
+        }
+        if (alias)
+        {
+            MQTTProperty property;
+            property.identifier     = MQTTPROPERTY_CODE_TOPIC_ALIAS;
+            property.value.integer2 = static_cast<unsigned short>(sent_alias.value);
+            MQTTProperties_add(&properties, &property);
+        }
+
+        MQTTResponse response = MQTTClient_publish5(m_client,
+                                                    (sent_alias.established ? "" : topic.c_str()),
+                                                    static_cast<int>(payload.size()),
+                                                    payload.c_str(),
+                                                    static_cast<int>(qos),
+                                                    static_cast<int>(retained),
+                                                    &properties,
+                                                    &token);
+        ret                   = (response.reasonCode == MQTTREASONCODE_SUCCESS);
+        MQTTResponse_free(response);
+        MQTTProperties_free(&properties);
+
+        if (ret && alias && !sent_alias.established)
+        {
+            // Aliases are never removed during a connection so the pointer is still valid
+            std::lock_guard<std::mutex> lock(m_aliases_mutex);
+            alias->established = true;
+        }
+    }
+    else
+    {
+        ret = (MQTTClient_publish(m_client,
+                                  topic.c_str(),
+                                  static_cast<int>(payload.size()),
+                                  payload.c_str(),
+                                  static_cast<int>(qos),
+                                  static_cast<int>(retained),
+                                  &token) == MQTTCLIENT_SUCCESS);
+    }
+
+    return ret;
+}
+
 /** @brief Callback for connection loss with broker */
 void PahoMqttClient::onConnectionLost(void* context, char* cause) noexcept
 {
@@ -244,8 +475,8 @@ int PahoMqttClient::onMessageReceived(void* context, char* topic, int topic_len,
         PahoMqttClient* client = reinterpret_cast<PahoMqttClient*>(context);
         if (client->m_listener)
         {
-            std::string payload(reinterpret_cast<const char*>(message->payload), static_cast<size_t>(message->payloadlen));
-            client->m_listener->mqttMessageReceived(topic, payload, static_cast<QoS>(message->qos), static_cast<bool>(message->retained));
+            std::string_view payload(reinterpret_cast<const char*>(message->payload), static_cast<size_t>(message->payloadlen));
+            client->m_listener->mqttMessageViewReceived(topic, payload, static_cast<QoS>(message->qos), static_cast<bool>(message->retained));
         }
     }
 
@@ -26,8 +26,11 @@ SOFTWARE.
 #define PAHOMQTTCLIENT_H
 
 #include "IMqttClient.h"
+#include "PublishStatsCounter.h"
 
 #include <MQTTClient.h>
+#include <mutex>
+#include <unordered_map>
 
 /** @brief MQTT client implementation using Paho MQTT library */
 class PahoMqttClient : public IMqttClient
@@ -48,6 +51,9 @@ class PahoMqttClient : public IMqttClient
     /** @copydoc bool IMqttClient::setWill(const std::string&, const std::string&, QoS, bool) */
     bool setWill(const std::string& topic, const std::string& message, QoS qos, bool retained) override;
 
+    /** @copydoc bool IMqttClient::setProtocolOptions(const ProtocolOptions&) */
+    bool setProtocolOptions(const ProtocolOptions& options) override;
+
     /** @copydoc bool IMqttClient::connect(const std::string&, bool, std::chrono::seconds, std::chrono::seconds) */
     bool connect(const std::string& url, bool clean_session, std::chrono::seconds timeout, std::chrono::seconds keep_alive) override;
 
@@ -63,6 +69,12 @@ class PahoMqttClient : public IMqttClient
     /** @copydoc bool IMqttClient::publish(const std::string&, const std::string&, QoS, bool) */
     bool publish(const std::string& topic, const std::string& message, QoS qos, bool retained) override;
 
+    /** @copydoc size_t IMqttClient::publishBatch(const Message*, size_t, bool*) */
+    size_t publishBatch(const Message* messages, size_t count, bool* results) override;
+
+    /** @copydoc PublishStats IMqttClient::publishStats() const */
+    PublishStats publishStats() const override;
+
     /** @copydoc bool IMqttClient::subscribe(const std::string&, QoS) */
     bool subscribe(const std::string& topic, QoS qos) override;
 
@@ -83,6 +95,30 @@ class PahoMqttClient : public IMqttClient
     /** @brief Will message */
     MQTTClient_willOptions m_will;
 
+    /** @brief Batch publish statistics */
+    PublishStatsCounter m_publish_stats;
+
+    /** @brief Topic alias */
+    struct TopicAlias
+    {
+        /** @brief Value of the alias */
+        int value;
+        /** @brief Indicate if the alias has been sent to the broker along with its topic */
+        bool established;
+    };
+
+    /** @brief Protocol options */
+    ProtocolOptions m_options;
+    /** @brief Maximum number of topic aliases negociated with the broker */
+    unsigned int m_topic_alias_maximum;
+    /** @brief Mutex to protect the topic aliases */
+    std::mutex m_aliases_mutex;
+    /** @brief Topic aliases of the current connection */
+    std::unordered_map<std::string, TopicAlias> m_aliases;
+
+    /** @brief Send a message without waiting for its completion */
+    bool sendMessage(const std::string& topic, const std::string& payload, QoS qos, bool retained, MQTTClient_deliveryToken& token);
+
     /** @brief Callback for connection loss with broker */
     static void onConnectionLost(void* context, char* cause) noexcept;
     /** @brief Callback for message reception */
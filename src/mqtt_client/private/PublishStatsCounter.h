@@ -0,0 +1,85 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef PUBLISHSTATSCOUNTER_H
+#define PUBLISHSTATSCOUNTER_H
+
+#include "IMqttClient.h"
+
+#include <atomic>
+
+/** @brief Thread-safe counters for the batch publish statistics of the MQTT clients */
+class PublishStatsCounter
+{
+  public:
+    /** @brief Constructor */
+    PublishStatsCounter() : m_batches(0), m_messages(0), m_failures(0), m_last_latency(0), m_max_latency(0), m_total_latency(0) { }
+
+    /**
+     * @brief Account for a published batch
+     * @param count Number of messages in the batch
+     * @param published Number of messages which have been published
+     * @param start Time point of the start of the batch
+     */
+    void update(size_t count, size_t published, std::chrono::steady_clock::time_point start)
+    {
+        int64_t latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        m_batches++;
+        m_messages += count;
+        m_failures += (count - published);
+        m_last_latency = latency;
+        m_total_latency += latency;
+        int64_t max_latency = m_max_latency.load();
+        while ((latency > max_latency) && !m_max_latency.compare_exchange_weak(max_latency, latency)) { }
+    }
+
+    /** @brief Get the statistics */
+    IMqttClient::PublishStats get() const
+    {
+        IMqttClient::PublishStats stats;
+        stats.batches       = m_batches;
+        stats.messages      = m_messages;
+        stats.failures      = m_failures;
+        stats.last_latency  = std::chrono::microseconds(m_last_latency.load());
+        stats.max_latency   = std::chrono::microseconds(m_max_latency.load());
+        stats.total_latency = std::chrono::microseconds(m_total_latency.load());
+        return stats;
+    }
+
+  private:
+    /** @brief Number of published batches */
+    std::atomic<uint64_t> m_batches;
+    /** @brief Number of messages published in batches */
+    std::atomic<uint64_t> m_messages;
+    /** @brief Number of messages of the batches which could not be published */
+    std::atomic<uint64_t> m_failures;
+    /** @brief Latency of the last batch in us */
+    std::atomic<int64_t> m_last_latency;
+    /** @brief Longest batch latency in us */
+    std::atomic<int64_t> m_max_latency;
+    /** @brief Cumulated batch latency in us */
+    std::atomic<int64_t> m_total_latency;
+};
+
+#endif // PUBLISHSTATSCOUNTER_H
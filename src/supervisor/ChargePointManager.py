@@ -440,37 +440,29 @@ class ChargePointManager(object):
         return ret
 
     def __remove_charge_points(self, charge_points: list) -> bool:
-        """ Send the command to remove simulated charge points """
+        """ Send the command to remove simulated charge points, the launcher
+            kills them and cleans their state in the broker """
 
         ret = False
 
         if self.__client.is_connected():
 
-            # Kill charge points
-            self.__kill_charge_points(charge_points)
+            # Build topic name
+            topic_name = "cp_simu/launcher/cmd"
 
-            # List of charge points to remove
-            cps_to_remove = []
-            for cp_id in charge_points:
-                cp = self.__cps.get(cp_id["id"])
-                if not cp is None:
-                    cps_to_remove.append(cp)
+            # Build message
+            payload = {
+                "type": "remove",
+                "charge_points": charge_points}
 
-            # Wait for the charge points to be dead
-            total_dead = 0
-            retries = 0
-            while (retries < 4) and (not (total_dead == len(cps_to_remove))):
-                total_dead = 0
-                for cp in cps_to_remove:
-                    if cp.status == "Dead":
-                        self.__cps.pop(cp.id)
-                        total_dead += 1
-                time.sleep(0.500)
-                retries += 1
-
-            if retries < 4:
-                # Remove charge points
-                ret = self.__clean_state(cps_to_remove)
+            # Publish message, the wrapper checks the publication result
+            # code (rc == MQTT_ERR_SUCCESS) of the Paho message info
+            ret = self.__client.publish(topic_name, json.dumps(payload))
+
+            # Forget charge points only if the command has been sent
+            if ret:
+                for cp_id in charge_points:
+                    self.__cps.pop(cp_id["id"], None)
 
         return ret
 
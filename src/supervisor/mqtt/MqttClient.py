@@ -118,7 +118,7 @@ class MqttClient(object):
 
             # Publish message
             info = self.__client.publish(topic, message, qos, retain)
-            if info.rc == 0:
+            if info.rc == mqtt.MQTT_ERR_SUCCESS:
                 ret = True
 
         return ret
@@ -0,0 +1,103 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "MeterEngine.h"
+
+#include <openocpp/TimerPool.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+/** @brief Power of the simulated DC load in W : 1 Wh per ms so that the whole Wh register has a fine resolution */
+static constexpr float LOAD_POWER = 3600000.f;
+/** @brief Simulated duration of each check */
+static constexpr std::chrono::seconds DURATION = std::chrono::seconds(600);
+/** @brief Maximum relative error between the integrated energy and the power integrated over the simulated time */
+static constexpr double MAX_RELATIVE_ERROR = 1e-4;
+
+/** @brief Integrate the load over DURATION with updates separated by the given periods, returns the energy of the meter in Wh */
+static int64_t integrate(ocpp::helpers::ITimerPool& timer_pool, const std::vector<std::chrono::microseconds>& periods)
+{
+    // Single DC meter, not affected by the grid disturbances, the engine is not started so that the updates are only the controlled ones
+    MeterEngine engine(timer_pool, MeterEngine::MIN_UPDATE_PERIOD);
+    size_t      meter = engine.addMeter(1u, ConnectorData::ConnectorType::DC);
+    engine.setConsumptions(meter, {LOAD_POWER});
+
+    auto now = std::chrono::steady_clock::now();
+    engine.update(now);
+    engine.setActive(meter, true);
+    for (const auto& period : periods)
+    {
+        now += period;
+        engine.update(now);
+    }
+
+    return engine.getSnapshot(meter).load().energy;
+}
+
+/** @brief Check the integrated energy against the expected one */
+static bool check(const char* name, int64_t energy)
+{
+    double expected = static_cast<double>(LOAD_POWER) * std::chrono::duration<double, std::ratio<3600>>(DURATION).count();
+    double error    = std::fabs(static_cast<double>(energy) - expected) / expected;
+    bool   ret      = (error <= MAX_RELATIVE_ERROR);
+    std::cout << name << " : " << energy << " Wh, expected : " << expected << " Wh, relative error : " << error << " => "
+              << (ret ? "OK" : "FAILED") << std::endl;
+    return ret;
+}
+
+/** @brief Entry point */
+int main()
+{
+    ocpp::helpers::TimerPool timer_pool;
+    bool                     ret = true;
+
+    // Single update over the whole duration
+    ret = check("Single update", integrate(timer_pool, {DURATION})) && ret;
+
+    // Regular updates at the minimum update period
+    std::vector<std::chrono::microseconds> periods(static_cast<size_t>(DURATION / MeterEngine::MIN_UPDATE_PERIOD),
+                                                   MeterEngine::MIN_UPDATE_PERIOD);
+    ret = check("Regular updates", integrate(timer_pool, periods)) && ret;
+
+    // Irregular updates from 1 us to 50 ms as a drifting timer under load, the last one completes the duration
+    std::mt19937              random(12345u);
+    std::chrono::microseconds total(0);
+    periods.clear();
+    while (total < DURATION)
+    {
+        std::chrono::microseconds period(1u + random() % 50000u);
+        period = std::min(period, std::chrono::duration_cast<std::chrono::microseconds>(DURATION) - total);
+        periods.push_back(period);
+        total += period;
+    }
+    ret = check("Irregular updates", integrate(timer_pool, periods)) && ret;
+
+    return (ret ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,271 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "IMqttClient.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/** @brief URL of the loopback broker used by the tests */
+static const std::string BROKER_URL = "loop://t";
+/** @brief Prefix of the topics used to wait for the end of the pending deliveries to a client */
+static const std::string SYNC_TOPIC_PREFIX = "test/sync/";
+/** @brief Maximum time to wait for a delivery */
+static constexpr std::chrono::seconds DELIVERY_TIMEOUT = std::chrono::seconds(2);
+
+/** @brief Loopback client recording the messages it receives */
+class TestClient : public IMqttClient::IListener
+{
+  public:
+    /** @brief Received message */
+    struct Message
+    {
+        /** @brief Topic */
+        std::string topic;
+        /** @brief Payload */
+        std::string payload;
+        /** @brief Retained flag */
+        bool retained;
+    };
+
+    /**
+     * @brief Constructor
+     * @param id Client id
+     * @param will_topic Topic of the will message (no will message if empty)
+     */
+    TestClient(const std::string& id, const std::string& will_topic = "")
+        : m_mqtt(IMqttClient::create(id, BROKER_URL)),
+          m_sync_topic(SYNC_TOPIC_PREFIX + id),
+          m_mutex(),
+          m_cond_var(),
+          m_messages(),
+          m_synced(false)
+    {
+        m_mqtt->registerListener(*this);
+        if (!will_topic.empty())
+        {
+            m_mqtt->setWill(will_topic, id + " is dead");
+        }
+        m_mqtt->connect(BROKER_URL);
+        m_mqtt->subscribe(m_sync_topic);
+    }
+
+    /** @brief MQTT client */
+    IMqttClient& mqtt() { return *m_mqtt; }
+
+    /** @brief Release the client without closing it so that its will message is published */
+    void destroy() { m_mqtt.reset(); }
+
+    /** @brief Wait until all the messages published before the call have been delivered, returns the received messages */
+    std::vector<Message> sync(IMqttClient& publisher)
+    {
+        std::vector<Message> messages;
+
+        // The loopback broker delivers the messages in order, so the sync message is received after the pending ones
+        publisher.publish(m_sync_topic, "sync");
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_cond_var.wait_for(lock, DELIVERY_TIMEOUT, [this] { return m_synced; }))
+        {
+            messages.swap(m_messages);
+        }
+        else
+        {
+            std::cout << "Timeout while waiting for the deliveries" << std::endl;
+        }
+        m_synced = false;
+
+        return messages;
+    }
+
+    /** @copydoc void IMqttClient::IListener::mqttConnectionLost() */
+    void mqttConnectionLost() override { }
+
+    /** @copydoc void IMqttClient::IListener::mqttMessageReceived(const char*, const std::string&, IMqttClient::QoS, bool) */
+    void mqttMessageReceived(const char* topic, const std::string& message, IMqttClient::QoS qos, bool retained) override
+    {
+        (void)qos;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (topic == m_sync_topic)
+        {
+            m_synced = true;
+            m_cond_var.notify_all();
+        }
+        else
+        {
+            m_messages.push_back({topic, message, retained});
+        }
+    }
+
+  private:
+    /** @brief MQTT client */
+    std::unique_ptr<IMqttClient> m_mqtt;
+    /** @brief Topic of the sync messages of the client */
+    std::string m_sync_topic;
+    /** @brief Mutex to protect the received messages */
+    std::mutex m_mutex;
+    /** @brief Condition variable to wait for the sync message */
+    std::condition_variable m_cond_var;
+    /** @brief Messages received since the last sync */
+    std::vector<Message> m_messages;
+    /** @brief Indicate that the sync message has been received */
+    bool m_synced;
+};
+
+/** @brief Display the result of a check */
+static bool check(const char* name, bool result)
+{
+    std::cout << name << " => " << (result ? "OK" : "FAILED") << std::endl;
+    return result;
+}
+
+/** @brief Check the received topics */
+static bool received(const std::vector<TestClient::Message>& messages, const std::vector<std::string>& topics)
+{
+    bool ret = (messages.size() == topics.size());
+    for (size_t i = 0; ret && (i < topics.size()); i++)
+    {
+        ret = (messages[i].topic == topics[i]);
+    }
+    return ret;
+}
+
+/** @brief Single and multi level wildcards */
+static bool testWildcards(TestClient& publisher)
+{
+    TestClient subscriber("wildcards");
+    subscriber.mqtt().subscribe("cp_simu/cps/+/status");
+    subscriber.mqtt().subscribe("cp_simu/launcher/#");
+    subscriber.sync(publisher.mqtt());
+
+    publisher.mqtt().publish("cp_simu/cps/cp1/status", "Alive");
+    publisher.mqtt().publish("cp_simu/cps/cp1/connectors/1/status", "Available");
+    publisher.mqtt().publish("cp_simu/launcher", "parent level");
+    publisher.mqtt().publish("cp_simu/launcher/cmd", "{}");
+    publisher.mqtt().publish("cp_simu/supervisor/cmd", "{}");
+    auto messages = subscriber.sync(publisher.mqtt());
+
+    return check("Wildcards", received(messages, {"cp_simu/cps/cp1/status", "cp_simu/launcher", "cp_simu/launcher/cmd"}));
+}
+
+/** @brief Replay of the retained messages to the new subscribers and clearing of a retained message */
+static bool testRetained(TestClient& publisher)
+{
+    bool ret = true;
+
+    publisher.mqtt().publish("retained/a", "1", IMqttClient::QoS::QOS_0, true);
+    publisher.mqtt().publish("retained/b", "2", IMqttClient::QoS::QOS_0, false);
+
+    TestClient first("retained_1");
+    first.mqtt().subscribe("retained/#");
+    auto messages = first.sync(publisher.mqtt());
+    bool replayed = (received(messages, {"retained/a"}) && messages[0].retained && (messages[0].payload == "1"));
+    ret           = check("Retained replay", replayed) && ret;
+
+    publisher.mqtt().publish("retained/a", "", IMqttClient::QoS::QOS_0, true);
+    first.sync(publisher.mqtt());
+    TestClient second("retained_2");
+    second.mqtt().subscribe("retained/#");
+    messages = second.sync(publisher.mqtt());
+    ret      = check("Retained clear", messages.empty()) && ret;
+
+    return ret;
+}
+
+/** @brief Will message published when a client is destroyed without being closed */
+static bool testWill(TestClient& publisher)
+{
+    bool ret = true;
+
+    TestClient subscriber("will");
+    subscriber.mqtt().subscribe("will/#");
+    subscriber.sync(publisher.mqtt());
+
+    TestClient lost("will_lost", "will/lost");
+    lost.destroy();
+    auto messages = subscriber.sync(publisher.mqtt());
+    ret           = check("Will on destroy", received(messages, {"will/lost"}) && (messages[0].payload == "will_lost is dead")) && ret;
+
+    TestClient closed("will_closed", "will/closed");
+    closed.mqtt().close();
+    closed.destroy();
+    messages = subscriber.sync(publisher.mqtt());
+    ret      = check("No will on close", messages.empty()) && ret;
+
+    return ret;
+}
+
+/** @brief Shared subscriptions : a single member of the group receives each message, no retained replay */
+static bool testSharedSubscriptions(TestClient& publisher)
+{
+    bool ret = true;
+
+    publisher.mqtt().publish("shared/state", "retained", IMqttClient::QoS::QOS_0, true);
+
+    TestClient member1("shared_1");
+    TestClient member2("shared_2");
+    TestClient other("shared_3");
+    member1.mqtt().subscribe(IMqttClient::sharedFilter("group", "shared/#"));
+    member2.mqtt().subscribe(IMqttClient::sharedFilter("group", "shared/#"));
+    other.mqtt().subscribe("shared/#");
+    auto messages1 = member1.sync(publisher.mqtt());
+    auto messages2 = member2.sync(publisher.mqtt());
+    auto messages3 = other.sync(publisher.mqtt());
+    bool no_replay = (messages1.empty() && messages2.empty() && received(messages3, {"shared/state"}));
+    ret            = check("Shared subscription without retained replay", no_replay) && ret;
+
+    const size_t count = 10u;
+    for (size_t i = 0; i < count; i++)
+    {
+        publisher.mqtt().publish("shared/cmd", std::to_string(i));
+    }
+    messages1 = member1.sync(publisher.mqtt());
+    messages2 = member2.sync(publisher.mqtt());
+    messages3 = other.sync(publisher.mqtt());
+
+    bool balanced = ((messages1.size() == (count / 2u)) && (messages2.size() == (count / 2u)) && (messages3.size() == count));
+    ret           = check("Shared subscription load balancing", balanced) && ret;
+
+    return ret;
+}
+
+/** @brief Entry point */
+int main()
+{
+    TestClient publisher("publisher");
+    bool       ret = true;
+
+    ret = testWildcards(publisher) && ret;
+    ret = testRetained(publisher) && ret;
+    ret = testWill(publisher) && ret;
+    ret = testSharedSubscriptions(publisher) && ret;
+
+    return (ret ? EXIT_SUCCESS : EXIT_FAILURE);
+}
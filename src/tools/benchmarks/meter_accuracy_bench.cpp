@@ -0,0 +1,122 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "MeterEngine.h"
+
+#include <openocpp/TimerPool.h>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+/** @brief Update period of the meter engine during the benchmark */
+static constexpr std::chrono::milliseconds UPDATE_PERIOD = std::chrono::milliseconds(10);
+/** @brief Power of the simulated DC load in W : 100 Wh per ms so that the whole Wh register has a fine resolution */
+static constexpr float LOAD_POWER = 360000000.f;
+/** @brief Maximum relative error between the integrated energy and the power integrated over the measured time */
+static constexpr double MAX_RELATIVE_ERROR = 1e-4;
+
+/** @brief Wait for the next tick of the engine, returns the energy of the meter and the time just after the tick */
+static int64_t waitTick(const MeterEngine& engine, std::chrono::steady_clock::time_point& tick_time)
+{
+    uint64_t ticks = engine.stats().ticks;
+    while (engine.stats().ticks == ticks)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(20));
+    }
+    tick_time = std::chrono::steady_clock::now();
+    return engine.getSnapshot(0).load().energy;
+}
+
+/** @brief Entry point */
+int main(int argc, char* argv[])
+{
+    // Duration of the measure and number of threads loading the CPU to make the ticks irregular
+    std::chrono::seconds duration(5);
+    unsigned int         load_threads = std::thread::hardware_concurrency();
+    if (argc > 1)
+    {
+        duration = std::chrono::seconds(std::atoi(argv[1]));
+    }
+    if (argc > 2)
+    {
+        load_threads = static_cast<unsigned int>(std::atoi(argv[2]));
+    }
+    std::cout << "Meter energy integration (update period : " << UPDATE_PERIOD.count() << " ms, duration : " << duration.count()
+              << " s, load threads : " << load_threads << ")" << std::endl;
+
+    // Single DC meter, not affected by the grid disturbances
+    ocpp::helpers::TimerPool timer_pool;
+    MeterEngine              engine(timer_pool, UPDATE_PERIOD);
+    size_t                   meter = engine.addMeter(1u, ConnectorData::ConnectorType::DC);
+    engine.setConsumptions(meter, {LOAD_POWER});
+    engine.setActive(meter, true);
+
+    // CPU load
+    std::atomic<bool>        stop(false);
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < load_threads; i++)
+    {
+        threads.emplace_back(
+            [&stop]
+            {
+                volatile uint64_t counter = 0;
+                while (!stop)
+                {
+                    counter = counter + 1u;
+                }
+            });
+    }
+
+    // Energy integrated between 2 ticks compared to the power integrated over the measured time
+    engine.start();
+    std::chrono::steady_clock::time_point start_time;
+    std::chrono::steady_clock::time_point end_time;
+    int64_t                               start_energy = waitTick(engine, start_time);
+    uint64_t                              start_ticks  = engine.stats().ticks;
+    std::this_thread::sleep_for(duration);
+    int64_t  end_energy = waitTick(engine, end_time);
+    uint64_t ticks      = engine.stats().ticks - start_ticks;
+    engine.stop();
+
+    stop = true;
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    double elapsed_ms = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+    double expected   = static_cast<double>(LOAD_POWER) * elapsed_ms / 3600000.;
+    double measured   = static_cast<double>(end_energy - start_energy);
+    double error      = std::fabs(measured - expected) / expected;
+    std::cout << ticks << " ticks, average period " << (elapsed_ms / static_cast<double>(ticks)) << " ms" << std::endl;
+    std::cout << "Energy : " << measured << " Wh, expected : " << expected << " Wh, relative error : " << error
+              << " (max : " << MAX_RELATIVE_ERROR << ")" << std::endl;
+
+    return ((error <= MAX_RELATIVE_ERROR) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
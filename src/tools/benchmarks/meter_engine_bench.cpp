@@ -0,0 +1,80 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "MeterEngine.h"
+
+#include <openocpp/TimerPool.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+/** @brief Update period of the meter engine during the benchmark */
+static constexpr std::chrono::milliseconds UPDATE_PERIOD = std::chrono::milliseconds(10);
+
+/** @brief Measure the duration of the ticks of the meter engine integrating a given number of 3 phases AC meters */
+static void benchTicks(ocpp::helpers::ITimerPool& timer_pool, size_t meters_count, std::chrono::seconds duration)
+{
+    MeterEngine engine(timer_pool, UPDATE_PERIOD);
+    for (size_t i = 0; i < meters_count; i++)
+    {
+        size_t meter = engine.addMeter(3u, ConnectorData::ConnectorType::AC);
+        engine.setVoltages(meter, {230.f, 230.f, 230.f});
+        engine.setConsumptions(meter, {16.f, 16.f, 16.f});
+        engine.setActive(meter, true);
+    }
+
+    engine.start();
+    std::this_thread::sleep_for(duration);
+    engine.stop();
+
+    MeterEngine::Stats stats = engine.stats();
+    double             avg_us =
+        (stats.ticks != 0) ? (std::chrono::duration<double, std::micro>(stats.total_tick_duration).count() / static_cast<double>(stats.ticks))
+                           : 0.;
+    std::cout << meters_count << " meters : " << stats.ticks << " ticks, average " << avg_us << " us, max "
+              << std::chrono::duration<double, std::micro>(stats.max_tick_duration).count() << " us" << std::endl;
+}
+
+/** @brief Entry point */
+int main(int argc, char* argv[])
+{
+    // Duration of each measure
+    std::chrono::seconds duration(2);
+    if (argc > 1)
+    {
+        duration = std::chrono::seconds(std::atoi(argv[1]));
+    }
+    std::cout << "Meter engine ticks (update period : " << UPDATE_PERIOD.count() << " ms, duration : " << duration.count() << " s)"
+              << std::endl;
+
+    ocpp::helpers::TimerPool timer_pool;
+    for (size_t meters_count : {1000u, 100000u})
+    {
+        benchTicks(timer_pool, meters_count, duration);
+    }
+
+    return 0;
+}
@@ -0,0 +1,158 @@
+/*
+MIT License
+
+Copyright (c) 2022 Cedric Jimenez
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "MeterEngine.h"
+#include "MeterSimulator.h"
+#include "MeterValuesBuilder.h"
+
+#include <openocpp/TimerPool.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace ocpp::types;
+
+/** @brief Measurands of the benchmark : energy and current, power and voltage of each phase */
+static const std::vector<MeterValuesBuilder::MeasurandPhase> MEASURANDS = {{Measurand::EnergyActiveImportRegister, {}},
+                                                                            {Measurand::CurrentImport, {}},
+                                                                            {Measurand::PowerActiveImport, {}},
+                                                                            {Measurand::Voltage, {}}};
+
+/** @brief Reference implementation building the sampled values from scratch with std::to_string (previous implementation) */
+static void buildReference(const ConnectorData& connector, const MeterValuesBuilder::MeasurandPhase& measurand, MeterValue& meter_value)
+{
+    SampledValue  value;
+    MeterSnapshot meter = connector.meter->getSnapshot();
+    switch (measurand.first)
+    {
+        case Measurand::EnergyActiveImportRegister:
+        {
+            value.value = std::to_string(meter.energy);
+            meter_value.sampledValue.push_back(value);
+            break;
+        }
+        case Measurand::CurrentImport:
+        case Measurand::PowerActiveImport:
+        case Measurand::Voltage:
+        {
+            for (unsigned int i = 0; i < meter.phases; i++)
+            {
+                if (measurand.first == Measurand::CurrentImport)
+                {
+                    value.value = std::to_string(meter.consumptions[i]);
+                    value.unit  = UnitOfMeasure::A;
+                }
+                else if (measurand.first == Measurand::PowerActiveImport)
+                {
+                    value.value = std::to_string(meter.powers[i]);
+                    value.unit  = UnitOfMeasure::W;
+                }
+                else
+                {
+                    value.value = std::to_string(meter.voltages[i]);
+                    value.unit  = UnitOfMeasure::V;
+                }
+                value.phase = static_cast<Phase>(i);
+                meter_value.sampledValue.push_back(value);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+/** @brief Number of meter values built per second */
+template <typename BuildFunction>
+static double benchBuild(unsigned int count, BuildFunction build)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < count; i++)
+    {
+        MeterValue meter_value;
+        build(meter_value);
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(count) / elapsed;
+}
+
+/** @brief Entry point */
+int main(int argc, char* argv[])
+{
+    // Number of meter values built by each measure
+    unsigned int count = 200000u;
+    if (argc > 1)
+    {
+        count = static_cast<unsigned int>(std::atoi(argv[1]));
+    }
+
+    // 3 phases AC connector
+    ocpp::helpers::TimerPool timer_pool;
+    MeterEngine              engine(timer_pool, std::chrono::milliseconds(500));
+    MeterSimulator           meter(engine, 3u, ConnectorData::ConnectorType::AC);
+    ConnectorData            connector;
+    connector.id       = 1u;
+    connector.meter    = &meter;
+    connector.setpoint = 32.f;
+    connector.ev_soc   = 0.42f;
+    meter.setVoltages({230.1f, 229.7f, 231.2f});
+    meter.setPowerFactor(0.9f);
+    meter.setConsumptions({16.2f, 15.9f, 16.1f});
+
+    // Energy + 3 x Current + 3 x Power + 3 x Voltage
+    MeterValuesBuilder builder(1u, 3u);
+    auto               build_reference = [&](MeterValue& meter_value)
+    {
+        for (const auto& measurand : MEASURANDS)
+        {
+            buildReference(connector, measurand, meter_value);
+        }
+    };
+    auto build_cached = [&](MeterValue& meter_value)
+    {
+        for (const auto& measurand : MEASURANDS)
+        {
+            builder.build(connector.id, connector, measurand, meter_value);
+        }
+    };
+    double reference = benchBuild(count, build_reference);
+    double cached    = benchBuild(count, build_cached);
+    std::cout << "Energy + 3 x Current + 3 x Power + 3 x Voltage :" << std::endl;
+    std::cout << "    std::to_string : " << reference << " MeterValues/s" << std::endl;
+    std::cout << "    cached templates + std::to_chars : " << cached << " MeterValues/s" << std::endl;
+
+    // All the supported measurands from a single snapshot, as sent by the MeterValues stress mode
+    std::vector<MeterValuesBuilder::MeasurandPhase> all_measurands = MeterValuesBuilder::supportedMeasurands();
+    MeterValue                                      full_meter_value;
+    builder.build(connector.id, connector, all_measurands, full_meter_value);
+    auto   build_full = [&](MeterValue& meter_value) { builder.build(connector.id, connector, all_measurands, meter_value); };
+    double full       = benchBuild(count, build_full);
+    std::cout << "All the supported measurands (" << full_meter_value.sampledValue.size() << " sampled values) :" << std::endl;
+    std::cout << "    batch build : " << full << " MeterValues/s, "
+              << full * static_cast<double>(full_meter_value.sampledValue.size()) << " sampled values/s" << std::endl;
+
+    return 0;
+}
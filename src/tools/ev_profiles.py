@@ -0,0 +1,75 @@
+import argparse
+import csv
+import os
+import struct
+import tempfile
+
+# Profile library format (little endian) : header then one record per profile, the id of a profile is its index + 1
+LIBRARY_MAGIC = b"EVPL"
+LIBRARY_VERSION = 1
+HEADER_FORMAT = "<4sIII"
+RECORD_FORMAT = "<7fII"
+
+# CSV columns : name => conversion to the record unit
+COLUMNS = {
+    "capacity_kwh": lambda value: float(value) * 1000.0,
+    "initial_soc": float,
+    "target_soc": float,
+    "cv_soc": float,
+    "min_power_ratio": float,
+    "max_ac_kw": lambda value: float(value) * 1000.0,
+    "max_dc_kw": lambda value: float(value) * 1000.0,
+    "departure_min": lambda value: int(float(value) * 60.0),
+    "phases": int,
+}
+
+def read_profiles(path: str):
+    profiles = []
+    with open(path, newline="") as csv_file:
+        reader = csv.DictReader(csv_file)
+        missing = [column for column in COLUMNS if column not in (reader.fieldnames or [])]
+        if missing:
+            raise ValueError(f"missing columns : {', '.join(missing)}")
+        for line, row in enumerate(reader, start=2):
+            record = {column: convert(row[column]) for column, convert in COLUMNS.items()}
+            if record["capacity_kwh"] <= 0.0:
+                raise ValueError(f"line {line} : capacity must be positive")
+            if not 1 <= record["phases"] <= 3:
+                raise ValueError(f"line {line} : phases must be between 1 and 3")
+            for column in ("initial_soc", "target_soc", "cv_soc", "min_power_ratio"):
+                if not 0.0 <= record[column] <= 1.0:
+                    raise ValueError(f"line {line} : {column} must be between 0 and 1")
+            profiles.append(record)
+    return profiles
+
+def write_library(path: str, profiles: list):
+    # The charge points map the library, it is never modified in place : the new library is written
+    # to a temporary file of the same directory which then atomically replaces the previous one
+    record_size = struct.calcsize(RECORD_FORMAT)
+    fd, temp_path = tempfile.mkstemp(prefix=".ev_profiles_", dir=os.path.dirname(os.path.abspath(path)))
+    try:
+        with os.fdopen(fd, "wb") as library_file:
+            library_file.write(struct.pack(HEADER_FORMAT, LIBRARY_MAGIC, LIBRARY_VERSION, record_size, len(profiles)))
+            for profile in profiles:
+                library_file.write(struct.pack(RECORD_FORMAT, *profile.values()))
+            library_file.flush()
+            os.fsync(library_file.fileno())
+        os.chmod(temp_path, 0o644)
+        os.replace(temp_path, path)
+    except BaseException:
+        os.unlink(temp_path)
+        raise
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Convert a CSV file of EV profiles into a profile library for the simulated charge points")
+    parser.add_argument("csv", help=f"CSV file with the columns : {', '.join(COLUMNS)}")
+    parser.add_argument("library", help="Profile library file to generate")
+    args = parser.parse_args()
+
+    profiles = read_profiles(args.csv)
+    if not profiles:
+        raise SystemExit("no profile found")
+    write_library(args.library, profiles)
+    print(f"{len(profiles)} profiles written to {args.library}")
+    for index, profile in enumerate(profiles, start=1):
+        print(f"  {index} : {profile['capacity_kwh'] / 1000.0:g}kWh, AC {profile['max_ac_kw'] / 1000.0:g}kW ({profile['phases']} phases), DC {profile['max_dc_kw'] / 1000.0:g}kW")
@@ -1,27 +1,62 @@
 import argparse
 import paho.mqtt.client as mqtt
 import json
+import threading
 import time
+import uuid
+
+# Commands waiting for their reply : cmd_id => [event, send time, reply]
+pending_commands = {}
+pending_lock = threading.Lock()
+
+def on_reply(client, userdata, message):
+    try:
+        reply = json.loads(message.payload)
+    except ValueError:
+        return
+    with pending_lock:
+        pending = pending_commands.get(reply.get("cmd_id"))
+    if pending:
+        pending[2] = reply
+        pending[0].set()
+
+def send_command(client: mqtt.Client, topic: str, msg: dict):
+    cmd_id = str(uuid.uuid4())
+    msg["cmd_id"] = cmd_id
+    with pending_lock:
+        pending_commands[cmd_id] = [threading.Event(), time.monotonic(), None]
+    client.publish(topic, json.dumps(msg), qos=1)
+    return cmd_id
+
+def wait_replies(cmd_ids: list, timeout: float):
+    deadline = time.monotonic() + timeout
+    for cmd_id in cmd_ids:
+        with pending_lock:
+            pending = pending_commands.pop(cmd_id)
+        if pending[0].wait(max(0.0, deadline - time.monotonic())):
+            reply = pending[2]
+            latency = (time.monotonic() - pending[1]) * 1000.0
+            print(f"{reply['type']} {cmd_id} : {reply['result']} in {latency:.1f}ms (charge point : {reply['latency_us']}us)")
+        else:
+            print(f"{cmd_id} : no reply")
 
 def pass_badge(client: mqtt.Client, simu_name: str, badge: str):
     badge_msg = {"id": badge}
-    client.publish(f"cp_simu/cps/{simu_name}/connectors/1/id_tag", json.dumps(badge_msg))
+    return send_command(client, f"cp_simu/cps/{simu_name}/connectors/1/id_tag", badge_msg)
 
 def set_cable(client: mqtt.Client, simu_name: str, cable: float, l1: float, l2: float, l3: float):
     cable_msg = {"cable": cable, "ready": True, "consumption_l1": l1, "consumption_l2": l2, "consumption_l3": l3}
-    client.publish(f"cp_simu/cps/{simu_name}/connectors/1/car", json.dumps(cable_msg))
+    return send_command(client, f"cp_simu/cps/{simu_name}/connectors/1/car", cable_msg)
 
-def start_charge(args, simu_name):
-    print(f"starting charge on simu {simu_name}")
-    pass_badge(client, simu_name, args.badge)
-    time.sleep(0.3)
-    set_cable(client, simu_name, args.cable, args.l1, args.l2, args.l3)
+def start_charge(args, simu_names):
+    print(f"starting charge on simus {simu_names[0]} to {simu_names[-1]}")
+    wait_replies([pass_badge(client, simu_name, args.badge) for simu_name in simu_names], args.timeout)
+    wait_replies([set_cable(client, simu_name, args.cable, args.l1, args.l2, args.l3) for simu_name in simu_names], args.timeout)
 
-def stop_charge(args, simu_name):
-    print(f"stop charge on simu {args.prefix}{index}")
-    pass_badge(client, simu_name, args.badge)
-    time.sleep(0.3)
-    set_cable(client, simu_name, 0.0, 0.0, 0.0, 0.0)
+def stop_charge(args, simu_names):
+    print(f"stop charge on simus {simu_names[0]} to {simu_names[-1]}")
+    wait_replies([pass_badge(client, simu_name, args.badge) for simu_name in simu_names], args.timeout)
+    wait_replies([set_cable(client, simu_name, 0.0, 0.0, 0.0, 0.0) for simu_name in simu_names], args.timeout)
 
 def generate(args):
     print(f"generate station setup {args.file}")
@@ -53,6 +88,7 @@ parser.add_argument('--broker_port', type=int, help="port of the mqtt broker", d
 parser.add_argument('-p', '--prefix', required=True, type=str, help="prefix of simulator name")
 parser.add_argument('-s', '--sequence', required=True, nargs=2, type=int,
                     help='minimal and maximum simulator name index')
+parser.add_argument('-t', '--timeout', type=float, help="timeout in seconds for the replies of the simulators", default=10.0)
 command_parser = parser.add_subparsers(help='sub-parser for command to run')
 
 parser_generate = command_parser.add_parser('generate', help="Generate json file for simulator creations")
@@ -90,10 +126,13 @@ else:
     evce_broker = args.broker
     evce_broker_port = args.broker_port
     client = mqtt.Client("evce")
+    client.on_message = on_reply
     print(f"Connect to mqtt {evce_broker} {evce_broker_port}")
     client.connect(evce_broker, evce_broker_port)
+    client.subscribe("cp_simu/cps/+/reply", qos=1)
+    client.loop_start()
 
-    # Run command
-    for index in range(args.sequence[0], args.sequence[1]+1):
-        simu_name = f"{args.prefix}{index}"
-        args.func(args, simu_name)
+    # Run command on all the simulators, the commands are pipelined and their replies awaited
+    simu_names = [f"{args.prefix}{index}" for index in range(args.sequence[0], args.sequence[1]+1)]
+    args.func(args, simu_names)
+    client.loop_stop()